@@ -2,14 +2,15 @@
 
 #include "Simulation.h"
 #include "ExchangeAgentMessagePayloads.h"
+#include "Snapshot.h"
 
 #include <fstream>
 
 AdaptiveOfferingAgent::AdaptiveOfferingAgent(const Simulation* simulation)
-	: Agent(simulation), m_exchange(""), m_volumeUnit(1), m_orderMeanLifeTime(1000), m_marketOrderFraction(0.0), m_priceScale(1.0), m_memorySize(5) { }
+	: Agent(simulation), m_exchange(""), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_volumeUnit(1), m_orderMeanLifeTime(1000), m_marketOrderFraction(0.0), m_priceScale(1.0), m_memorySize(5) { }
 
 AdaptiveOfferingAgent::AdaptiveOfferingAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name), m_exchange(""), m_volumeUnit(1), m_orderMeanLifeTime(1000), m_marketOrderFraction(0.0), m_priceScale(1.0), m_memorySize(5) { }
+	: Agent(simulation, name), m_exchange(""), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_volumeUnit(1), m_orderMeanLifeTime(1000), m_marketOrderFraction(0.0), m_priceScale(1.0), m_memorySize(5) { }
 
 void AdaptiveOfferingAgent::configure(const pugi::xml_node& node, const std::string& configurationPath) {
 	Agent::configure(node, configurationPath);
@@ -19,6 +20,10 @@ void AdaptiveOfferingAgent::configure(const pugi::xml_node& node, const std::str
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
 
+	if (!(att = node.attribute("symbol")).empty()) {
+		m_symbol = (SymbolId)std::stoul(simulation()->parameters().processString(att.as_string()));
+	}
+
 	if (!(att = node.attribute("volumeUnit")).empty()) {
 		m_volumeUnit = std::stoull(simulation()->parameters().processString(att.as_string()));
 	}
@@ -40,95 +45,133 @@ void AdaptiveOfferingAgent::configure(const pugi::xml_node& node, const std::str
 	}
 }
 
+void AdaptiveOfferingAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
+}
+
+const MessageDispatchTable<AdaptiveOfferingAgent> AdaptiveOfferingAgent::s_dispatchTable = MessageDispatchTable<AdaptiveOfferingAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &AdaptiveOfferingAgent::handleSimulationStart)
+	.on(MESSAGETYPE_WAKEUP_FOR_CANCELLATION, &AdaptiveOfferingAgent::handleWakeupForCancellation)
+	.on(MESSAGETYPE_RESPONSE_CANCEL_ORDERS, &AdaptiveOfferingAgent::handleCancelOrdersResponse)
+	.on(MESSAGETYPE_RESPONSE_RETRIEVE_L1, &AdaptiveOfferingAgent::handleRetrieveL1Response)
+	.on(MESSAGETYPE_RESPONSE_PLACE_ORDER_LIMIT, &AdaptiveOfferingAgent::handlePlaceOrderLimitResponse)
+	.on(MESSAGETYPE_RESPONSE_PLACE_ORDER_MARKET, &AdaptiveOfferingAgent::handlePlaceOrderMarketResponse)
+	.on(MESSAGETYPE_EVENT_EXECUTION, &AdaptiveOfferingAgent::handleExecutionEvent)
+	.on(MESSAGETYPE_EVENT_SIMULATION_STOP, &AdaptiveOfferingAgent::handleSimulationStop);
+
 void AdaptiveOfferingAgent::receiveMessage(const MessagePtr& msg) {
+	s_dispatchTable.dispatch(this, msg);
+}
+
+void AdaptiveOfferingAgent::handleSimulationStart(const MessagePtr& msg) {
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), 0, id(), m_exchangeId, MESSAGETYPE_SUBSCRIBE_EVENT_EXECUTION, SubscribeEventPayload(m_symbol));
+	auto delay = computeOrderCancellationDelay();
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), delay, id(), id(), MESSAGETYPE_WAKEUP_FOR_CANCELLATION, std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
+}
+
+void AdaptiveOfferingAgent::handleWakeupForCancellation(const MessagePtr& msg) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-	if (msg->type == "EVENT_SIMULATION_START") {
-		auto delay = computeOrderCancellationDelay();
-		simulation()->dispatchMessage(simulation()->currentTimestamp(), delay, name(), name(), "WAKEUP_FOR_CANCELLATION", std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
-	} else if (msg->type == "WAKEUP_FOR_CANCELLATION") {
-		auto pptr = std::dynamic_pointer_cast<WakeupForCancellationPayload>(msg->payload);
-		if (pptr->orderToCancelId == m_currentOrder.id && m_currentOrder.id != 0) {
-			auto cpptr = std::make_shared<CancelOrdersPayload>();
-			cpptr->cancellations.push_back(CancelOrdersCancellation(m_currentOrder.id, m_currentOrder.offeredVolume));
-			simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "CANCEL_ORDERS", cpptr);
-		} else {
-			simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "RETRIEVE_L1", std::make_shared<EmptyPayload>());
-		}
-	} else if (msg->type == "RESPONSE_CANCEL_ORDERS") {
-		const Volume tradedDelta = m_currentOrder.offeredVolume - m_currentOrder.currentVolume;
-		const Timestamp timeDelta = currentTimestamp - m_currentOrder.timeOfPlacement;
-		if(timeDelta > 0) {
-			auto& ffr = m_fulfillmentRates[m_currentOrder.centDeltaFromBestPrice];
-			ffr.push_back(std::make_pair(timeDelta, (double)tradedDelta / m_currentOrder.offeredVolume));
-			if (ffr.size() > m_memorySize) {
-				ffr.pop_front();
-			}
+	auto payload = std::static_pointer_cast<WakeupForCancellationPayload>(std::get<MessagePayloadPtr>(msg->payload));
+	if (payload->orderToCancelId == m_currentOrder.id && m_currentOrder.id != 0) {
+		CancelOrdersPayload cancelPayload;
+		cancelPayload.symbol = m_symbol;
+		cancelPayload.cancellations.push_back(CancelOrdersCancellation(m_currentOrder.id, m_currentOrder.offeredVolume));
+		simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_CANCEL_ORDERS, std::move(cancelPayload));
+	} else {
+		simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_RETRIEVE_L1, RetrieveL1Payload(m_symbol));
+	}
+}
+
+void AdaptiveOfferingAgent::handleCancelOrdersResponse(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	const Volume tradedDelta = m_currentOrder.offeredVolume - m_currentOrder.currentVolume;
+	const Timestamp timeDelta = currentTimestamp - m_currentOrder.timeOfPlacement;
+	if(timeDelta > 0) {
+		auto& ffr = m_fulfillmentRates[m_currentOrder.centDeltaFromBestPrice];
+		ffr.push_back(std::make_pair(timeDelta, (double)tradedDelta / m_currentOrder.offeredVolume));
+		if (ffr.size() > m_memorySize) {
+			ffr.pop_front();
 		}
+	}
 
-		m_currentOrder.id = 0;
-		simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "RETRIEVE_L1", std::make_shared<EmptyPayload>());
-	} else if (msg->type == "RESPONSE_RETRIEVE_L1") {
-		auto l1ptr = std::dynamic_pointer_cast<RetrieveL1ResponsePayload>(msg->payload);
-		
-		// place an order based on the current L1 status
-		std::bernoulli_distribution orderTypeDistribution(m_marketOrderFraction);
-		std::bernoulli_distribution orderDirectionDistribution(0.5);
-		bool isMarketOrder = orderTypeDistribution(simulation()->randomGenerator());
-		OrderDirection direction = orderDirectionDistribution(simulation()->randomGenerator()) ? OrderDirection::Buy : OrderDirection::Sell;
-		if (isMarketOrder) {
-			auto pptr = std::make_shared<PlaceOrderMarketPayload>(direction, m_volumeUnit);
-			simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "PLACE_ORDER_MARKET", pptr);
-		} else {
-			std::uniform_real_distribution<> priceUniformDistribution(std::numeric_limits<double>::min(), 1.0);
-			double randomUniformForPrice = priceUniformDistribution(simulation()->randomGenerator());
-			Money priceDeltaFromBest = Money(randomUniformForPrice * m_priceScale);
-			const auto inCents = priceDeltaFromBest.floorToCents();
-
-			Money price;
-			if (direction == OrderDirection::Buy) {
-				price = l1ptr->bestAskPrice - inCents;
-			} else {
-				price = l1ptr->bestBidPrice + inCents;
-			}
+	m_currentOrder.id = 0;
+	simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_RETRIEVE_L1, RetrieveL1Payload(m_symbol));
+}
+
+void AdaptiveOfferingAgent::handleRetrieveL1Response(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-			m_currentOrder.centDeltaFromBestPrice = inCents.cents();
-			auto delay = computeOrderCancellationDelay();
-			m_currentOrder.lifeTime = delay;
-			const Volume volumeToOrder = computeVolumeToOrder(inCents.cents(), delay);
-			auto pptr = std::make_shared<PlaceOrderLimitPayload>(direction, volumeToOrder, price);
-			simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "PLACE_ORDER_LIMIT", pptr);
+	const auto& l1 = std::get<RetrieveL1ResponsePayload>(msg->payload);
+	
+	// place an order based on the current L1 status
+	std::bernoulli_distribution orderTypeDistribution(m_marketOrderFraction);
+	std::bernoulli_distribution orderDirectionDistribution(0.5);
+	bool isMarketOrder = orderTypeDistribution(simulation()->randomGenerator());
+	OrderDirection direction = orderDirectionDistribution(simulation()->randomGenerator()) ? OrderDirection::Buy : OrderDirection::Sell;
+	if (isMarketOrder) {
+		simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_MARKET, PlaceOrderMarketPayload(direction, m_volumeUnit, m_symbol));
+	} else if ((direction == OrderDirection::Buy ? l1.bestAskVolume : l1.bestBidVolume) == 0) {
+		// nothing to offer against, try again later
+		auto delay = computeOrderCancellationDelay();
+		simulation()->dispatchMessage(currentTimestamp, delay, id(), id(), MESSAGETYPE_WAKEUP_FOR_CANCELLATION, std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
+	} else {
+		std::uniform_real_distribution<> priceUniformDistribution(std::numeric_limits<double>::min(), 1.0);
+		double randomUniformForPrice = priceUniformDistribution(simulation()->randomGenerator());
+		Money priceDeltaFromBest = Money(randomUniformForPrice * m_priceScale);
+		const auto inCents = priceDeltaFromBest.floorToCents();
+
+		Money price;
+		if (direction == OrderDirection::Buy) {
+			price = l1.bestAskPrice - inCents;
+		} else {
+			price = l1.bestBidPrice + inCents;
 		}
-	} else if (msg->type == "RESPONSE_PLACE_ORDER_LIMIT") {
-		auto polptr = std::dynamic_pointer_cast<PlaceOrderLimitResponsePayload>(msg->payload);
-		m_currentOrder.id = polptr->id;
-		m_currentOrder.offeredVolume = m_currentOrder.currentVolume = polptr->requestPayload->volume;
-		m_currentOrder.timeOfPlacement = currentTimestamp;
-
-		auto pptr = std::make_shared<SubscribeEventTradeByOrderPayload>(polptr->id);
-		simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "SUBSCRIBE_EVENT_ORDER_TRADE", pptr);
-		simulation()->dispatchMessage(simulation()->currentTimestamp(), m_currentOrder.lifeTime, name(), name(), "WAKEUP_FOR_CANCELLATION", std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
-	} else if (msg->type == "RESPONSE_PLACE_ORDER_MARKET") {
+
+		m_currentOrder.centDeltaFromBestPrice = inCents.cents();
 		auto delay = computeOrderCancellationDelay();
-		simulation()->dispatchMessage(simulation()->currentTimestamp(), delay, name(), name(), "WAKEUP_FOR_CANCELLATION", std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
-	} else if (msg->type == "EVENT_TRADE") {
-		auto eventpptr = std::dynamic_pointer_cast<EventTradePayload>(msg->payload);
-		if(m_currentOrder.id == eventpptr->trade.restingOrderID()) {
-			const Volume volumeToSubtract = eventpptr->trade.volume();
-			m_currentOrder.currentVolume -= volumeToSubtract;
-
-			if (m_currentOrder.currentVolume == 0 || (m_currentOrder.offeredVolume - m_currentOrder.currentVolume) >= m_volumeUnit) {
-				simulation()->dispatchMessage(simulation()->currentTimestamp(), 0, name(), name(), "WAKEUP_FOR_CANCELLATION", std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
-			}
+		m_currentOrder.lifeTime = delay;
+		const Volume volumeToOrder = computeVolumeToOrder(inCents.cents(), delay);
+		simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_LIMIT, PlaceOrderLimitPayload(direction, volumeToOrder, price, m_symbol));
+	}
+}
+
+void AdaptiveOfferingAgent::handlePlaceOrderLimitResponse(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	const auto& response = std::get<PlaceOrderLimitResponsePayload>(msg->payload);
+	m_currentOrder.id = response.id;
+	m_currentOrder.offeredVolume = m_currentOrder.currentVolume = response.requestPayload.volume;
+	m_currentOrder.timeOfPlacement = currentTimestamp;
+
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), m_currentOrder.lifeTime, id(), id(), MESSAGETYPE_WAKEUP_FOR_CANCELLATION, std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
+}
+
+void AdaptiveOfferingAgent::handlePlaceOrderMarketResponse(const MessagePtr& msg) {
+	auto delay = computeOrderCancellationDelay();
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), delay, id(), id(), MESSAGETYPE_WAKEUP_FOR_CANCELLATION, std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
+}
+
+void AdaptiveOfferingAgent::handleExecutionEvent(const MessagePtr& msg) {
+	const auto& event = std::get<EventExecutionPayload>(msg->payload);
+	if(m_currentOrder.id == event.id) {
+		const Volume volumeToSubtract = event.trade.volume();
+		m_currentOrder.currentVolume -= volumeToSubtract;
+
+		if (m_currentOrder.currentVolume == 0 || (m_currentOrder.offeredVolume - m_currentOrder.currentVolume) >= m_volumeUnit) {
+			simulation()->dispatchMessage(simulation()->currentTimestamp(), 0, id(), id(), MESSAGETYPE_WAKEUP_FOR_CANCELLATION, std::make_shared<WakeupForCancellationPayload>(m_currentOrder.id));
 		}
-	} else if (msg->type == "EVENT_SIMULATION_STOP") {
-		for (unsigned int i = 0; i < m_fulfillmentRates.size(); ++i) {
-			if(m_fulfillmentRates[i].size()  == m_memorySize) {
-				std::ofstream statusfile("offering" + std::to_string(i) + ".csv", std::ios::app | std::ios::out);
-				const double guess = computeTradingRateObservation(i) * m_orderMeanLifeTime;
-				if(guess != 0.0) {
-					statusfile << (guess <= 1.0 ? (1.0 / guess) * m_volumeUnit : m_volumeUnit) << ",";
-				}
+	}
+}
+
+void AdaptiveOfferingAgent::handleSimulationStop(const MessagePtr& msg) {
+	for (unsigned int i = 0; i < m_fulfillmentRates.size(); ++i) {
+		if(m_fulfillmentRates[i].size()  == m_memorySize) {
+			std::ofstream statusfile("offering" + std::to_string(i) + ".csv", std::ios::app | std::ios::out);
+			const double guess = computeTradingRateObservation(i) * m_orderMeanLifeTime;
+			if(guess != 0.0) {
+				statusfile << (guess <= 1.0 ? (1.0 / guess) * m_volumeUnit : m_volumeUnit) << ",";
 			}
 		}
 	}
@@ -171,3 +214,39 @@ Volume AdaptiveOfferingAgent::computeVolumeToOrder(unsigned int priceCentsDeltaF
 		}
 	}
 }
+
+void AdaptiveOfferingAgent::saveState(SnapshotWriter& writer) {
+	writer.write(m_currentOrder.id);
+	writer.write(m_currentOrder.offeredVolume);
+	writer.write(m_currentOrder.currentVolume);
+	writer.write(m_currentOrder.centDeltaFromBestPrice);
+	writer.write(m_currentOrder.timeOfPlacement);
+	writer.write(m_currentOrder.lifeTime);
+
+	writer.write((std::uint64_t)m_fulfillmentRates.size());
+	for (const auto& rates : m_fulfillmentRates) {
+		writer.write((std::uint64_t)rates.size());
+		for (const auto& rate : rates) {
+			writer.write(rate.first);
+			writer.write(rate.second);
+		}
+	}
+}
+
+void AdaptiveOfferingAgent::loadState(SnapshotReader& reader) {
+	m_currentOrder.id = reader.read<OrderID>();
+	m_currentOrder.offeredVolume = reader.read<Volume>();
+	m_currentOrder.currentVolume = reader.read<Volume>();
+	m_currentOrder.centDeltaFromBestPrice = reader.read<unsigned int>();
+	m_currentOrder.timeOfPlacement = reader.read<Timestamp>();
+	m_currentOrder.lifeTime = reader.read<Timestamp>();
+
+	m_fulfillmentRates.resize(reader.read<std::uint64_t>());
+	for (auto& rates : m_fulfillmentRates) {
+		rates.resize(reader.read<std::uint64_t>());
+		for (auto& rate : rates) {
+			rate.first = reader.read<double>();
+			rate.second = reader.read<double>();
+		}
+	}
+}
@@ -3,6 +3,8 @@
 #include <deque>
 
 #include "Agent.h"
+#include "MessageDispatchTable.h"
+#include "SymbolId.h"
 #include "Order.h"
 
 struct WakeupForCancellationPayload : public MessagePayload {
@@ -33,10 +35,27 @@ public:
 
 	void configure(const pugi::xml_node& node, const std::string& configurationPath) override;
 
+	void saveState(SnapshotWriter& writer) override;
+	void loadState(SnapshotReader& reader) override;
+
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<AdaptiveOfferingAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& msg);
+	void handleWakeupForCancellation(const MessagePtr& msg);
+	void handleCancelOrdersResponse(const MessagePtr& msg);
+	void handleRetrieveL1Response(const MessagePtr& msg);
+	void handlePlaceOrderLimitResponse(const MessagePtr& msg);
+	void handlePlaceOrderMarketResponse(const MessagePtr& msg);
+	void handleExecutionEvent(const MessagePtr& msg);
+	void handleSimulationStop(const MessagePtr& msg);
+
 	std::string m_exchange;
+	AgentId m_exchangeId;
+	SymbolId m_symbol; // of the book on the exchange
 	Volume m_volumeUnit;
 	Timestamp m_orderMeanLifeTime;
 	double m_marketOrderFraction;
@@ -8,4 +8,11 @@ void Agent::configure(const pugi::xml_node& node, const std::string& configurati
 	if (!(att = node.attribute("name")).empty()) {
 		setName(simulation()->parameters().processString(att.as_string()) + configurationPath);
 	}
+
+	// unless told otherwise, an agent runs alongside the exchange it trades on
+	if (!(att = node.attribute("partition")).empty()) {
+		setPartition(simulation()->parameters().processString(att.as_string()));
+	} else if (!(att = node.attribute("exchange")).empty()) {
+		setPartition(simulation()->parameters().processString(att.as_string()));
+	}
 }
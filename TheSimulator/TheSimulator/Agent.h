@@ -5,15 +5,39 @@
 #include "IConfigurable.h"
 #include <string>
 
+class SnapshotWriter;
+class SnapshotReader;
+
 class Agent : public IMessageable, public IConfigurable {
 public:
 	virtual ~Agent() = default;
 
 	// Inherited via IConfigurable
 	virtual void configure(const pugi::xml_node& node, const std::string& configurationPath) override;
+
+	// Whether the agent reacts to messages of the given type. Broadcasts and wildcard sends skip the agents
+	// that do not consume the type; messages addressed to the agent itself are delivered regardless.
+	virtual bool consumes(MessageType type) const { return true; }
+
+	// Called once every agent is configured and has its id, for the agent to look up the ids of the agents it was configured
+	// to send to, so that its messages are addressed by id rather than by name.
+	virtual void resolveAgentIds() { }
+
+	// The key of the partition the agent runs in when the simulation is parallel; the agents sharing a key run together,
+	// an empty key places the agent into the default partition.
+	const std::string& partition() const { return m_partition; }
+
+	// The state the agent built up while simulating. A snapshot is loaded into a simulation configured anew from the same
+	// file, so whatever the configuration sets need not be saved; the agents without such state keep the defaults.
+	virtual void saveState(SnapshotWriter& writer) { }
+	virtual void loadState(SnapshotReader& reader) { }
 protected:
 	Agent(const Simulation* simulation)
 		: Agent(simulation, "") { }
 	Agent(const Simulation* simulation, const std::string& name)
-		: IMessageable(simulation, name) { }
+		: IMessageable(simulation, name), m_partition() { }
+
+	void setPartition(const std::string& partition) { m_partition = partition; }
+private:
+	std::string m_partition;
 };
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+
+using AgentId = unsigned int;
+
+constexpr AgentId AGENTID_INVALID = (AgentId)-1;
+constexpr AgentId AGENTID_SIMULATION = (AgentId)-2;
+constexpr AgentId AGENTID_BROADCAST = (AgentId)-3;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Book.h"
+#include "TradeSink.h"
+
+#include <algorithm>
+
+// A book with the matching algorithm and the trade sink fixed at compile time, so that the whole match loop inlines down to
+// the fills. The loop walks the levels of the other side, the best one first, while they cross; the matching policy decides
+// how the aggressor is shared out among the orders of a level. A policy provides
+//	template <class BookType> void matchBettering(BookType& book, Order& order, PriceLadder& queue, OrderHandle bettering);
+//	template <class BookType> void matchLevel(BookType& book, Order& order, PriceLevel& level);
+// the first one before the loop, for the priority of the last bettering order on the other side, the second one for every level.
+// Both of them change the book only through fill() and removeLimitOrder(). The specializations the exchange can configure
+// are instantiated along with their policies, see PriceTimeBook.h and the like.
+template <class MatchingPolicy, class TradeSink>
+class BasicBook : public Book {
+public:
+	BasicBook(OrderFactoryPtr orderFactoryPtr, TradeFactoryPtr tradeFactoryPtr, Money tickSize, size_t ladderWindow = PriceLadder::DEFAULT_WINDOW_SIZE)
+		: Book(orderFactoryPtr, tradeFactoryPtr, tickSize, ladderWindow), m_matching(), m_tradeSink(), m_aggressingAgent(AGENTID_INVALID) { }
+
+	MarketOrderPtr placeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume, AgentId owner) final;
+	LimitOrderPtr placeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price, AgentId owner) final;
+	void takeTrades(std::vector<Trade>& trades) final { m_tradeSink.take(trades); }
+
+	// for the matching policy
+	const BookOrder& record(OrderHandle handle) const { return m_orderPool[handle]; }
+	// the volume taken from the resting order of the level and from the aggressor, traded at the price; none is no trade
+	void fill(Order& aggressor, PriceLevel& level, OrderHandle resting, Volume volume, Price price);
+	using Book::levelOf;
+	using Book::removeLimitOrder;
+private:
+	MatchingPolicy m_matching;
+	TradeSink m_tradeSink;
+	AgentId m_aggressingAgent; // the owner of the order being placed
+
+	// the aggressor against the levels of the other side as long as they are within the limit, which they are to begin with
+	void match(Order& aggressor, Price limit);
+};
+
+template <class MatchingPolicy, class TradeSink>
+MarketOrderPtr BasicBook<MatchingPolicy, TradeSink>::placeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume, AgentId owner) {
+	auto ret = makeMarketOrder(direction, timestamp, volume);
+	m_aggressingAgent = owner;
+
+	// with the other side empty, the market order is a no-op
+	const bool buy = direction == OrderDirection::Buy;
+	if (!(buy ? m_sellQueue : m_buyQueue).empty()) {
+		match(*ret, buy ? Price::highest() : Price::lowest());
+	}
+	triggerStopOrders(timestamp);
+
+	return ret;
+}
+
+template <class MatchingPolicy, class TradeSink>
+LimitOrderPtr BasicBook<MatchingPolicy, TradeSink>::placeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price, AgentId owner) {
+	const Price onGrid = gridPrice(direction, price);
+	auto ret = makeLimitOrder(direction, timestamp, volume, onGrid.toMoney(tickSize()));
+	m_aggressingAgent = owner;
+
+	const bool buy = direction == OrderDirection::Buy;
+	const PriceLadder& queue = buy ? m_sellQueue : m_buyQueue;
+	if (!queue.empty() && (buy ? queue.best().price() <= onGrid : queue.best().price() >= onGrid)) {
+		match(*ret, onGrid);
+	}
+	if (ret->volume() > 0) {
+		restLimitOrder(*ret, onGrid, owner);
+	}
+	triggerStopOrders(timestamp);
+
+	return ret;
+}
+
+template <class MatchingPolicy, class TradeSink>
+void BasicBook<MatchingPolicy, TradeSink>::fill(Order& aggressor, PriceLevel& level, OrderHandle resting, Volume volume, Price price) {
+	if (volume == 0) {
+		return;
+	}
+
+	level.removeVolume(resting, volume);
+	aggressor.removeVolume(volume);
+	m_tradeSink.record(tradeFactory()->makeRecord(TIMESTAMP_INVALID, aggressor.direction(), aggressor.id(), m_orderPool[resting].id, volume, price.toMoney(tickSize()),
+		m_aggressingAgent, m_orderPool[resting].owner));
+	recordTrade(price);
+}
+
+template <class MatchingPolicy, class TradeSink>
+void BasicBook<MatchingPolicy, TradeSink>::match(Order& aggressor, Price limit) {
+	const bool buy = aggressor.direction() == OrderDirection::Buy;
+	PriceLadder& queue = buy ? m_sellQueue : m_buyQueue;
+
+	if (aggressor.volume() > 0) {
+		m_matching.matchBettering(*this, aggressor, queue, buy ? m_lastBetteringSellOrder : m_lastBetteringBuyOrder);
+	}
+	while (aggressor.volume() > 0 && !queue.empty() && (buy ? queue.best().price() <= limit : queue.best().price() >= limit)) {
+		PriceLevel& level = queue.best();
+		m_matching.matchLevel(*this, aggressor, level);
+		if (level.empty()) {
+			queue.popBest();
+		}
+	}
+}
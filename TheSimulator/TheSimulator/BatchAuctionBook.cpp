@@ -0,0 +1,202 @@
+#include "BatchAuctionBook.h"
+#include "Snapshot.h"
+
+#include <cstdlib>
+
+BatchAuctionBook::BatchAuctionBook(OrderFactoryPtr orderFactoryPtr, TradeFactoryPtr tradeFactoryPtr, Money tickSize, size_t ladderWindow)
+	: Book(orderFactoryPtr, tradeFactoryPtr, tickSize, ladderWindow), m_tradeSink() { }
+
+MarketOrderPtr BatchAuctionBook::placeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume, AgentId owner) {
+	auto ret = makeMarketOrder(direction, timestamp, volume);
+	(direction == OrderDirection::Buy ? m_buyMarketOrders : m_sellMarketOrders).push_back({ ret, owner });
+	return ret;
+}
+
+LimitOrderPtr BatchAuctionBook::placeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price, AgentId owner) {
+	const Price onGrid = gridPrice(direction, price);
+	auto ret = makeLimitOrder(direction, timestamp, volume, onGrid.toMoney(tickSize()));
+
+	// it rests even if it crosses the book, until the uncross
+	if (ret->volume() > 0) {
+		restLimitOrder(*ret, onGrid, owner);
+	}
+
+	return ret;
+}
+
+void BatchAuctionBook::uncross(Timestamp timestamp) {
+	Price price;
+	Volume remaining = clearingPrice(price);
+	const bool traded = remaining > 0;
+
+	size_t buyIndex = 0;
+	size_t sellIndex = 0;
+	while (remaining > 0) {
+		const Participant buy = front(m_buyMarketOrders, buyIndex, m_buyQueue);
+		const Participant sell = front(m_sellMarketOrders, sellIndex, m_sellQueue);
+		const Volume volume = std::min({ buy.volume, sell.volume, remaining });
+
+		const bool buyAggresses = buy.id > sell.id;
+		const Participant& aggressor = buyAggresses ? buy : sell;
+		const Participant& resting = buyAggresses ? sell : buy;
+		m_tradeSink.record(tradeFactory()->makeRecord(TIMESTAMP_INVALID, buyAggresses ? OrderDirection::Buy : OrderDirection::Sell, aggressor.id, resting.id, volume, price.toMoney(tickSize()),
+			aggressor.owner, resting.owner));
+
+		fill(buy, m_buyQueue, volume);
+		fill(sell, m_sellQueue, volume);
+		remaining -= volume;
+	}
+	if (traded) {
+		recordTrade(price);
+	}
+
+	m_buyMarketOrders.clear();
+	m_sellMarketOrders.clear();
+	// the stop orders the clearing price triggers wait for the next uncross along with the rest
+	triggerStopOrders(timestamp);
+}
+
+Volume BatchAuctionBook::clearingPrice(Price& price) {
+	Volume marketBuyVolume = 0;
+	for (const WaitingMarketOrder& waiting : m_buyMarketOrders) {
+		marketBuyVolume += waiting.order->volume();
+	}
+	Volume marketSellVolume = 0;
+	for (const WaitingMarketOrder& waiting : m_sellMarketOrders) {
+		marketSellVolume += waiting.order->volume();
+	}
+
+	// the levels past the best price of the other side find nobody to trade with, unless there are market orders over there
+	m_demand.clear();
+	for (const PriceLevel& level : m_buyQueue) {
+		if (marketSellVolume == 0 && (m_sellQueue.empty() || level.price() < m_sellQueue.best().price())) {
+			break;
+		}
+		m_demand.push_back({ level.price(), level.volume() });
+	}
+	m_supply.clear();
+	for (const PriceLevel& level : m_sellQueue) {
+		if (marketBuyVolume == 0 && (m_buyQueue.empty() || level.price() > m_buyQueue.best().price())) {
+			break;
+		}
+		m_supply.push_back({ level.price(), level.volume() });
+	}
+
+	Volume cumulative = marketBuyVolume;
+	for (CurvePoint& point : m_demand) {
+		cumulative += point.volume;
+		point.volume = cumulative;
+	}
+	cumulative = marketSellVolume;
+	for (CurvePoint& point : m_supply) {
+		cumulative += point.volume;
+		point.volume = cumulative;
+	}
+
+	// the prices of both curves from the lowest one up, the demand falls and the supply rises along them
+	Volume bestVolume = 0;
+	long long bestImbalance = 0;
+	long long lowestImbalance = 0;
+	long long highestImbalance = 0;
+	m_candidates.clear();
+	size_t demandIndex = m_demand.size(); // m_demand[demandIndex - 1] is the lowest buy level at the price or above
+	size_t supplyIndex = 0;
+	while (demandIndex > 0 || supplyIndex < m_supply.size()) {
+		const Price candidate = supplyIndex == m_supply.size() || (demandIndex > 0 && m_demand[demandIndex - 1].price < m_supply[supplyIndex].price)
+			? m_demand[demandIndex - 1].price
+			: m_supply[supplyIndex].price;
+
+		const Volume demand = demandIndex > 0 ? m_demand[demandIndex - 1].volume : marketBuyVolume;
+		if (demandIndex > 0 && m_demand[demandIndex - 1].price == candidate) {
+			--demandIndex;
+		}
+		if (supplyIndex < m_supply.size() && m_supply[supplyIndex].price == candidate) {
+			++supplyIndex;
+		}
+		const Volume supply = supplyIndex > 0 ? m_supply[supplyIndex - 1].volume : marketSellVolume;
+
+		const Volume volume = std::min(demand, supply);
+		const long long imbalance = (long long)demand - (long long)supply;
+		if (volume == 0) {
+			continue;
+		}
+		if (volume > bestVolume || (volume == bestVolume && std::llabs(imbalance) < std::llabs(bestImbalance))) {
+			bestVolume = volume;
+			bestImbalance = imbalance;
+			lowestImbalance = imbalance;
+			m_candidates.clear();
+		}
+		if (volume == bestVolume && std::llabs(imbalance) == std::llabs(bestImbalance)) {
+			highestImbalance = imbalance;
+			m_candidates.push_back(candidate);
+		}
+	}
+
+	if (bestVolume == 0) {
+		return 0;
+	}
+
+	if (lowestImbalance > 0 && highestImbalance > 0) {
+		price = m_candidates.back();
+	} else if (lowestImbalance < 0 && highestImbalance < 0) {
+		price = m_candidates.front();
+	} else {
+		price = m_candidates[(m_candidates.size() - 1) / 2];
+	}
+	return bestVolume;
+}
+
+BatchAuctionBook::Participant BatchAuctionBook::front(std::vector<WaitingMarketOrder>& marketOrders, size_t& marketIndex, PriceLadder& queue) {
+	while (marketIndex < marketOrders.size() && marketOrders[marketIndex].order->volume() == 0) {
+		++marketIndex;
+	}
+	if (marketIndex < marketOrders.size()) {
+		WaitingMarketOrder& waiting = marketOrders[marketIndex];
+		return { waiting.order->id(), waiting.owner, waiting.order->volume(), &waiting, ORDERHANDLE_NONE };
+	}
+
+	const OrderHandle handle = queue.best().front();
+	const BookOrder& record = m_orderPool[handle];
+	return { record.id, record.owner, record.volume, nullptr, handle };
+}
+
+void BatchAuctionBook::fill(const Participant& participant, PriceLadder& queue, Volume volume) {
+	if (participant.marketOrder != nullptr) {
+		participant.marketOrder->order->removeVolume(volume);
+		return;
+	}
+
+	PriceLevel& level = queue.best();
+	level.removeVolume(participant.handle, volume);
+	if (m_orderPool[participant.handle].volume == 0) {
+		removeLimitOrder(level, participant.handle);
+		if (level.empty()) {
+			queue.popBest();
+		}
+	}
+}
+
+void BatchAuctionBook::saveState(SnapshotWriter& writer) const {
+	Book::saveState(writer);
+
+	for (const std::vector<WaitingMarketOrder>* marketOrders : { &m_buyMarketOrders, &m_sellMarketOrders }) {
+		writer.write((std::uint64_t)marketOrders->size());
+		for (const WaitingMarketOrder& waiting : *marketOrders) {
+			writer.writeMarketOrder(*waiting.order);
+			writer.write(waiting.owner);
+		}
+	}
+}
+
+void BatchAuctionBook::loadState(SnapshotReader& reader) {
+	Book::loadState(reader);
+
+	for (std::vector<WaitingMarketOrder>* marketOrders : { &m_buyMarketOrders, &m_sellMarketOrders }) {
+		marketOrders->clear();
+		const std::uint64_t count = reader.read<std::uint64_t>();
+		for (std::uint64_t index = 0; index < count; ++index) {
+			auto order = std::make_shared<MarketOrder>(reader.readMarketOrder());
+			marketOrders->push_back({ order, reader.read<AgentId>() });
+		}
+	}
+}
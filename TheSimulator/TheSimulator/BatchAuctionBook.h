@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Book.h"
+#include "TradeSink.h"
+
+#include <vector>
+
+// A book which does not match as the orders come in, but collects them until the next uncross and then clears them all in one
+// auction at a uniform price, as in the call auctions at the open and the close, or in frequent batch auctions. The limit orders
+// rest in their levels meanwhile, the book may well be crossed; the market orders wait on the side, and whatever is left of them
+// after the uncross lapses. The clearing price is the one of a level of either side at which the most volume trades; among those,
+// the one leaving the least imbalance between the demand and the supply, then the highest of them while the demand is in excess,
+// the lowest while the supply is, and the middle one otherwise. The orders at that price or better trade in price-time priority,
+// the market orders first, the later order of every pair being the aggressing one.
+class BatchAuctionBook : public Book {
+public:
+	BatchAuctionBook(OrderFactoryPtr orderFactoryPtr, TradeFactoryPtr tradeFactoryPtr, Money tickSize, size_t ladderWindow = PriceLadder::DEFAULT_WINDOW_SIZE);
+
+	MarketOrderPtr placeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume, AgentId owner) override;
+	LimitOrderPtr placeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price, AgentId owner) override;
+	void takeTrades(std::vector<Trade>& trades) override { m_tradeSink.take(trades); }
+	void uncross(Timestamp timestamp) override;
+
+	// the market orders waiting for the uncross along with the rest
+	void saveState(SnapshotWriter& writer) const override;
+	void loadState(SnapshotReader& reader) override;
+private:
+	struct WaitingMarketOrder {
+		MarketOrderPtr order;
+		AgentId owner;
+	};
+
+	// a price of the supply and demand curves, with the volume of either side that would trade there
+	struct CurvePoint {
+		Price price;
+		Volume volume; // of the level, then of all the orders at its price or better
+	};
+
+	// the one next in line on a side of the uncross, a waiting market order or the oldest order of the best level
+	struct Participant {
+		OrderID id;
+		AgentId owner;
+		Volume volume;
+		WaitingMarketOrder* marketOrder; // nullptr for a resting order
+		OrderHandle handle;
+	};
+
+	BufferedTradeSink m_tradeSink;
+	std::vector<WaitingMarketOrder> m_buyMarketOrders;
+	std::vector<WaitingMarketOrder> m_sellMarketOrders;
+	// kept between the uncrosses so that they do not allocate
+	std::vector<CurvePoint> m_demand; // the best buy level first
+	std::vector<CurvePoint> m_supply; // the best sell level first
+	std::vector<Price> m_candidates; // the prices tied for the clearing price
+
+	// the volume which trades at the clearing price, none if the book does not cross
+	Volume clearingPrice(Price& price);
+	Participant front(std::vector<WaitingMarketOrder>& marketOrders, size_t& marketIndex, PriceLadder& queue);
+	void fill(const Participant& participant, PriceLadder& queue, Volume volume);
+};
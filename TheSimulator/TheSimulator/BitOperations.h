@@ -0,0 +1,27 @@
+#pragma once
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// the word must be nonzero
+inline unsigned int countTrailingZeros(unsigned long long word) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctzll(word);
+#endif
+}
+
+// the word must be nonzero
+inline unsigned int countLeadingZeros(unsigned long long word) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, word);
+	return 63 - (unsigned int)index;
+#else
+	return (unsigned int)__builtin_clzll(word);
+#endif
+}
@@ -1,136 +1,180 @@
 #include "Book.h"
+#include "Snapshot.h"
 
-TickContainer::TickContainer(Money price)
-	: m_price(price), list() { }
-
-Book::Book(OrderFactoryPtr orderRecordPtr, TradeFactoryPtr tradeRecordPtr)
-	: m_orderRecordPtr(orderRecordPtr), m_tradeRecordPtr(tradeRecordPtr), m_tradeLoggingCallback([] (TradePtr) { }), m_buyQueue(), m_sellQueue(), m_orderIdMap(), m_lastBetteringBuyOrder(nullptr), m_lastBetteringSellOrder(nullptr) { }
-
-void Book::placeOrder(const LimitOrderPtr& order) {
-	if (order->direction() == OrderDirection::Sell) {
-		if (m_buyQueue.empty() || order->price() > this->m_buyQueue.back().price()) {
-			auto firstGreaterThan = m_sellQueue.end();
-			for (auto it = m_sellQueue.begin(); it != m_sellQueue.end(); ++it) {
-				if (it->price() >= order->price()) {
-					firstGreaterThan = it;
-					break;
-				}
-			}
+Book::Book(OrderFactoryPtr orderRecordPtr, TradeFactoryPtr tradeRecordPtr, Money tickSize, size_t ladderWindow)
+	: m_orderIndex(), m_orderPool(tickSize), m_buyQueue(OrderDirection::Buy, &m_orderPool, ladderWindow), m_lastBetteringBuyOrder(ORDERHANDLE_NONE),
+	m_sellQueue(OrderDirection::Sell, &m_orderPool, ladderWindow),
+	m_lastBetteringSellOrder(ORDERHANDLE_NONE), m_stopOrders(), m_triggeredStops(), m_lowestTradePrice(), m_highestTradePrice(), m_traded(false), m_triggering(false), m_stopOrderId(ORDERID_INVALID),
+	m_tickSize(tickSize), m_orderRecordPtr(orderRecordPtr), m_tradeRecordPtr(tradeRecordPtr) { }
 
-			if (firstGreaterThan != m_sellQueue.end() && firstGreaterThan->price() == order->price()) {
-				registerLimitOrder(order);
-				firstGreaterThan->push_back(order);
-			} else {
-				TickContainer tov = TickContainer(order->price());
-				registerLimitOrder(order);
-				tov.push_back(order);
-				m_sellQueue.insert(firstGreaterThan, tov);
+Price Book::gridPrice(OrderDirection direction, Money price) const {
+	// neither of them crosses any further that way
+	return direction == OrderDirection::Buy ? Price::floorOf(price, m_tickSize) : Price::ceilOf(price, m_tickSize);
+}
 
-				m_lastBetteringSellOrder = order;
-			}
-		} else {
-			processAgainstTheBuyQueue(order, order->price());
+void Book::restLimitOrder(const LimitOrder& order, Price price, AgentId owner) {
+	const bool buy = order.direction() == OrderDirection::Buy;
+	auto level = (buy ? m_buyQueue : m_sellQueue).emplace(price);
+	const OrderHandle handle = m_orderPool.allocate(order, owner);
+	registerLimitOrder(handle);
+	level.first->pushBack(handle);
+	// only a new level in front of the others betters the price
+	if (level.second && &(buy ? m_buyQueue : m_sellQueue).best() == level.first) {
+		(buy ? m_lastBetteringBuyOrder : m_lastBetteringSellOrder) = handle;
+	}
+}
 
-			if (order->volume() > 0) {
-				this->placeOrder(order);
-			}
-		}
-	} else {
-		if (m_sellQueue.empty() || order->price() < this->m_sellQueue.front().price()) {
-			auto firstLessThan = m_buyQueue.rend();
-			for (auto rit = m_buyQueue.rbegin(); rit != m_buyQueue.rend(); ++rit) {
-				if (rit->price() <= order->price()) {
-					firstLessThan = rit;
-					break;
-				}
-			}
+OrderID Book::placeStopOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money stopPrice, std::optional<Money> limitPrice, AgentId owner) {
+	// off the grid, the stop price goes to the tick the trades reach first
+	const Price onGrid = direction == OrderDirection::Buy ? Price::ceilOf(stopPrice, m_tickSize) : Price::floorOf(stopPrice, m_tickSize);
+	const OrderID id = orderFactory()->makeId();
+	m_stopOrders.insert({ id, timestamp, onGrid, limitPrice.value_or(Money(0)), volume, owner, direction, limitPrice.has_value() });
+	return id;
+}
 
-			if (firstLessThan != m_buyQueue.rend() && firstLessThan->price() == order->price()) {
-				registerLimitOrder(order);
-				firstLessThan->push_back(order);
-			} else {
-				TickContainer tov = TickContainer(order->price());
-				registerLimitOrder(order);
-				tov.push_back(order);
-				m_buyQueue.insert(firstLessThan.base(), tov);
+MarketOrderPtr Book::makeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume) {
+	return m_stopOrderId == ORDERID_INVALID
+		? orderFactory()->makeMarketOrder(direction, timestamp, volume)
+		: orderFactory()->makeMarketOrder(m_stopOrderId, direction, timestamp, volume);
+}
 
-				m_lastBetteringBuyOrder = order;
-			}
-		} else {
-			processAgainstTheSellQueue(order, order->price());
+LimitOrderPtr Book::makeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price) {
+	return m_stopOrderId == ORDERID_INVALID
+		? orderFactory()->makeLimitOrder(direction, timestamp, volume, price)
+		: orderFactory()->makeLimitOrder(m_stopOrderId, direction, timestamp, volume, price);
+}
 
-			if (order->volume() > 0) {
-				this->placeOrder(order);
-			}
-		}
+void Book::fireStopOrders(Timestamp timestamp) {
+	m_traded = false;
+	if (m_stopOrders.empty()) {
+		return;
 	}
-}
 
-void Book::placeOrder(const MarketOrderPtr& order) {
-	if (order->direction() == OrderDirection::Sell) {
-		if(!m_buyQueue.empty()) {
-			processAgainstTheBuyQueue(order, -1e9); // don't ask
+	m_triggering = true;
+	m_triggeredStops.clear();
+	m_stopOrders.trigger(m_highestTradePrice, m_lowestTradePrice, m_triggeredStops);
+	// breadth first, the orders triggered by the trades of a triggered order queue up behind the ones triggered along with it
+	for (size_t index = 0; index < m_triggeredStops.size(); ++index) {
+		const StopOrder stop = m_triggeredStops[index];
+		m_stopOrderId = stop.id;
+		if (stop.limit) {
+			placeLimitOrder(stop.direction, timestamp, stop.volume, stop.limitPrice, stop.owner);
 		} else {
-			// auto p = placeLimitOrder(OrderDirection::Sell, order->timestamp(), order->volume(), m_lastBetteringSellOrder->price());  // we need setup agents to guarantee this is sensible
-			// I think that the above line was only introduced to deal with the zero intelligence simulations. I do now strongly believe this case should be a no-op.
+			placeMarketOrder(stop.direction, timestamp, stop.volume, stop.owner);
 		}
-	} else {
-		if (!m_sellQueue.empty()) {
-			processAgainstTheSellQueue(order, 1e9); // assuming nothing trades at 1BN per lot
-		} else {
-			// auto p = placeLimitOrder(OrderDirection::Buy, order->timestamp(), order->volume(), m_lastBetteringBuyOrder->price()); // we need setup agents to guarantee this is sensible
-			// I think that the above line was only introduced to deal with the zero intelligence simulations. I do now strongly believe this case should be a no-op.
+		m_stopOrderId = ORDERID_INVALID;
+
+		if (m_traded) {
+			m_traded = false;
+			m_stopOrders.trigger(m_highestTradePrice, m_lowestTradePrice, m_triggeredStops);
 		}
 	}
+	m_triggeredStops.clear();
+	m_triggering = false;
 }
 
-MarketOrderPtr Book::placeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume) {
-	auto ret = m_orderRecordPtr->makeMarketOrder(direction, timestamp, volume);
-	placeOrder(ret);
-
-	return ret;
-}
+Volume Book::cancelOrder(const OrderID orderId) {
+	// POLICY: action requested on a non-existing orderId is a no-op
 
-LimitOrderPtr Book::placeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price) {
-	auto ret = m_orderRecordPtr->makeLimitOrder(direction, timestamp, volume, price);
-	placeOrder(ret);
+	const OrderHandle handle = m_orderIndex.find(orderId);
+	if (handle != ORDERHANDLE_NONE) {
+		const Volume cancelled = m_orderPool[handle].volume;
+		cancelLimitOrder(handle);
+		return cancelled;
+	}
 
-	return ret;
+	const StopOrder* stop = m_stopOrders.find(orderId);
+	if (stop == nullptr) {
+		return 0;
+	}
+	const Volume cancelled = stop->volume;
+	m_stopOrders.erase(orderId);
+	return cancelled;
 }
 
-void Book::cancelOrder(const OrderID orderId) {
-	// POLICY: even the filled and cancelled orders still survive in this hashmap, for future analysis
+Volume Book::cancelOrder(const OrderID orderId, Volume volumeToCancel) {
 	// POLICY: action requested on a non-existing orderId is a no-op
+	// POLICY: cancelling a part of the order keeps its place in the level
+
+	// returns remaining volume
+
+	const OrderHandle handle = m_orderIndex.find(orderId);
+	if (handle == ORDERHANDLE_NONE) {
+		StopOrder* stop = m_stopOrders.find(orderId);
+		if (stop == nullptr || volumeToCancel >= stop->volume) {
+			m_stopOrders.erase(orderId);
+			return 0;
+		}
+		stop->volume -= volumeToCancel;
+		return stop->volume;
+	}
 
-	if (m_orderIdMap.count(orderId) > 0) {
-		m_orderIdMap[orderId]->setVolume(0);
-		m_orderIdMap.erase(orderId);
+	const Volume originalVolume = m_orderPool[handle].volume;
+	if (volumeToCancel >= originalVolume) {
+		cancelLimitOrder(handle);
+		return 0;
 	}
+
+	levelOf(handle).removeVolume(handle, volumeToCancel);
+	return originalVolume - volumeToCancel;
 }
 
-Volume Book::cancelOrder(const OrderID orderId, Volume volumeToCancel) {
-	// POLICY: even the filled and cancelled orders still survive in this hashmap, for future analysis
+Volume Book::amendOrder(const OrderID orderId, Timestamp timestamp, Volume volume) {
 	// POLICY: action requested on a non-existing orderId is a no-op
 
-	// returns remaining volume
+	// returns the volume the order is left with
 
-	Volume remainingVolume = 0;
-	if(m_orderIdMap.count(orderId) > 0) {
-		const Volume originalVolume = m_orderIdMap[orderId]->volume();
-		remainingVolume = std::min((Volume)0, originalVolume - volumeToCancel);
-		m_orderIdMap[orderId]->setVolume(remainingVolume);
-		if (remainingVolume == 0) {
-			m_orderIdMap.erase(orderId);
+	const OrderHandle handle = m_orderIndex.find(orderId);
+	if (handle == ORDERHANDLE_NONE) {
+		// a stop order has no place to lose before it triggers
+		StopOrder* stop = m_stopOrders.find(orderId);
+		if (stop == nullptr) {
+			return 0;
+		}
+		if (volume == 0) {
+			m_stopOrders.erase(orderId);
+		} else {
+			stop->volume = volume;
 		}
+		return volume;
 	}
 
-	return remainingVolume;
+	BookOrder& record = m_orderPool[handle];
+	if (volume == 0) {
+		cancelLimitOrder(handle);
+	} else if (volume <= record.volume) {
+		levelOf(handle).removeVolume(handle, record.volume - volume);
+	} else {
+		// the order loses its priority, including the one for bettering the price
+		PriceLevel& level = levelOf(handle);
+		level.unlink(handle);
+		record.timestamp = timestamp;
+		record.volume = volume;
+		level.pushBack(handle);
+		if (m_lastBetteringBuyOrder == handle) {
+			m_lastBetteringBuyOrder = ORDERHANDLE_NONE;
+		}
+		if (m_lastBetteringSellOrder == handle) {
+			m_lastBetteringSellOrder = ORDERHANDLE_NONE;
+		}
+	}
+
+	return volume;
+}
+
+Volume Book::volumeOf(OrderID id) const {
+	const OrderHandle handle = m_orderIndex.find(id);
+	if (handle != ORDERHANDLE_NONE) {
+		return m_orderPool[handle].volume;
+	}
+	const StopOrder* stop = m_stopOrders.find(id);
+	return stop != nullptr ? stop->volume : 0;
 }
 
 bool Book::tryGetOrder(OrderID id, LimitOrderPtr& orderPtr) const {
-	decltype(m_orderIdMap)::const_iterator it;
-	if ((it = m_orderIdMap.find(id)) != m_orderIdMap.end()) {
-		orderPtr = it->second;
+	const OrderHandle handle = m_orderIndex.find(id);
+	if (handle != ORDERHANDLE_NONE) {
+		orderPtr = m_orderPool.snapshot(handle);
 		return true;
 	} else {
 		return false;
@@ -149,38 +193,121 @@ void Book::printHuman(unsigned int depth) const {
 	std::cout << "----------------" << std::endl;
 
 	std::cout << "ask:";
-	dumpHumanLOB(m_sellQueue.cbegin(), m_sellQueue.cend(), depth);
+	dumpHumanLOB(m_sellQueue.begin(), m_sellQueue.end(), depth);
 	std::cout << std::endl;
 
 	std::cout << "bid:";
-	dumpHumanLOB(m_buyQueue.crbegin(), m_buyQueue.crend(), depth);
+	dumpHumanLOB(m_buyQueue.begin(), m_buyQueue.end(), depth);
 	std::cout << std::endl << std::endl;
 }
 
 void Book::printCSV(unsigned int depth) const {
 	std::cout << "ask";
-	dumpCSVLOB(m_sellQueue.cbegin(), m_sellQueue.cend(), depth);
+	dumpCSVLOB(m_sellQueue.begin(), m_sellQueue.end(), depth);
 	std::cout << std::endl;
 
 	std::cout << "bid";
-	dumpCSVLOB(m_buyQueue.crbegin(), m_buyQueue.crend(), depth);
+	dumpCSVLOB(m_buyQueue.begin(), m_buyQueue.end(), depth);
 	std::cout << std::endl;
 
 }
 
-void Book::registerLimitOrder(const LimitOrderPtr& order) {
-	m_orderIdMap[order->id()] = order;
+void Book::registerLimitOrder(OrderHandle order) {
+	m_orderIndex.insert(m_orderPool[order].id, order);
+}
+
+void Book::unregisterLimitOrder(OrderHandle order) {
+	m_orderIndex.erase(m_orderPool[order].id);
+}
+
+PriceLevel& Book::levelOf(OrderHandle order) {
+	const BookOrder& record = m_orderPool[order];
+	return *(record.direction == OrderDirection::Buy ? m_buyQueue : m_sellQueue).find(record.price);
+}
+
+void Book::cancelLimitOrder(OrderHandle order) {
+	PriceLevel& level = levelOf(order);
+	PriceLadder& queue = m_orderPool[order].direction == OrderDirection::Buy ? m_buyQueue : m_sellQueue;
+	removeLimitOrder(level, order);
+	if (level.empty()) {
+		queue.erase(level.price());
+	}
 }
 
-void Book::unregisterLimitOrder(const LimitOrderPtr& order) {
-	m_orderIdMap.erase(order->id());
+void Book::removeLimitOrder(PriceLevel& level, OrderHandle order) {
+	level.unlink(order);
+	unregisterLimitOrder(order);
+
+	// the released record is soon reused, so the last bettering order rather refers to none
+	if (m_lastBetteringBuyOrder == order) {
+		m_lastBetteringBuyOrder = ORDERHANDLE_NONE;
+	}
+	if (m_lastBetteringSellOrder == order) {
+		m_lastBetteringSellOrder = ORDERHANDLE_NONE;
+	}
+	m_orderPool.release(order);
 }
 
-void Book::logTrade(OrderDirection direction, OrderID aggressorId, OrderID restingId, Volume volume, Money execPrice) {
-	TradePtr tradePtr = tradeFactory()->makeRecord(TIMESTAMP_INVALID, direction, aggressorId, restingId, volume, execPrice);
-	m_tradeLoggingCallback(tradePtr);
+
+void Book::saveState(SnapshotWriter& writer) const {
+	m_orderRecordPtr->saveState(writer);
+	m_tradeRecordPtr->saveState(writer);
+	writer.writeMoney(m_tickSize);
+
+	// every resting order is in exactly one level, and there are no empty levels
+	for (const PriceLadder* queue : { &m_buyQueue, &m_sellQueue }) {
+		writer.write((std::uint64_t)queue->size());
+		for (const PriceLevel& level : *queue) {
+			writer.write(level.price().ticks());
+			writer.write((std::uint64_t)level.size());
+			for (OrderHandle handle = level.front(); handle != ORDERHANDLE_NONE; handle = m_orderPool[handle].next) {
+				writer.writeLimitOrder(*m_orderPool.snapshot(handle));
+				writer.write(m_orderPool[handle].owner);
+			}
+		}
+	}
+	for (OrderHandle order : { m_lastBetteringBuyOrder, m_lastBetteringSellOrder }) {
+		writer.write(order != ORDERHANDLE_NONE ? m_orderPool[order].id : ORDERID_INVALID);
+	}
+	m_stopOrders.saveState(writer);
 }
 
-void Book::registerTradeLoggingCallback(TradeLoggingCallback tradeLogginCallbackToRegister) {
-	m_tradeLoggingCallback = tradeLogginCallbackToRegister;
+void Book::loadState(SnapshotReader& reader) {
+	m_orderRecordPtr->loadState(reader);
+	m_tradeRecordPtr->loadState(reader);
+	const Money tickSize = reader.readMoney();
+	if (tickSize != m_tickSize) {
+		throw SimulationException("Book::loadState(): the snapshot was taken with the tick size " + tickSize.toPostfixedString(3) + ", not " + m_tickSize.toPostfixedString(3));
+	}
+
+	m_buyQueue.clear();
+	m_sellQueue.clear();
+	m_orderIndex.clear();
+	m_orderPool.clear();
+
+	for (PriceLadder* queue : { &m_buyQueue, &m_sellQueue }) {
+		const std::uint64_t levelCount = reader.read<std::uint64_t>();
+		for (std::uint64_t levelIndex = 0; levelIndex < levelCount; ++levelIndex) {
+			PriceLevel* level = queue->emplace(Price(reader.read<long long>())).first;
+			const std::uint64_t orderCount = reader.read<std::uint64_t>();
+			for (std::uint64_t orderIndex = 0; orderIndex < orderCount; ++orderIndex) {
+				const LimitOrder order = reader.readLimitOrder();
+				const OrderHandle handle = m_orderPool.allocate(order, reader.read<AgentId>());
+				level->pushBack(handle);
+				registerLimitOrder(handle);
+			}
+		}
+	}
+	for (OrderHandle* order : { &m_lastBetteringBuyOrder, &m_lastBetteringSellOrder }) {
+		const OrderID id = reader.read<OrderID>();
+		const OrderHandle handle = m_orderIndex.find(id);
+		if (id == ORDERID_INVALID) {
+			*order = ORDERHANDLE_NONE;
+		} else if (handle != ORDERHANDLE_NONE) {
+			*order = handle;
+		} else {
+			throw SimulationException("Book::loadState(): the last bettering order " + std::to_string(id) + " is not in the book");
+		}
+	}
+	m_stopOrders.loadState(reader);
 }
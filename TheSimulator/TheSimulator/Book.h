@@ -1,51 +1,63 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <queue>
 #include <map>
 #include <functional>
 #include <algorithm>
 #include <numeric>
+#include <optional>
 
 #include "OrderFactory.h"
 #include "TradeFactory.h"
+#include "OrderIndex.h"
+#include "PriceLadder.h"
+#include "StopOrderIndex.h"
 
 #include "ICSVPrintable.h"
 #include "IHumanPrintable.h"
 
-class TickContainer : public std::list<LimitOrderPtr> {
-public:
-	TickContainer(Money price);
-
-	Money price() const { return m_price; }
-	Volume volume() const {
-		return std::accumulate(cbegin(), cend(), (Volume)0, [](Volume soFar, const LimitOrderPtr& lop) {
-			return soFar + lop->volume();
-		});
-	};
-private:
-	Money m_price;
-};
-
-template<class TickContainer>
-using OrderContainer = std::deque<TickContainer>;
-
-using TradeLoggingCallback = std::function<void(TradePtr)>;
+#include <vector>
 
+// The resting orders and their levels, with everything done to them but the matching. Placing the orders, and matching them,
+// is up to the specializations of BasicBook, which fix the matching algorithm and the trade sink at compile time, and to
+// BatchAuctionBook, which matches them in auctions.
 class Book : public IHumanPrintable, public ICSVPrintable {
 public:
-	Book(OrderFactoryPtr orderFactoryPtr, TradeFactoryPtr tradeFactoryPtr);
+	// the limit prices are kept on the grid of the tick size, rounded to the passive side when they are off it; the levels within
+	// the ladder window of either side, in ticks, sit in an array
+	Book(OrderFactoryPtr orderFactoryPtr, TradeFactoryPtr tradeFactoryPtr, Money tickSize, size_t ladderWindow = PriceLadder::DEFAULT_WINDOW_SIZE);
 	virtual ~Book() = default;
 
-	MarketOrderPtr placeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume);
-	LimitOrderPtr placeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price);
-	void cancelOrder(const OrderID orderId);
+	// the owner of the order ends up in its trades, AGENTID_INVALID when nobody is to be told
+	virtual MarketOrderPtr placeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume, AgentId owner) = 0;
+	virtual LimitOrderPtr placeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price, AgentId owner) = 0;
+	// the trades since the last call, in the order they happened; they are not stamped with the time yet
+	virtual void takeTrades(std::vector<Trade>& trades) = 0;
+	// clears the orders collected since the last uncross in a single auction, a no-op for the books matching as the orders come in
+	virtual void uncross(Timestamp) { }
+	// a stop order waits out of the book until a later trade reaches its stop price, then goes in as a market order, or as a limit
+	// order at the limit price, within the same timestamp; the orders a trade triggers go in the order of the trigger index, the
+	// ones their trades trigger in turn after them
+	OrderID placeStopOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money stopPrice, std::optional<Money> limitPrice, AgentId owner);
+	// the stop orders waiting for their trigger are cancelled and amended like the resting ones; the whole cancellation returns
+	// the volume it took out of the book, none for an order that is no longer in it
+	Volume cancelOrder(const OrderID orderId);
 	Volume cancelOrder(const OrderID orderId, Volume volumeToCancel);
+	// a lower volume keeps the place of the order in its level, a higher one sends it to the back as of the timestamp
+	Volume amendOrder(const OrderID orderId, Timestamp timestamp, Volume volume);
 
+	// the order is a copy of the one resting in the book, it does not follow the later changes
 	bool tryGetOrder(OrderID id, LimitOrderPtr& orderPtr) const;
+	// whether the order still rests in the book or waits for its stop price, without copying it
+	bool contains(OrderID id) const { return m_orderIndex.find(id) != ORDERHANDLE_NONE || m_stopOrders.contains(id); }
+	// the volume the order has left in the book or waiting for its stop price, none for an order that is no longer in it
+	Volume volumeOf(OrderID id) const;
 
-	const OrderContainer<TickContainer>& buyQueue() const { return m_buyQueue; }
-	const OrderContainer<TickContainer>& sellQueue() const { return m_sellQueue; }
+	// the levels, the best one first on either side
+	const PriceLadder& buyQueue() const { return m_buyQueue; }
+	const PriceLadder& sellQueue() const { return m_sellQueue; }
 
 	void printHuman() const override;
 	void printCSV() const override;
@@ -54,32 +66,69 @@ public:
 
 	using IHumanPrintable::print;
 
+	Money tickSize() const { return m_tickSize; }
 	const OrderFactoryPtr& orderFactory() const { return m_orderRecordPtr; }
 	const TradeFactoryPtr& tradeFactory() const { return m_tradeRecordPtr; }
 
-	void registerTradeLoggingCallback(TradeLoggingCallback tradeLogginCallbackToRegister);
+	// the orders, the levels, the stop orders and the factory counters; the matching algorithm and the trade sink stay as configured
+	virtual void saveState(SnapshotWriter& writer) const;
+	virtual void loadState(SnapshotReader& reader);
 protected:
-	void placeOrder(const MarketOrderPtr& order);
-	void placeOrder(const LimitOrderPtr& order);
-
-	void registerLimitOrder(const LimitOrderPtr& order);
-	void unregisterLimitOrder(const LimitOrderPtr& order);
-	std::map<OrderID, LimitOrderPtr> m_orderIdMap;
-
-	OrderContainer<TickContainer> m_buyQueue;
-	LimitOrderPtr m_lastBetteringBuyOrder;
-	OrderContainer<TickContainer> m_sellQueue;
-	LimitOrderPtr m_lastBetteringSellOrder;
+	// the price on the grid, off the grid a buy goes down to the tick below and a sell up to the tick above
+	Price gridPrice(OrderDirection direction, Money price) const;
+	// the order at the back of its level; in a book matching as the orders come in, it must not cross the book any more
+	void restLimitOrder(const LimitOrder& order, Price price, AgentId owner);
+
+	void registerLimitOrder(OrderHandle order);
+	void unregisterLimitOrder(OrderHandle order);
+	// unlinks the order from its level and releases its record, once nothing is left of it
+	void removeLimitOrder(PriceLevel& level, OrderHandle order);
+	// removes the order wherever it rests, together with its level should that be left empty
+	void cancelLimitOrder(OrderHandle order);
+	// the level the resting order is linked into, the volumes change through it
+	PriceLevel& levelOf(OrderHandle order);
+	OrderIndex m_orderIndex;
+
+	// the orders being placed, under the id of the stop order when it is one that triggered
+	MarketOrderPtr makeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume);
+	LimitOrderPtr makeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price);
+	// for every trade; the stop orders trigger on the range of the trade prices, so that a sweep through a stop price triggers
+	// its stops even if the sweep ends on the near side of it
+	void recordTrade(Price price) {
+		m_lowestTradePrice = m_traded ? std::min(m_lowestTradePrice, price) : price;
+		m_highestTradePrice = m_traded ? std::max(m_highestTradePrice, price) : price;
+		m_traded = true;
+	}
+	// once an order has been placed, the stop orders its trades triggered go into the book; the placements of those only record
+	// their trades, for the loop triggering them to carry on with
+	void triggerStopOrders(Timestamp timestamp) {
+		if (m_traded && !m_triggering) {
+			fireStopOrders(timestamp);
+		}
+	}
 
-	virtual void processAgainstTheBuyQueue(const OrderPtr& order, Money minPrice) = 0; // you want to keep it this way
-	virtual void processAgainstTheSellQueue(const OrderPtr& order, Money maxPrice) = 0;
+	// the resting orders live in the pool, the levels and the id map refer to them by their handles
+	OrderPool m_orderPool;
+	PriceLadder m_buyQueue;
+	OrderHandle m_lastBetteringBuyOrder;
+	PriceLadder m_sellQueue;
+	OrderHandle m_lastBetteringSellOrder;
 
-	void logTrade(OrderDirection direction, OrderID aggressorId, OrderID restingId, Volume volume, Money execPrice);
 private:
+	StopOrderIndex m_stopOrders;
+	std::vector<StopOrder> m_triggeredStops; // in the order they go into the book, kept so that it does not allocate
+	Price m_lowestTradePrice; // of the trades since the stop orders were last triggered
+	Price m_highestTradePrice;
+	bool m_traded; // since the stop orders were last triggered
+	bool m_triggering;
+	OrderID m_stopOrderId; // of the stop order being placed, ORDERID_INVALID for any other order
+
+	Money m_tickSize;
 	OrderFactoryPtr m_orderRecordPtr;
 	TradeFactoryPtr m_tradeRecordPtr;
-	TradeLoggingCallback m_tradeLoggingCallback;
-	
+
+	void fireStopOrders(Timestamp timestamp);
+
 	template <class CIteratorType>
 	void dumpHumanLOB(CIteratorType begin, CIteratorType end, unsigned int depth) const;
 	template <class CIteratorType>
@@ -94,11 +143,9 @@ using BookPtr = std::shared_ptr<Book>;
 template<class CIteratorType>
 inline void Book::dumpHumanLOB(CIteratorType begin, CIteratorType end, unsigned int depth) const {
 	while (depth > 0 && begin != end) {
-		const Volume totalVolume = std::accumulate(begin->begin(), begin->end(), (Volume)0, [](Volume acc, const LimitOrderPtr& iop) {
-			return acc + iop->volume();
-		});
+		const Volume totalVolume = begin->volume();
 
-		std::cout << "\t" << ((Money)begin->price()).toCentString() << " (" + Money(totalVolume, 0).toPostfixedString(4) + ")";
+		std::cout << "\t" << begin->price().toMoney(m_tickSize).toCentString() << " (" + Money(totalVolume, 0).toPostfixedString(4) + ")";
 
 		--depth;
 		++begin;
@@ -108,12 +155,9 @@ inline void Book::dumpHumanLOB(CIteratorType begin, CIteratorType end, unsigned
 template<class CIteratorType>
 void Book::dumpCSVLOB(CIteratorType begin, CIteratorType end, unsigned int depth) const {
 	while (depth > 0 && begin != end) {
-		const Volume totalVolume = std::accumulate(begin->begin(), begin->end(), (Volume)0, [](Volume acc, const LimitOrderPtr& iop) {
-			return acc 
-				+ iop->volume();
-		});
+		const Volume totalVolume = begin->volume();
 
-		std::cout << "," << begin->price().toPostfixedString(3) << "," << std::to_string(totalVolume);
+		std::cout << "," << begin->price().toMoney(m_tickSize).toPostfixedString(3) << "," << std::to_string(totalVolume);
 
 		--depth;
 		++begin;
@@ -0,0 +1,26 @@
+#include "BookFactory.h"
+#include "BatchAuctionBook.h"
+#include "PriceTimeBook.h"
+#include "PureProRataBook.h"
+#include "PriorityProRataBook.h"
+#include "TimeProRataBook.h"
+#include "SimulationException.h"
+
+BookPtr BookFactory::make(const std::string& algorithm, Money tickSize, size_t ladderWindow) {
+	// every continuous algorithm is a specialization of BasicBook of its own, instantiated up front
+	auto orderFactoryPtr = std::make_shared<OrderFactory>();
+	auto tradeFactoryPtr = std::make_shared<TradeFactory>();
+	if (algorithm == "PriceTime") {
+		return std::make_shared<PriceTimeBook>(orderFactoryPtr, tradeFactoryPtr, tickSize, ladderWindow);
+	} else if (algorithm == "PureProRata") {
+		return std::make_shared<PureProRataBook>(orderFactoryPtr, tradeFactoryPtr, tickSize, ladderWindow);
+	} else if (algorithm == "PriorityProRata") {
+		return std::make_shared<PriorityProRataBook>(orderFactoryPtr, tradeFactoryPtr, tickSize, ladderWindow);
+	} else if (algorithm == "TimeProRata") {
+		return std::make_shared<TimeProRataBook>(orderFactoryPtr, tradeFactoryPtr, tickSize, ladderWindow);
+	} else if (algorithm == "BatchAuction") {
+		return std::make_shared<BatchAuctionBook>(orderFactoryPtr, tradeFactoryPtr, tickSize, ladderWindow);
+	} else {
+		throw SimulationException("BookFactory::make(): unknown algorithm '" + algorithm + "'");
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Book.h"
+
+#include <string>
+
+// The books an exchange can be configured with, by the name of their matching algorithm
+class BookFactory {
+public:
+	// throws for an unknown algorithm
+	static BookPtr make(const std::string& algorithm, Money tickSize, size_t ladderWindow = PriceLadder::DEFAULT_WINDOW_SIZE);
+};
@@ -0,0 +1,203 @@
+#include "BookJournal.h"
+#include "SimulationException.h"
+
+#include <cstring>
+
+static const char JOURNAL_MAGIC[8] = { 'M', 'A', 'X', 'E', 'J', 'R', 'N', 'L' };
+static const std::uint32_t JOURNAL_VERSION = 2;
+
+JournalWriter::JournalWriter(const std::string& path, const std::string& algorithm, Money tickSize)
+	: m_path(path), m_stream(path, std::ios::binary | std::ios::trunc), m_block(), m_sequence(0) {
+	if (!m_stream) {
+		throw SimulationException("JournalWriter::JournalWriter(): could not open the file '" + path + "'");
+	}
+	m_block.reserve(BLOCK_SIZE);
+
+	// the record size tells the journals of builds with different volumes apart
+	const std::uint32_t version = JOURNAL_VERSION;
+	const std::uint32_t recordSize = sizeof(JournalRecord);
+	const std::uint64_t algorithmLength = algorithm.size();
+	m_stream.write(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+	m_stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	m_stream.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize));
+	m_stream.write(reinterpret_cast<const char*>(&algorithmLength), sizeof(algorithmLength));
+	m_stream.write(algorithm.data(), algorithm.size());
+	m_stream.write(reinterpret_cast<const char*>(&tickSize), sizeof(tickSize));
+}
+
+JournalWriter::~JournalWriter() {
+	// nothing to be done about a failure this late
+	m_stream.write(reinterpret_cast<const char*>(m_block.data()), m_block.size() * sizeof(JournalRecord));
+}
+
+void JournalWriter::limitOrder(Timestamp timestamp, OrderID id, OrderDirection direction, Volume volume, Money price) {
+	append(JournalEventType::LimitOrder, timestamp, id, ORDERID_INVALID, direction, volume, price);
+}
+
+void JournalWriter::marketOrder(Timestamp timestamp, OrderID id, OrderDirection direction, Volume volume) {
+	append(JournalEventType::MarketOrder, timestamp, id, ORDERID_INVALID, direction, volume, Money());
+}
+
+void JournalWriter::stopOrder(Timestamp timestamp, OrderID id, OrderDirection direction, Volume volume, Money stopPrice, std::optional<Money> limitPrice) {
+	append(limitPrice.has_value() ? JournalEventType::StopLimitOrder : JournalEventType::StopOrder, timestamp, id, ORDERID_INVALID, direction, volume, limitPrice.value_or(Money()), stopPrice);
+}
+
+void JournalWriter::cancel(Timestamp timestamp, OrderID id, Volume volume) {
+	append(JournalEventType::Cancel, timestamp, id, ORDERID_INVALID, OrderDirection::Buy, volume, Money());
+}
+
+void JournalWriter::amend(Timestamp timestamp, OrderID id, Volume volume) {
+	append(JournalEventType::Amend, timestamp, id, ORDERID_INVALID, OrderDirection::Buy, volume, Money());
+}
+
+void JournalWriter::uncross(Timestamp timestamp) {
+	append(JournalEventType::Uncross, timestamp, ORDERID_INVALID, ORDERID_INVALID, OrderDirection::Buy, 0, Money());
+}
+
+void JournalWriter::fill(const Trade& trade) {
+	append(JournalEventType::Fill, trade.timestamp(), trade.aggressingOrderID(), trade.restingOrderID(), trade.direction(), trade.volume(), trade.price());
+}
+
+void JournalWriter::flush() {
+	m_stream.write(reinterpret_cast<const char*>(m_block.data()), m_block.size() * sizeof(JournalRecord));
+	if (!m_stream) {
+		throw SimulationException("JournalWriter::flush(): could not write the file '" + m_path + "'");
+	}
+	m_block.clear();
+}
+
+void JournalWriter::append(JournalEventType type, Timestamp timestamp, OrderID id, OrderID restingId, OrderDirection direction, Volume volume, Money price, Money stopPrice) {
+	JournalRecord record;
+	std::memset(static_cast<void*>(&record), 0, sizeof(record)); // no stray bytes in the padding
+	record.sequence = m_sequence++;
+	record.timestamp = timestamp;
+	record.id = id;
+	record.restingId = restingId;
+	record.price = price;
+	record.stopPrice = stopPrice;
+	record.volume = volume;
+	record.type = type;
+	record.direction = direction;
+	m_block.push_back(record);
+
+	if (m_block.size() == BLOCK_SIZE) {
+		flush();
+	}
+}
+
+JournalReader::JournalReader(const std::string& path)
+	: m_path(path), m_stream(path, std::ios::binary), m_algorithm(), m_tickSize(), m_block(JournalWriter::BLOCK_SIZE), m_position(0), m_count(0) {
+	if (!m_stream) {
+		throw SimulationException("JournalReader::JournalReader(): could not open the file '" + path + "'");
+	}
+
+	char magic[sizeof(JOURNAL_MAGIC)];
+	std::uint32_t version = 0;
+	std::uint32_t recordSize = 0;
+	std::uint64_t algorithmLength = 0;
+	m_stream.read(magic, sizeof(magic));
+	m_stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+	m_stream.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));
+	m_stream.read(reinterpret_cast<char*>(&algorithmLength), sizeof(algorithmLength));
+	if (!m_stream || std::memcmp(magic, JOURNAL_MAGIC, sizeof(magic)) != 0) {
+		throw SimulationException("JournalReader::JournalReader(): the file '" + path + "' is not a book journal");
+	}
+	if (version != JOURNAL_VERSION) {
+		throw SimulationException("JournalReader::JournalReader(): unsupported journal version " + std::to_string(version));
+	}
+	if (recordSize != sizeof(JournalRecord)) {
+		throw SimulationException("JournalReader::JournalReader(): the journal was written by a build with records of " + std::to_string(recordSize) + " bytes, not " + std::to_string(sizeof(JournalRecord)));
+	}
+
+	m_algorithm.resize(algorithmLength);
+	m_stream.read(m_algorithm.data(), algorithmLength);
+	m_stream.read(reinterpret_cast<char*>(&m_tickSize), sizeof(m_tickSize));
+	if (!m_stream) {
+		throw SimulationException("JournalReader::JournalReader(): the header of '" + path + "' ends prematurely");
+	}
+}
+
+const JournalRecord* JournalReader::next() {
+	if (m_position == m_count) {
+		m_stream.read(reinterpret_cast<char*>(m_block.data()), m_block.size() * sizeof(JournalRecord));
+		const size_t bytes = (size_t)m_stream.gcount();
+		if (bytes % sizeof(JournalRecord) != 0) {
+			throw SimulationException("JournalReader::next(): '" + m_path + "' ends in the middle of a record");
+		}
+		m_position = 0;
+		m_count = bytes / sizeof(JournalRecord);
+		if (m_count == 0) {
+			return nullptr;
+		}
+	}
+
+	return &m_block[m_position++];
+}
+
+JournalReplay::JournalReplay(const std::string& path)
+	: m_reader(path), m_trades(), m_tradesMatched(0), m_records(0), m_fills(0), m_mismatchedFills(0) { }
+
+void JournalReplay::replay(Book& book) {
+	for (const JournalRecord* record = m_reader.next(); record != nullptr; record = m_reader.next()) {
+		++m_records;
+
+		OrderID id = record->id;
+		switch (record->type) {
+		case JournalEventType::LimitOrder:
+			id = book.placeLimitOrder(record->direction, record->timestamp, record->volume, record->price, AGENTID_INVALID)->id();
+			takeTrades(book);
+			break;
+		case JournalEventType::MarketOrder:
+			id = book.placeMarketOrder(record->direction, record->timestamp, record->volume, AGENTID_INVALID)->id();
+			takeTrades(book);
+			break;
+		case JournalEventType::StopOrder:
+			id = book.placeStopOrder(record->direction, record->timestamp, record->volume, record->stopPrice, std::nullopt, AGENTID_INVALID);
+			break;
+		case JournalEventType::StopLimitOrder:
+			id = book.placeStopOrder(record->direction, record->timestamp, record->volume, record->stopPrice, record->price, AGENTID_INVALID);
+			break;
+		case JournalEventType::Cancel:
+			book.cancelOrder(record->id, record->volume);
+			break;
+		case JournalEventType::Amend:
+			book.amendOrder(record->id, record->timestamp, record->volume);
+			break;
+		case JournalEventType::Uncross:
+			book.uncross(record->timestamp);
+			takeTrades(book);
+			break;
+		case JournalEventType::Fill: {
+			++m_fills;
+			const bool matched = m_tradesMatched < m_trades.size()
+				&& m_trades[m_tradesMatched].aggressingOrderID() == record->id
+				&& m_trades[m_tradesMatched].restingOrderID() == record->restingId
+				&& m_trades[m_tradesMatched].volume() == record->volume
+				&& m_trades[m_tradesMatched].price() == record->price
+				&& m_trades[m_tradesMatched].direction() == record->direction;
+			if (!matched) {
+				++m_mismatchedFills;
+			}
+			++m_tradesMatched;
+			break;
+		}
+		default:
+			throw SimulationException("JournalReplay::replay(): unknown record type " + std::to_string((int)record->type) + " at sequence " + std::to_string(record->sequence));
+		}
+
+		if (id != record->id) {
+			throw SimulationException("JournalReplay::replay(): the book gave the order at sequence " + std::to_string(record->sequence) + " the id " + std::to_string(id)
+				+ ", the journal says " + std::to_string(record->id) + "; the journal has to start with the book");
+		}
+	}
+	takeTrades(book);
+}
+
+void JournalReplay::takeTrades(Book& book) {
+	// the trades of the order before that no fill was journaled for
+	if (m_tradesMatched < m_trades.size()) {
+		m_mismatchedFills += m_trades.size() - m_tradesMatched;
+	}
+	book.takeTrades(m_trades);
+	m_tradesMatched = 0;
+}
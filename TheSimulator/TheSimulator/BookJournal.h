@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Book.h"
+#include "Money.h"
+#include "Order.h"
+#include "Timestamp.h"
+#include "Trade.h"
+#include "Volume.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// An append-only journal of everything an exchange does to its book: the orders placed, the stop orders, the cancellations, the amendments and
+// the uncrosses of an auction book, each one followed by the fills it caused, those of the stop orders it triggered included. The records are all of the same size and are written the way they lie in memory,
+// in blocks, so that a journal reads back at the speed of the disk; like the snapshots, a journal is meant to be read by a build
+// for the same platform and with the same MAXE_COMPACT_RECORDS setting.
+
+enum class JournalEventType : std::uint8_t {
+	LimitOrder,
+	MarketOrder,
+	Cancel,
+	Amend,
+	Fill,
+	Uncross,
+	StopOrder,
+	StopLimitOrder
+};
+
+struct JournalRecord {
+	std::uint64_t sequence; // from 0, one after the other
+	Timestamp timestamp;
+	OrderID id; // the aggressing order of a fill
+	OrderID restingId; // of a fill only
+	Money price; // the limit price as the order came in, or the price of a fill
+	Money stopPrice; // of a stop order only
+	Volume volume; // of a cancellation, as much as was cancelled
+	JournalEventType type;
+	OrderDirection direction; // of the order, the aggressing one for a fill
+};
+static_assert(std::is_trivially_copyable_v<JournalRecord>, "the journal records are written as they lie in memory");
+
+class JournalWriter {
+public:
+	// the matching algorithm and the tick size of the book go into the header, the replay builds the same book by default
+	JournalWriter(const std::string& path, const std::string& algorithm, Money tickSize);
+	JournalWriter(const JournalWriter&) = delete;
+	JournalWriter& operator=(const JournalWriter&) = delete;
+	~JournalWriter();
+
+	void limitOrder(Timestamp timestamp, OrderID id, OrderDirection direction, Volume volume, Money price);
+	void marketOrder(Timestamp timestamp, OrderID id, OrderDirection direction, Volume volume);
+	// a stop-limit order with the limit price, a stop-market one without
+	void stopOrder(Timestamp timestamp, OrderID id, OrderDirection direction, Volume volume, Money stopPrice, std::optional<Money> limitPrice);
+	void cancel(Timestamp timestamp, OrderID id, Volume volume);
+	void amend(Timestamp timestamp, OrderID id, Volume volume);
+	void uncross(Timestamp timestamp);
+	// the trade stamped with its time already
+	void fill(const Trade& trade);
+
+	// the records so far to the file, the writer does so on its own every BLOCK_SIZE records and when destroyed
+	void flush();
+
+	static constexpr size_t BLOCK_SIZE = 4096; // records
+private:
+	std::string m_path;
+	std::ofstream m_stream;
+	std::vector<JournalRecord> m_block;
+	std::uint64_t m_sequence;
+
+	void append(JournalEventType type, Timestamp timestamp, OrderID id, OrderID restingId, OrderDirection direction, Volume volume, Money price, Money stopPrice = Money());
+};
+
+class JournalReader {
+public:
+	JournalReader(const std::string& path);
+
+	const std::string& algorithm() const { return m_algorithm; }
+	Money tickSize() const { return m_tickSize; }
+
+	// the next record, nullptr at the end of the journal; valid until the next call
+	const JournalRecord* next();
+private:
+	std::string m_path;
+	std::ifstream m_stream;
+	std::string m_algorithm;
+	Money m_tickSize;
+	std::vector<JournalRecord> m_block;
+	size_t m_position;
+	size_t m_count; // of the records in the block
+};
+
+// Rebuilds a book from a journal without the agents. The orders, cancellations and amendments are applied to the book in the
+// order of the journal, and the trades the book makes are checked against the fills journaled, which they match as long as the
+// book matches with the algorithm of the journal. The journal has to start with the book, the ids it refers to are the ones the
+// book hands out.
+class JournalReplay {
+public:
+	JournalReplay(const std::string& path);
+
+	const std::string& algorithm() const { return m_reader.algorithm(); }
+	Money tickSize() const { return m_reader.tickSize(); }
+
+	// the rest of the journal to the book
+	void replay(Book& book);
+
+	std::uint64_t records() const { return m_records; }
+	std::uint64_t fills() const { return m_fills; } // journaled
+	std::uint64_t mismatchedFills() const { return m_mismatchedFills; } // journaled but not made by the book, or the other way round
+private:
+	JournalReader m_reader;
+	std::vector<Trade> m_trades; // of the last order, in the order the book made them
+	size_t m_tradesMatched; // against the fills journaled so far
+	std::uint64_t m_records;
+	std::uint64_t m_fills;
+	std::uint64_t m_mismatchedFills;
+
+	// the trades of the order just placed, in place of the ones of the order before
+	void takeTrades(Book& book);
+};
@@ -3,15 +3,16 @@
 #include "Simulation.h"
 #include "ExchangeAgentMessagePayloads.h"
 #include "ParameterStorage.h"
+#include "Snapshot.h"
 
 #include <random>
 #include <cmath>
 
 BouchaudAgent::BouchaudAgent(const Simulation* simulation)
-	: Agent(simulation), m_exchange(""), m_volumeUnit(1), m_orderMeanArrivalTime(1000), m_orderMeanLifeTime(1000), m_marketOrderFraction(0.0), m_delta0(1.0), m_delta1(1.0), m_mu(0.6) { }
+	: Agent(simulation), m_exchange(""), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_volumeUnit(1), m_orderMeanArrivalTime(1000), m_orderMeanLifeTime(1000), m_marketOrderFraction(0.0), m_delta0(1.0), m_delta1(1.0), m_mu(0.6) { }
 
 BouchaudAgent::BouchaudAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name), m_exchange(""), m_volumeUnit(1), m_orderMeanArrivalTime(1000), m_orderMeanLifeTime(1000), m_marketOrderFraction(0.0), m_delta0(1.0), m_delta1(1.0), m_mu(0.6) { }
+	: Agent(simulation, name), m_exchange(""), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_volumeUnit(1), m_orderMeanArrivalTime(1000), m_orderMeanLifeTime(1000), m_marketOrderFraction(0.0), m_delta0(1.0), m_delta1(1.0), m_mu(0.6) { }
 
 void BouchaudAgent::configure(const pugi::xml_node& node, const std::string& configurationPath) {
 	Agent::configure(node, configurationPath);
@@ -21,6 +22,10 @@ void BouchaudAgent::configure(const pugi::xml_node& node, const std::string& con
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
 
+	if (!(att = node.attribute("symbol")).empty()) {
+		m_symbol = (SymbolId)std::stoul(simulation()->parameters().processString(att.as_string()));
+	}
+
 	if (!(att = node.attribute("volumeUnit")).empty()) {
 		m_volumeUnit = std::stoull(simulation()->parameters().processString(att.as_string()));
 	}
@@ -50,80 +55,104 @@ void BouchaudAgent::configure(const pugi::xml_node& node, const std::string& con
 	}
 }
 
+void BouchaudAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
+}
+
+const MessageDispatchTable<BouchaudAgent> BouchaudAgent::s_dispatchTable = MessageDispatchTable<BouchaudAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &BouchaudAgent::handleSimulationStart)
+	.on(MESSAGETYPE_WAKEUP_FOR_PLACEMENT, &BouchaudAgent::handleWakeupForPlacement)
+	.on(MESSAGETYPE_RESPONSE_RETRIEVE_L1, &BouchaudAgent::handleRetrieveL1Response)
+	.on(MESSAGETYPE_RESPONSE_PLACE_ORDER_LIMIT, &BouchaudAgent::handlePlaceOrderLimitResponse)
+	.on(MESSAGETYPE_EVENT_EXECUTION, &BouchaudAgent::handleExecutionEvent)
+	.on(MESSAGETYPE_WAKEUP_FOR_CANCELLATION, &BouchaudAgent::handleWakeupForCancellation);
+
 void BouchaudAgent::receiveMessage(const MessagePtr& msg) {
+	s_dispatchTable.dispatch(this, msg);
+}
+
+void BouchaudAgent::handleSimulationStart(const MessagePtr& msg) {
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), 0, id(), m_exchangeId, MESSAGETYPE_SUBSCRIBE_EVENT_EXECUTION, SubscribeEventPayload(m_symbol));
+	scheduleNextOrderPlacement();
+	scheduleNextOrderCancellation();
+}
+
+void BouchaudAgent::handleWakeupForPlacement(const MessagePtr& msg) {
+	// queue an L1 data request
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), 0, id(), m_exchangeId, MESSAGETYPE_RETRIEVE_L1, RetrieveL1Payload(m_symbol));
+}
+
+void BouchaudAgent::handleRetrieveL1Response(const MessagePtr& msg) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-	if (msg->type == "EVENT_SIMULATION_START") {
+	const auto& l1 = std::get<RetrieveL1ResponsePayload>(msg->payload);
+	// place an order based on the current L1 status
+	std::bernoulli_distribution orderTypeDistribution(m_marketOrderFraction);
+	std::bernoulli_distribution orderDirectionDistribution(0.5);
+	bool isMarketOrder = orderTypeDistribution(simulation()->randomGenerator());
+	OrderDirection direction = orderDirectionDistribution(simulation()->randomGenerator()) ? OrderDirection::Buy : OrderDirection::Sell;
+	if (isMarketOrder) {
+		simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_MARKET, PlaceOrderMarketPayload(direction, m_volumeUnit, m_symbol));
+
 		scheduleNextOrderPlacement();
-		scheduleNextOrderCancellation();
-	} else if (msg->type == "WAKEUP_FOR_PLACEMENT") {
-		// queue an L1 data request
-		simulation()->dispatchMessage(simulation()->currentTimestamp(), 0, name(), m_exchange, "RETRIEVE_L1", std::make_shared<EmptyPayload>());
-	} else if (msg->type == "RESPONSE_RETRIEVE_L1") {
-		auto l1ptr = std::dynamic_pointer_cast<RetrieveL1ResponsePayload>(msg->payload);
-		// place an order based on the current L1 status
-		std::bernoulli_distribution orderTypeDistribution(m_marketOrderFraction);
-		std::bernoulli_distribution orderDirectionDistribution(0.5);
-		bool isMarketOrder = orderTypeDistribution(simulation()->randomGenerator());
-		OrderDirection direction = orderDirectionDistribution(simulation()->randomGenerator()) ? OrderDirection::Buy : OrderDirection::Sell;
-		if (isMarketOrder) {
-			auto pptr = std::make_shared<PlaceOrderMarketPayload>(direction, m_volumeUnit);
-			simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "PLACE_ORDER_MARKET", pptr);
-
-			scheduleNextOrderPlacement();
+	} else {
+		std::uniform_real_distribution<> priceUniformDistribution(std::numeric_limits<double>::min(), 1.0);
+		double randomUniformForPrice = priceUniformDistribution(simulation()->randomGenerator());
+		Money priceDeltaFromBest = Money(std::pow(std::pow(m_delta0, m_mu) / randomUniformForPrice, 1+m_mu) - m_delta1);
+		Money price;
+		if (direction == OrderDirection::Buy) {
+			price = l1.bestAskPrice - priceDeltaFromBest.floorToCents();
 		} else {
-			std::uniform_real_distribution<> priceUniformDistribution(std::numeric_limits<double>::min(), 1.0);
-			double randomUniformForPrice = priceUniformDistribution(simulation()->randomGenerator());
-			Money priceDeltaFromBest = Money(std::pow(std::pow(m_delta0, m_mu) / randomUniformForPrice, 1+m_mu) - m_delta1);
-			Money price;
-			if (direction == OrderDirection::Buy) {
-				price = l1ptr->bestAskPrice - priceDeltaFromBest.floorToCents();
-			} else {
-				price = l1ptr->bestBidPrice + priceDeltaFromBest.floorToCents();
-			}
-
-			auto pptr = std::make_shared<PlaceOrderLimitPayload>(direction, m_volumeUnit, price);
-			simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "PLACE_ORDER_LIMIT", pptr);
+			price = l1.bestBidPrice + priceDeltaFromBest.floorToCents();
 		}
-	} else if (msg->type == "RESPONSE_PLACE_ORDER_LIMIT") {
-		auto responsepptr = std::dynamic_pointer_cast<PlaceOrderLimitResponsePayload>(msg->payload);
-		auto orderIterator = std::upper_bound(m_ownedOrders.begin(), m_ownedOrders.end(), responsepptr->id, [](OrderID orderSought, const BouchaudAgentOrder& agentOrder) {
-			return orderSought < agentOrder.id;
-		});
-		m_ownedOrders.insert(orderIterator, BouchaudAgentOrder(responsepptr->id, responsepptr->requestPayload->volume));
 
-		auto pptr = std::make_shared<SubscribeEventTradeByOrderPayload>(responsepptr->id);
-		simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "SUBSCRIBE_EVENT_ORDER_TRADE", pptr);
+		simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_LIMIT, PlaceOrderLimitPayload(direction, m_volumeUnit, price, m_symbol));
+	}
+}
 
-		scheduleNextOrderPlacement();
-	} else if (msg->type == "EVENT_TRADE") {
-		auto eventpptr = std::dynamic_pointer_cast<EventTradePayload>(msg->payload);
-		auto orderIterator = std::lower_bound(m_ownedOrders.begin(), m_ownedOrders.end(), eventpptr->trade.restingOrderID(), [](const BouchaudAgentOrder& agentOrder, OrderID orderSought) {
-			return agentOrder.id < orderSought;
-		});
-		if(orderIterator != m_ownedOrders.end()) {
-			orderIterator->volume -= eventpptr->trade.volume();
-			if (orderIterator->volume == 0) {
-				m_ownedOrders.erase(orderIterator);
-			}
-		}
-	} else if (msg->type == "WAKEUP_FOR_CANCELLATION") {
-		if (!m_ownedOrders.empty()) { 
-			// randomly cancel an order with the exchange, and remove it from ownedOrders
-			std::uniform_int_distribution<size_t> discreteUniformDistribution(0, m_ownedOrders.size()-1);
-			auto indexToKill = discreteUniformDistribution(simulation()->randomGenerator());
-			auto it = m_ownedOrders.begin();
-			std::advance(it, indexToKill);
-
-			auto pptr = std::make_shared<CancelOrdersPayload>();
-			pptr->cancellations.push_back(CancelOrdersCancellation(it->id, it->volume));
-			simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "CANCEL_ORDER", pptr);
-
-			m_ownedOrders.erase(it); // safe to erase here because everything else first checks whether an order with a given id exists
+void BouchaudAgent::handlePlaceOrderLimitResponse(const MessagePtr& msg) {
+	const auto& response = std::get<PlaceOrderLimitResponsePayload>(msg->payload);
+	auto orderIterator = std::upper_bound(m_ownedOrders.begin(), m_ownedOrders.end(), response.id, [](OrderID orderSought, const BouchaudAgentOrder& agentOrder) {
+		return orderSought < agentOrder.id;
+	});
+	m_ownedOrders.insert(orderIterator, BouchaudAgentOrder(response.id, response.requestPayload.volume));
+
+	scheduleNextOrderPlacement();
+}
+
+void BouchaudAgent::handleExecutionEvent(const MessagePtr& msg) {
+	const auto& event = std::get<EventExecutionPayload>(msg->payload);
+	auto orderIterator = std::lower_bound(m_ownedOrders.begin(), m_ownedOrders.end(), event.id, [](const BouchaudAgentOrder& agentOrder, OrderID orderSought) {
+		return agentOrder.id < orderSought;
+	});
+	// the fills of an order crossing on arrival come before its response, it is not among the owned ones yet
+	if(orderIterator != m_ownedOrders.end() && orderIterator->id == event.id) {
+		orderIterator->volume -= event.trade.volume();
+		if (orderIterator->volume == 0) {
+			m_ownedOrders.erase(orderIterator);
 		}
+	}
+}
+
+void BouchaudAgent::handleWakeupForCancellation(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	if (!m_ownedOrders.empty()) { 
+		// randomly cancel an order with the exchange, and remove it from ownedOrders
+		std::uniform_int_distribution<size_t> discreteUniformDistribution(0, m_ownedOrders.size()-1);
+		auto indexToKill = discreteUniformDistribution(simulation()->randomGenerator());
+		auto it = m_ownedOrders.begin();
+		std::advance(it, indexToKill);
 
-		scheduleNextOrderCancellation();
+		CancelOrdersPayload cancelPayload;
+		cancelPayload.symbol = m_symbol;
+		cancelPayload.cancellations.push_back(CancelOrdersCancellation(it->id, it->volume));
+		simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_CANCEL_ORDERS, std::move(cancelPayload));
+
+		m_ownedOrders.erase(it); // safe to erase here because everything else first checks whether an order with a given id exists
 	}
+
+	scheduleNextOrderCancellation();
 }
 
 void BouchaudAgent::scheduleNextOrderPlacement() {
@@ -134,7 +163,7 @@ void BouchaudAgent::scheduleNextOrderPlacement() {
 	Timestamp delay = (Timestamp)std::floor(exponentialDistribution(simulation()->randomGenerator()));
 
 	// queue a placement
-	simulation()->dispatchMessage(simulation()->currentTimestamp(), delay, name(), name(), "WAKEUP_FOR_PLACEMENT", std::make_shared<EmptyPayload>());
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), delay, id(), id(), MESSAGETYPE_WAKEUP_FOR_PLACEMENT);
 }
 
 void BouchaudAgent::scheduleNextOrderCancellation() {
@@ -147,5 +176,23 @@ void BouchaudAgent::scheduleNextOrderCancellation() {
 	Timestamp delay = (Timestamp)std::floor(exponentialDistribution(simulation()->randomGenerator()));
 
 	// queue a cancellation
-	simulation()->dispatchMessage(simulation()->currentTimestamp(), delay, name(), name(), "WAKEUP_FOR_CANCELLATION", std::make_shared<EmptyPayload>());
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), delay, id(), id(), MESSAGETYPE_WAKEUP_FOR_CANCELLATION);
+}
+
+void BouchaudAgent::saveState(SnapshotWriter& writer) {
+	writer.write((std::uint64_t)m_ownedOrders.size());
+	for (const BouchaudAgentOrder& order : m_ownedOrders) {
+		writer.write(order.id);
+		writer.write(order.volume);
+	}
+}
+
+void BouchaudAgent::loadState(SnapshotReader& reader) {
+	m_ownedOrders.clear();
+	const std::uint64_t count = reader.read<std::uint64_t>();
+	for (std::uint64_t index = 0; index < count; ++index) {
+		const OrderID id = reader.read<OrderID>();
+		const Volume volume = reader.read<Volume>();
+		m_ownedOrders.emplace_back(id, volume);
+	}
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Agent.h"
+#include "MessageDispatchTable.h"
+#include "SymbolId.h"
 #include "Order.h"
 
 struct BouchaudAgentOrder {
@@ -17,10 +19,25 @@ public:
 
 	void configure(const pugi::xml_node& node, const std::string& configurationPath);
 
+	void saveState(SnapshotWriter& writer) override;
+	void loadState(SnapshotReader& reader) override;
+
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<BouchaudAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& msg);
+	void handleWakeupForPlacement(const MessagePtr& msg);
+	void handleRetrieveL1Response(const MessagePtr& msg);
+	void handlePlaceOrderLimitResponse(const MessagePtr& msg);
+	void handleExecutionEvent(const MessagePtr& msg);
+	void handleWakeupForCancellation(const MessagePtr& msg);
+
 	std::string m_exchange;
+	AgentId m_exchangeId;
+	SymbolId m_symbol; // of the book on the exchange
 	Volume m_volumeUnit;
 	Timestamp m_orderMeanArrivalTime;
 	Timestamp m_orderMeanLifeTime;
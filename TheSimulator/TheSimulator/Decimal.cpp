@@ -20,13 +20,6 @@ Decimal::Decimal(double val) {
 	m_internalValue = decltype(m_internalValue)(std::floor(val * WHOLE_OFFSET));
 }
 
-Decimal::Decimal(const Decimal& cpy)
-	: Decimal() {
-	setInternalValue(cpy.internalValue());
-}
-
-Decimal::~Decimal() {}
-
 long long int Decimal::whole() const {
 	return this->internalValue() / WHOLE_OFFSET;
 }
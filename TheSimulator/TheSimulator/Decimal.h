@@ -11,10 +11,10 @@ public:
 	explicit Decimal(signed long long int whole);
 	explicit Decimal(float val);
 	explicit Decimal(double val);
-	Decimal(const Decimal& cpy);
-	~Decimal();
+	Decimal(const Decimal& cpy) = default;
+	~Decimal() = default;
 
-	inline Decimal& operator=(const Decimal& rhs) { this->m_internalValue = rhs.internalValue(); return *this; }
+	Decimal& operator=(const Decimal& rhs) = default;
 	inline Decimal& operator=(const int rhs) { this->m_internalValue = rhs; return *this; }
 	inline Decimal& operator=(const float rhs) { this->m_internalValue = decltype(m_internalValue)((double)rhs * WHOLE_OFFSET); return *this; }
 	inline Decimal& operator=(const double rhs) { this->m_internalValue = decltype(m_internalValue)(rhs * WHOLE_OFFSET); return *this; }
@@ -103,6 +103,10 @@ protected:
 
 	static Decimal fromInternalValue(signed long long int internalValue);
 	static Decimal fromInternalValue(double internalValue); // convenience method to supress the warnings
+
+	friend class SnapshotWriter;
+	friend class SnapshotReader;
+	friend class Price;
 private:
 	signed long long int m_internalValue;
 };
@@ -2,12 +2,13 @@
 
 #include "Simulation.h"
 #include "ExchangeAgentMessagePayloads.h"
+#include "Snapshot.h"
 
 DoobAgent::DoobAgent(const Simulation* simulation)
-	: Agent(simulation), m_tradeUnit(0), m_state(DoobAgentInventoryState::Empty), m_upcrossingsCount(0) { }
+	: Agent(simulation), m_symbol(0), m_tradeUnit(0), m_state(DoobAgentInventoryState::Empty), m_exchangeId(AGENTID_INVALID), m_upcrossingsCount(0) { }
 
 DoobAgent::DoobAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name), m_tradeUnit(0), m_state(DoobAgentInventoryState::Empty), m_upcrossingsCount(0) { }
+	: Agent(simulation, name), m_symbol(0), m_tradeUnit(0), m_state(DoobAgentInventoryState::Empty), m_exchangeId(AGENTID_INVALID), m_upcrossingsCount(0) { }
 
 void DoobAgent::configure(const pugi::xml_node& node, const std::string& configurationPath) {
 	Agent::configure(node, configurationPath);
@@ -17,6 +18,10 @@ void DoobAgent::configure(const pugi::xml_node& node, const std::string& configu
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
 
+	if (!(att = node.attribute("symbol")).empty()) {
+		m_symbol = (SymbolId)std::stoul(simulation()->parameters().processString(att.as_string()));
+	}
+
 	if (!(att = node.attribute("a")).empty()) {
 		m_a = Money(std::stod(simulation()->parameters().processString(att.as_string())));
 	}
@@ -30,33 +35,66 @@ void DoobAgent::configure(const pugi::xml_node& node, const std::string& configu
 	}
 }
 
+void DoobAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
+}
+
 #include <iostream>
 
+const MessageDispatchTable<DoobAgent> DoobAgent::s_dispatchTable = MessageDispatchTable<DoobAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &DoobAgent::handleSimulationStart)
+	.on(MESSAGETYPE_RESPONSE_SUBSCRIBE_EVENT_ORDER_LIMIT, &DoobAgent::handleSubscribeEventOrderLimitResponse)
+	.on(MESSAGETYPE_EVENT_ORDER_LIMIT, &DoobAgent::handleOrderLimitEvent)
+	.on(MESSAGETYPE_RESPONSE_RETRIEVE_L1, &DoobAgent::handleRetrieveL1Response)
+	.on(MESSAGETYPE_EVENT_SIMULATION_STOP, &DoobAgent::handleSimulationStop);
+
 void DoobAgent::receiveMessage(const MessagePtr& msg) {
+	s_dispatchTable.dispatch(this, msg);
+}
+
+void DoobAgent::handleSimulationStart(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_LIMIT, SubscribeEventPayload(m_symbol));
+}
+
+void DoobAgent::handleSubscribeEventOrderLimitResponse(const MessagePtr& msg) {
+	// no op
+}
+
+void DoobAgent::handleOrderLimitEvent(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	// queue an L1 data request
+	simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_RETRIEVE_L1, RetrieveL1Payload(m_symbol));
+}
+
+void DoobAgent::handleRetrieveL1Response(const MessagePtr& msg) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-	if (msg->type == "EVENT_SIMULATION_START") {
-		simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "SUBSCRIBE_EVENT_ORDER_LIMIT", std::make_shared<EmptyPayload>());
-	} else if (msg->type == "RESPONSE_SUBSCRIBE_EVENT_ORDER_LIMIT") {
-		// no op
-	} else if (msg->type == "EVENT_ORDER_LIMIT") {
-		auto payload = std::dynamic_pointer_cast<EventOrderLimitPayload>(msg->payload);
-		// queue an L1 data request
-		simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "RETRIEVE_L1", std::make_shared<EmptyPayload>());
-	} else if (msg->type == "RESPONSE_RETRIEVE_L1") {
-		auto l1payload = std::dynamic_pointer_cast<RetrieveL1ResponsePayload>(msg->payload);
-		if (m_state == DoobAgentInventoryState::Empty && l1payload->bestAskPrice <= m_a) {
-			auto mopayload = std::make_shared<PlaceOrderLimitPayload>(OrderDirection::Buy, m_tradeUnit, 10000);
-			simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "PLACE_ORDER_LIMIT", mopayload);
-			m_state = DoobAgentInventoryState::NonEmpty;
-		} else if(m_state == DoobAgentInventoryState::NonEmpty && l1payload->bestBidPrice >= m_b) {
-			auto mopayload = std::make_shared<PlaceOrderLimitPayload>(OrderDirection::Sell, m_tradeUnit, 0);
-			simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "PLACE_ORDER_LIMIT", mopayload);
-			m_state = DoobAgentInventoryState::Empty;
-
-			++m_upcrossingsCount;
-		}
-	} else if(msg->type == "EVENT_SIMULATION_STOP") {
-		std::cout << this->name() << ": Upcrossings registered: " << m_upcrossingsCount << std::endl;
+	const auto& l1 = std::get<RetrieveL1ResponsePayload>(msg->payload);
+	// an empty side of the book has no price to cross
+	if (m_state == DoobAgentInventoryState::Empty && l1.bestAskVolume > 0 && l1.bestAskPrice <= m_a) {
+		simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_LIMIT, PlaceOrderLimitPayload(OrderDirection::Buy, m_tradeUnit, 10000, m_symbol));
+		m_state = DoobAgentInventoryState::NonEmpty;
+	} else if(m_state == DoobAgentInventoryState::NonEmpty && l1.bestBidVolume > 0 && l1.bestBidPrice >= m_b) {
+		simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_LIMIT, PlaceOrderLimitPayload(OrderDirection::Sell, m_tradeUnit, 0, m_symbol));
+		m_state = DoobAgentInventoryState::Empty;
+
+		++m_upcrossingsCount;
 	}
 }
+
+void DoobAgent::handleSimulationStop(const MessagePtr& msg) {
+	std::cout << this->name() << ": Upcrossings registered: " << m_upcrossingsCount << std::endl;
+}
+
+void DoobAgent::saveState(SnapshotWriter& writer) {
+	writer.write(m_state);
+	writer.write(m_upcrossingsCount);
+}
+
+void DoobAgent::loadState(SnapshotReader& reader) {
+	m_state = reader.read<DoobAgentInventoryState>();
+	m_upcrossingsCount = reader.read<unsigned int>();
+}
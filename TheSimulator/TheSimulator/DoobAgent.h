@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Agent.h"
+#include "MessageDispatchTable.h"
+#include "SymbolId.h"
 #include "Order.h"
 
 enum class DoobAgentInventoryState {
@@ -15,11 +17,25 @@ public:
 
 	void configure(const pugi::xml_node& node, const std::string& configurationPath);
 
+	void saveState(SnapshotWriter& writer) override;
+	void loadState(SnapshotReader& reader) override;
+
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<DoobAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& msg);
+	void handleSubscribeEventOrderLimitResponse(const MessagePtr& msg);
+	void handleOrderLimitEvent(const MessagePtr& msg);
+	void handleRetrieveL1Response(const MessagePtr& msg);
+	void handleSimulationStop(const MessagePtr& msg);
+
 	DoobAgentInventoryState m_state;
 	std::string m_exchange;
+	AgentId m_exchangeId;
+	SymbolId m_symbol; // of the book on the exchange
 	Money m_a, m_b;
 	unsigned int m_tradeUnit;
 	unsigned int m_upcrossingsCount;
@@ -1,212 +1,421 @@
 #include "ExchangeAgent.h"
 #include "Simulation.h"
 #include "ExchangeAgentMessagePayloads.h"
+#include "Snapshot.h"
 
 #include <memory>
 #include <algorithm>
 #include <functional>
-#include <numeric>
 
 #include <iostream>
 
 ExchangeAgent::ExchangeAgent(const Simulation* simulation)
-	: Agent(simulation), m_processingDelay(0), m_bookPtr(nullptr) { }
+	: Agent(simulation), m_processingDelay(0), m_auctionInterval(0) { }
 
 ExchangeAgent::ExchangeAgent(const Simulation* simulation, const std::string& name, const BookPtr& bookPtr, Timestamp processingDelay)
-	: Agent(simulation, name), m_processingDelay(processingDelay), m_bookPtr(bookPtr) {
-
-	std::function<void(TradePtr)> loggingCallbackBound = std::bind(&ExchangeAgent::notifyTradeSubscribers, this, std::placeholders::_1);
-	bookPtr->registerTradeLoggingCallback(loggingCallbackBound);
+	: Agent(simulation, name), m_processingDelay(processingDelay), m_auctionInterval(0) {
+	m_symbols.emplace_back();
+	m_symbols.back().book = bookPtr;
 }
 
+const MessageDispatchTable<ExchangeAgent> ExchangeAgent::s_dispatchTable = MessageDispatchTable<ExchangeAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &ExchangeAgent::handleSimulationStart)
+	.on(MESSAGETYPE_WAKEUP_FOR_AUCTION, &ExchangeAgent::handleWakeupForAuction)
+	.on(MESSAGETYPE_PLACE_ORDER_MARKET, &ExchangeAgent::handlePlaceOrderMarket)
+	.on(MESSAGETYPE_PLACE_ORDER_LIMIT, &ExchangeAgent::handlePlaceOrderLimit)
+	.on(MESSAGETYPE_PLACE_ORDER_STOP, &ExchangeAgent::handlePlaceOrderStop)
+	.on(MESSAGETYPE_RETRIEVE_ORDERS, &ExchangeAgent::handleRetrieveOrders)
+	.on(MESSAGETYPE_CANCEL_ORDERS, &ExchangeAgent::handleCancelOrders)
+	.on(MESSAGETYPE_AMEND_ORDERS, &ExchangeAgent::handleAmendOrders)
+	.on(MESSAGETYPE_REPLACE_ORDERS, &ExchangeAgent::handleReplaceOrders)
+	.on(MESSAGETYPE_RETRIEVE_L1, &ExchangeAgent::handleRetrieveL1)
+	.on(MESSAGETYPE_RETRIEVE_BOOK_ASK, &ExchangeAgent::handleRetrieveBookAsk)
+	.on(MESSAGETYPE_RETRIEVE_BOOK_BID, &ExchangeAgent::handleRetrieveBookBid)
+	.on(MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_MARKET, &ExchangeAgent::handleSubscribeEventOrderMarket)
+	.on(MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_LIMIT, &ExchangeAgent::handleSubscribeEventOrderLimit)
+	.on(MESSAGETYPE_SUBSCRIBE_EVENT_TRADE, &ExchangeAgent::handleSubscribeEventTrade)
+	.on(MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_TRADE, &ExchangeAgent::handleSubscribeEventOrderTrade)
+	.on(MESSAGETYPE_SUBSCRIBE_EVENT_EXECUTION, &ExchangeAgent::handleSubscribeEventExecution);
+
 void ExchangeAgent::receiveMessage(const MessagePtr& msg) {
-	if (msg->type == "PLACE_ORDER_MARKET") {
-		auto ptr = std::dynamic_pointer_cast<PlaceOrderMarketPayload>(msg->payload);
-		auto mop = m_bookPtr->placeMarketOrder(ptr->direction, msg->arrival, ptr->volume);
-		
-		PlaceOrderMarketResponsePayload retpay(mop->id(), ptr);
-		auto retpayptr = std::make_shared<PlaceOrderMarketResponsePayload>(retpay);
-
-		respondToMessage(msg, retpayptr, m_processingDelay);
-
-		notifyMarketOrderSubscribers(mop);
-	} else if (msg->type == "PLACE_ORDER_LIMIT") {
-		auto ptr = std::dynamic_pointer_cast<PlaceOrderLimitPayload>(msg->payload);
-		auto lop = m_bookPtr->placeLimitOrder(ptr->direction, msg->arrival, ptr->volume, ptr->price);
-
-		PlaceOrderLimitResponsePayload retpay(lop->id(), ptr);
-		auto retpayptr = std::make_shared<PlaceOrderLimitResponsePayload>(retpay);
-
-		respondToMessage(msg, retpayptr, m_processingDelay);
-
-		notifyLimitOrderSubscribers(lop);
-	} else if (msg->type == "RETRIEVE_ORDERS") {
-		auto pptr = std::dynamic_pointer_cast<RetrieveOrdersPayload>(msg->payload);
-		auto retpptr = std::make_shared<RetrieveOrdersResponsePayload>();
-		for (OrderID id : pptr->ids) {
-			LimitOrderPtr lop;
-			if (m_bookPtr->tryGetOrder(id, lop)) {
-				retpptr->orders.push_back(*lop);
-			}
-		}
+	if (!s_dispatchTable.dispatch(this, msg)) {
+		fastRespondToMessage(msg, ErrorResponsePayload("Unrecognized request type: " + MessageTypeRegistry::name(msg->type)));
+	}
+}
 
-		respondToMessage(msg, retpptr);
-	} else if (msg->type == "CANCEL_ORDERS") {
-		auto pptr = std::dynamic_pointer_cast<CancelOrdersPayload>(msg->payload);
-		auto retpptr = std::make_shared<CancelOrdersPayload>();
-		
-		for (const auto& cancellation : pptr->cancellations) {
-			auto cancellationCopy = cancellation;
-			cancellationCopy.volume = m_bookPtr->cancelOrder(cancellation.id, cancellation.volume);
-			retpptr->cancellations.push_back(cancellationCopy);
+void ExchangeAgent::handleSimulationStart(const MessagePtr& msg) {
+	if (m_auctionInterval > 0) {
+		simulation()->dispatchMessage(simulation()->currentTimestamp(), m_auctionInterval, id(), id(), MESSAGETYPE_WAKEUP_FOR_AUCTION);
+	}
+}
+
+void ExchangeAgent::handleWakeupForAuction(const MessagePtr& msg) {
+	for (SymbolId symbol = 0; symbol < m_symbols.size(); ++symbol) {
+		SymbolBook& symbolBook = m_symbols[symbol];
+		if (symbolBook.journal != nullptr) {
+			symbolBook.journal->uncross(msg->arrival);
 		}
+		symbolBook.book->uncross(msg->arrival);
+		notifyTradeSubscribers(symbol);
+	}
+
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), m_auctionInterval, id(), id(), MESSAGETYPE_WAKEUP_FOR_AUCTION);
+}
+
+void ExchangeAgent::handlePlaceOrderMarket(const MessagePtr& msg) {
+	const auto& payload = std::get<PlaceOrderMarketPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+
+	auto mop = symbolBook->book->placeMarketOrder(payload.direction, msg->arrival, payload.volume, msg->source);
+	if (symbolBook->journal != nullptr) {
+		symbolBook->journal->marketOrder(msg->arrival, mop->id(), payload.direction, payload.volume);
+	}
+	notifyTradeSubscribers(payload.symbol);
+
+	respondToMessage(msg, PlaceOrderMarketResponsePayload(mop->id(), payload), m_processingDelay);
+
+	notifyMarketOrderSubscribers(payload.symbol, mop);
+}
+
+void ExchangeAgent::handlePlaceOrderLimit(const MessagePtr& msg) {
+	const auto& payload = std::get<PlaceOrderLimitPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
 
-		// NOTE: event [orderId no longer exists in the book] is a no-op
-		// NOTE: might be woth implementing the processing delay as well, in one way or another (think about the error message about)
-		respondToMessage(msg, retpptr, m_processingDelay);
-	} else if (msg->type == "RETRIEVE_L1") {
-		auto retpptr = std::make_shared<RetrieveL1ResponsePayload>();
-		retpptr->time = simulation()->currentTimestamp();
-
-		if (m_bookPtr->sellQueue().empty()) {
-			retpptr->bestAskPrice = 0;
-			retpptr->bestAskVolume = 0;
-			retpptr->askTotalVolume = 0;
-		} else {
-			const auto& bestSellLevel = m_bookPtr->sellQueue().front();
-			retpptr->bestAskPrice = bestSellLevel.price();
-			retpptr->bestAskVolume = bestSellLevel.volume();
-			retpptr->askTotalVolume = std::accumulate(m_bookPtr->sellQueue().begin(), m_bookPtr->sellQueue().end(), (Volume)0, [](Volume acc, const TickContainer& cont) {
-				return acc + cont.volume();
-			});
+	auto lop = symbolBook->book->placeLimitOrder(payload.direction, msg->arrival, payload.volume, payload.price, msg->source);
+	if (symbolBook->journal != nullptr) {
+		symbolBook->journal->limitOrder(msg->arrival, lop->id(), payload.direction, payload.volume, payload.price);
+	}
+	notifyTradeSubscribers(payload.symbol);
+
+	respondToMessage(msg, PlaceOrderLimitResponsePayload(lop->id(), payload), m_processingDelay);
+
+	notifyLimitOrderSubscribers(payload.symbol, lop);
+}
+
+void ExchangeAgent::handlePlaceOrderStop(const MessagePtr& msg) {
+	const auto& payload = std::get<PlaceOrderStopPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+
+	// the order only trades once it triggers, in the trades of the order that triggers it
+	const OrderID id = symbolBook->book->placeStopOrder(payload.direction, msg->arrival, payload.volume, payload.stopPrice, payload.limitPrice, msg->source);
+	if (symbolBook->journal != nullptr) {
+		symbolBook->journal->stopOrder(msg->arrival, id, payload.direction, payload.volume, payload.stopPrice, payload.limitPrice);
+	}
+
+	respondToMessage(msg, PlaceOrderStopResponsePayload(id, payload), m_processingDelay);
+}
+
+void ExchangeAgent::handleRetrieveOrders(const MessagePtr& msg) {
+	const auto& payload = std::get<RetrieveOrdersPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+
+	RetrieveOrdersResponsePayload retpay;
+	for (OrderID id : payload.ids) {
+		LimitOrderPtr lop;
+		if (symbolBook->book->tryGetOrder(id, lop)) {
+			retpay.orders.push_back(*lop);
 		}
+	}
 
-		if (m_bookPtr->buyQueue().empty()) {
-			retpptr->bestBidPrice = 0;
-			retpptr->bestBidVolume = 0;
-			retpptr->bidTotalVolume = 0;
-		} else {
-			const auto& bestBuyLevel = m_bookPtr->buyQueue().back();
-			retpptr->bestBidPrice = bestBuyLevel.price();
-			retpptr->bestBidVolume = bestBuyLevel.volume();
-			retpptr->bidTotalVolume = std::accumulate(m_bookPtr->buyQueue().begin(), m_bookPtr->buyQueue().end(), (Volume)0, [](Volume acc, const TickContainer& cont) {
-				return acc + cont.volume();
-			});
+	respondToMessage(msg, std::move(retpay));
+}
+
+void ExchangeAgent::handleCancelOrders(const MessagePtr& msg) {
+	const auto& payload = std::get<CancelOrdersPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+
+	CancelOrdersPayload retpay;
+	retpay.cancellations.reserve(payload.cancellations.size());
+	retpay.symbol = payload.symbol;
+
+	for (const auto& cancellation : payload.cancellations) {
+		auto cancellationCopy = cancellation;
+		const Volume previousVolume = symbolBook->book->volumeOf(cancellation.id);
+		cancellationCopy.volume = symbolBook->book->cancelOrder(cancellation.id, cancellation.volume);
+		retpay.cancellations.push_back(cancellationCopy);
+		// like the replacements, the journal has what was cancelled, and nothing of the cancellations of the orders already gone
+		if (previousVolume > cancellationCopy.volume && symbolBook->journal != nullptr) {
+			symbolBook->journal->cancel(msg->arrival, cancellation.id, previousVolume - cancellationCopy.volume);
 		}
+		dropTradeSubscribersByOrderID(*symbolBook, cancellation.id);
+	}
 
-		respondToMessage(msg, retpptr);
-	} else if (msg->type == "RETRIEVE_BOOK_ASK") {
-		auto pptr = std::dynamic_pointer_cast<RetrieveBookPayload>(msg->payload);
-		auto retpptr = std::make_shared<RetrieveBookResponsePayload>(simulation()->currentTimestamp());
-		
-		unsigned int actualDepth = (unsigned int)std::min((size_t)pptr->depth, m_bookPtr->sellQueue().size());
-		const auto beg = m_bookPtr->sellQueue().cbegin();
-		auto end = beg;
-		std::advance(end, actualDepth);
-		retpptr->tickContainers.reserve(actualDepth);
-		std::copy(beg, end, std::back_inserter(retpptr->tickContainers));
-
-		respondToMessage(msg, retpptr);
-	} else if (msg->type == "RETRIEVE_BOOK_BID") {
-		auto pptr = std::dynamic_pointer_cast<RetrieveBookPayload>(msg->payload);
-		auto retpptr = std::make_shared<RetrieveBookResponsePayload>(simulation()->currentTimestamp());
-
-		unsigned int actualDepth = (unsigned int)std::min((size_t)pptr->depth, m_bookPtr->buyQueue().size());
-		const auto beg = m_bookPtr->buyQueue().crbegin();
-		auto end = beg;
-		std::advance(end, actualDepth);
-		retpptr->tickContainers.reserve(actualDepth);
-		std::copy(beg, end, std::back_inserter(retpptr->tickContainers));
-
-		respondToMessage(msg, retpptr);
-	} else if (msg->type == "SUBSCRIBE_EVENT_ORDER_MARKET") { 
-		if (std::binary_search(m_marketOrderSubscribers.begin(), m_marketOrderSubscribers.end(), msg->source)) {
-			auto eretpptr = std::make_shared<ErrorResponsePayload>("The agent is already subscribed to order events: " + msg->source);
-			fastRespondToMessage(msg, eretpptr);
-		} else {
-			auto iit = std::upper_bound(m_marketOrderSubscribers.begin(), m_marketOrderSubscribers.end(), msg->source);
-			m_marketOrderSubscribers.insert(iit, msg->source);
-
-			auto sretpptr = std::make_shared<SuccessResponsePayload>("Agent subscribed successfully to order events: " + msg->source);
-			fastRespondToMessage(msg, sretpptr);
+	// NOTE: event [orderId no longer exists in the book] is a no-op
+	// NOTE: might be woth implementing the processing delay as well, in one way or another (think about the error message about)
+	respondToMessage(msg, std::move(retpay), m_processingDelay);
+}
+
+void ExchangeAgent::handleAmendOrders(const MessagePtr& msg) {
+	const auto& payload = std::get<AmendOrdersPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+
+	AmendOrdersPayload retpay;
+	retpay.amendments.reserve(payload.amendments.size());
+	retpay.symbol = payload.symbol;
+
+	for (const auto& amendment : payload.amendments) {
+		auto amendmentCopy = amendment;
+		amendmentCopy.volume = symbolBook->book->amendOrder(amendment.id, msg->arrival, amendment.volume);
+		retpay.amendments.push_back(amendmentCopy);
+		if (symbolBook->journal != nullptr) {
+			symbolBook->journal->amend(msg->arrival, amendment.id, amendment.volume);
 		}
-	} else if (msg->type == "SUBSCRIBE_EVENT_ORDER_LIMIT") {
-		if (std::binary_search(m_limitOrderSubscribers.begin(), m_limitOrderSubscribers.end(), msg->source)) {
-			auto eretpptr = std::make_shared<ErrorResponsePayload>("The agent is already subscribed to order events: " + msg->source);
-			fastRespondToMessage(msg, eretpptr);
-		} else {
-			auto iit = std::upper_bound(m_limitOrderSubscribers.begin(), m_limitOrderSubscribers.end(), msg->source);
-			m_limitOrderSubscribers.insert(iit, msg->source);
-
-			auto sretpptr = std::make_shared<SuccessResponsePayload>("Agent subscribed successfully to order events: " + msg->source);
-			fastRespondToMessage(msg, sretpptr);
+		dropTradeSubscribersByOrderID(*symbolBook, amendment.id);
+	}
+
+	respondToMessage(msg, std::move(retpay), m_processingDelay);
+}
+
+void ExchangeAgent::handleReplaceOrders(const MessagePtr& msg) {
+	const auto& payload = std::get<ReplaceOrdersPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+
+	// all the orders replaced are gone before any replacement is placed, so that a quote can move through the other side of itself;
+	// an order that has already filled, or been cancelled, is not replaced, so that the replacement never adds to its fills
+	std::vector<bool> live;
+	live.reserve(payload.replacements.size());
+	for (const auto& replacement : payload.replacements) {
+		const Volume cancelled = symbolBook->book->cancelOrder(replacement.id);
+		live.push_back(replacement.id == ORDERID_INVALID || cancelled > 0);
+		if (cancelled > 0 && symbolBook->journal != nullptr) {
+			symbolBook->journal->cancel(msg->arrival, replacement.id, cancelled);
 		}
-	} else if (msg->type == "SUBSCRIBE_EVENT_TRADE") {
-		if (std::binary_search(m_tradeSubscribers.begin(), m_tradeSubscribers.end(), msg->source)) {
-			auto eretpptr = std::make_shared<ErrorResponsePayload>("The agent is already subscribed to trade events: " + msg->source);
-			fastRespondToMessage(msg, eretpptr);
-		} else {
-			auto iit = std::upper_bound(m_tradeSubscribers.begin(), m_tradeSubscribers.end(), msg->source);
-			m_tradeSubscribers.insert(iit, msg->source);
-
-			auto sretpptr = std::make_shared<SuccessResponsePayload>("Agent subscribed successfully to trade events: " + msg->source);
-			fastRespondToMessage(msg, sretpptr);
+		dropTradeSubscribersByOrderID(*symbolBook, replacement.id);
+	}
+
+	std::vector<LimitOrderPtr> lops;
+	std::vector<OrderID> ids;
+	lops.reserve(payload.replacements.size());
+	ids.reserve(payload.replacements.size());
+	for (size_t index = 0; index < payload.replacements.size(); ++index) {
+		const auto& replacement = payload.replacements[index];
+		if (!live[index]) {
+			ids.push_back(ORDERID_INVALID);
+			continue;
 		}
-	} else if (msg->type == "SUBSCRIBE_EVENT_ORDER_TRADE") {
-		auto pptr = std::dynamic_pointer_cast<SubscribeEventTradeByOrderPayload>(msg->payload);
-		if (m_tradeByOrderSubscribers.count(pptr->id) == 0) {
-			m_tradeByOrderSubscribers[pptr->id] = std::vector<std::string>();
+
+		lops.push_back(symbolBook->book->placeLimitOrder(replacement.direction, msg->arrival, replacement.volume, replacement.price, msg->source));
+		ids.push_back(lops.back()->id());
+		if (symbolBook->journal != nullptr) {
+			symbolBook->journal->limitOrder(msg->arrival, ids.back(), replacement.direction, replacement.volume, replacement.price);
 		}
+		notifyTradeSubscribers(payload.symbol);
+	}
+
+	respondToMessage(msg, ReplaceOrdersResponsePayload(ids, payload), m_processingDelay);
+
+	for (const auto& lop : lops) {
+		notifyLimitOrderSubscribers(payload.symbol, lop);
+	}
+}
+
+void ExchangeAgent::handleRetrieveL1(const MessagePtr& msg) {
+	const SymbolId symbol = std::holds_alternative<RetrieveL1Payload>(msg->payload) ? std::get<RetrieveL1Payload>(msg->payload).symbol : 0;
+	SymbolBook* symbolBook = this->symbolBook(msg, symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+	const BookPtr& bookPtr = symbolBook->book;
+
+	RetrieveL1ResponsePayload retpay;
+	retpay.time = simulation()->currentTimestamp();
+	retpay.symbol = symbol;
+
+	if (bookPtr->sellQueue().empty()) {
+		retpay.bestAskPrice = 0;
+		retpay.bestAskVolume = 0;
+		retpay.askTotalVolume = 0;
+	} else {
+		const auto& bestSellLevel = bookPtr->sellQueue().best();
+		retpay.bestAskPrice = bestSellLevel.price().toMoney(bookPtr->tickSize());
+		retpay.bestAskVolume = bestSellLevel.volume();
+		retpay.askTotalVolume = bookPtr->sellQueue().volume();
+	}
+
+	if (bookPtr->buyQueue().empty()) {
+		retpay.bestBidPrice = 0;
+		retpay.bestBidVolume = 0;
+		retpay.bidTotalVolume = 0;
+	} else {
+		const auto& bestBuyLevel = bookPtr->buyQueue().best();
+		retpay.bestBidPrice = bestBuyLevel.price().toMoney(bookPtr->tickSize());
+		retpay.bestBidVolume = bestBuyLevel.volume();
+		retpay.bidTotalVolume = bookPtr->buyQueue().volume();
+	}
+
+	respondToMessage(msg, retpay);
+}
+
+void ExchangeAgent::handleRetrieveBookAsk(const MessagePtr& msg) {
+	const auto& payload = std::get<RetrieveBookPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+	const BookPtr& bookPtr = symbolBook->book;
+	RetrieveBookResponsePayload retpay(simulation()->currentTimestamp(), payload.symbol);
+
+	unsigned int actualDepth = (unsigned int)std::min((size_t)payload.depth, bookPtr->sellQueue().size());
+	const auto beg = bookPtr->sellQueue().begin();
+	auto end = beg;
+	std::advance(end, actualDepth);
+	retpay.tickContainers.reserve(actualDepth);
+	std::transform(beg, end, std::back_inserter(retpay.tickContainers), [](const PriceLevel& level) { return level.snapshot(); });
+
+	respondToMessage(msg, std::move(retpay));
+}
+
+void ExchangeAgent::handleRetrieveBookBid(const MessagePtr& msg) {
+	const auto& payload = std::get<RetrieveBookPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+	const BookPtr& bookPtr = symbolBook->book;
+	RetrieveBookResponsePayload retpay(simulation()->currentTimestamp(), payload.symbol);
+
+	unsigned int actualDepth = (unsigned int)std::min((size_t)payload.depth, bookPtr->buyQueue().size());
+	const auto beg = bookPtr->buyQueue().begin();
+	auto end = beg;
+	std::advance(end, actualDepth);
+	retpay.tickContainers.reserve(actualDepth);
+	std::transform(beg, end, std::back_inserter(retpay.tickContainers), [](const PriceLevel& level) { return level.snapshot(); });
+
+	respondToMessage(msg, std::move(retpay));
+}
+
+void ExchangeAgent::handleSubscribeEventOrderMarket(const MessagePtr& msg) {
+	subscribe(msg, &SymbolBook::marketOrderSubscribers, m_marketOrderSubscribers, "order events");
+}
+
+void ExchangeAgent::handleSubscribeEventOrderLimit(const MessagePtr& msg) {
+	subscribe(msg, &SymbolBook::limitOrderSubscribers, m_limitOrderSubscribers, "order events");
+}
 
-		auto& subscribers = m_tradeByOrderSubscribers[pptr->id];
-		if (std::binary_search(subscribers.begin(), subscribers.end(), msg->source)) {
-			auto eretpptr = std::make_shared<ErrorResponsePayload>("The agent is already subscribed to trade events for order " + std::to_string(pptr->id) + ":" + msg->source);
-			fastRespondToMessage(msg, eretpptr);
-		} else {
-			auto iit = std::upper_bound(subscribers.begin(), subscribers.end(), msg->source);
-			subscribers.insert(iit, msg->source);
+void ExchangeAgent::handleSubscribeEventTrade(const MessagePtr& msg) {
+	subscribe(msg, &SymbolBook::tradeSubscribers, m_tradeSubscribers, "trade events");
+}
+
+void ExchangeAgent::handleSubscribeEventExecution(const MessagePtr& msg) {
+	subscribe(msg, &SymbolBook::executionSubscribers, m_executionSubscribers, "execution reports");
+}
 
-			auto sretpptr = std::make_shared<SuccessResponsePayload>("Agent subscribed to trade events for order " + std::to_string(pptr->id) + ":" + msg->source);
-			fastRespondToMessage(msg, sretpptr);
+void ExchangeAgent::subscribe(const MessagePtr& msg, std::vector<AgentId> SymbolBook::* symbolSubscribers, std::vector<AgentId>& allSubscribers, const std::string& events) {
+	const SymbolId symbol = std::holds_alternative<SubscribeEventPayload>(msg->payload) ? std::get<SubscribeEventPayload>(msg->payload).symbol : SYMBOLID_ALL;
+	std::vector<AgentId>* subscribers = &allSubscribers;
+	if (symbol != SYMBOLID_ALL) {
+		SymbolBook* symbolBook = this->symbolBook(msg, symbol);
+		if (symbolBook == nullptr) {
+			return;
 		}
+		subscribers = &(symbolBook->*symbolSubscribers);
+	}
+
+	if (std::binary_search(subscribers->begin(), subscribers->end(), msg->source)) {
+		fastRespondToMessage(msg, ErrorResponsePayload("The agent is already subscribed to " + events + ": " + simulation()->agentName(msg->source)));
 	} else {
-		auto retpptr = std::make_shared<ErrorResponsePayload>("Unrecognized request type: " + msg->type);
+		auto iit = std::upper_bound(subscribers->begin(), subscribers->end(), msg->source);
+		subscribers->insert(iit, msg->source);
 
-		fastRespondToMessage(msg, retpptr);
+		fastRespondToMessage(msg, SuccessResponsePayload("Agent subscribed successfully to " + events + ": " + simulation()->agentName(msg->source)));
 	}
 }
 
-#include "PriceTimeBook.h"
-#include "PureProRataBook.h"
-#include "PriorityProRataBook.h"
-#include "TimeProRataBook.h"
+void ExchangeAgent::handleSubscribeEventOrderTrade(const MessagePtr& msg) {
+	const auto& payload = std::get<SubscribeEventTradeByOrderPayload>(msg->payload);
+	SymbolBook* symbolBook = this->symbolBook(msg, payload.symbol);
+	if (symbolBook == nullptr) {
+		return;
+	}
+	if (!symbolBook->book->contains(payload.id)) {
+		// the order will not trade any more, and the subscription would never go away
+		fastRespondToMessage(msg, ErrorResponsePayload("The order is not in the book: " + std::to_string(payload.id)));
+		return;
+	}
+
+	auto& subscribers = symbolBook->tradeByOrderSubscribers[payload.id];
+	if (std::binary_search(subscribers.begin(), subscribers.end(), msg->source)) {
+		fastRespondToMessage(msg, ErrorResponsePayload("The agent is already subscribed to trade events for order " + std::to_string(payload.id) + ":" + simulation()->agentName(msg->source)));
+	} else {
+		auto iit = std::upper_bound(subscribers.begin(), subscribers.end(), msg->source);
+		subscribers.insert(iit, msg->source);
+
+		fastRespondToMessage(msg, SuccessResponsePayload("Agent subscribed to trade events for order " + std::to_string(payload.id) + ":" + simulation()->agentName(msg->source)));
+	}
+}
+
+ExchangeAgent::SymbolBook* ExchangeAgent::symbolBook(const MessagePtr& msg, SymbolId symbol) {
+	if (symbol >= m_symbols.size()) {
+		fastRespondToMessage(msg, ErrorResponsePayload("The exchange has no symbol " + std::to_string(symbol) + ": " + name()));
+		return nullptr;
+	}
+	return &m_symbols[symbol];
+}
+
+#include "BookFactory.h"
 #include "SimulationException.h"
 #include "ParameterStorage.h"
 
 void ExchangeAgent::configure(const pugi::xml_node& node, const std::string& configurationPath) {
 	Agent::configure(node, configurationPath);
+	if (partition().empty()) {
+		setPartition(name());
+	}
 
 	pugi::xml_attribute att;
+	Money tickSize(0, 1);
+	if (!(att = node.attribute("tickSize")).empty()) {
+		tickSize = Money::nearest(std::stod(simulation()->parameters().processString(att.as_string())));
+		if (tickSize <= Money(0)) {
+			throw SimulationException("ExchangeAgent::configure(): the tick size has to be positive");
+		}
+	}
+
+	SymbolId symbolCount = 1;
+	if (!(att = node.attribute("symbols")).empty()) {
+		symbolCount = (SymbolId)std::stoul(simulation()->parameters().processString(att.as_string()));
+		if (symbolCount == 0 || symbolCount == SYMBOLID_ALL) {
+			throw SimulationException("ExchangeAgent::configure(): the number of symbols is out of range");
+		}
+	}
+
+	size_t ladderWindow = PriceLadder::DEFAULT_WINDOW_SIZE;
+	if (!(att = node.attribute("ladderWindow")).empty()) {
+		ladderWindow = std::stoul(simulation()->parameters().processString(att.as_string()));
+		if (ladderWindow < PriceLadder::MIN_WINDOW_SIZE || ladderWindow > PriceLadder::MAX_WINDOW_SIZE || (ladderWindow & (ladderWindow - 1)) != 0) {
+			throw SimulationException("ExchangeAgent::configure(): the ladder window has to be a power of two from " + std::to_string(PriceLadder::MIN_WINDOW_SIZE)
+				+ " to " + std::to_string(PriceLadder::MAX_WINDOW_SIZE) + " ticks");
+		}
+	}
+
+	std::string algorithm;
 	if (!(att = node.attribute("algorithm")).empty()) {
-		std::string algorithm = simulation()->parameters().processString(att.as_string());
-		std::function<void(TradePtr)> loggingCallbackBound = std::bind(&ExchangeAgent::notifyTradeSubscribers, this, std::placeholders::_1);
-		
-		auto orderFactoryPtr = std::make_shared<OrderFactory>();
-		auto tradeFactoryPtr = std::make_shared<TradeFactory>();
-		if (algorithm == "PriceTime") {
-			m_bookPtr = std::make_shared<PriceTimeBook>(orderFactoryPtr, tradeFactoryPtr);
-			m_bookPtr->registerTradeLoggingCallback(loggingCallbackBound);
-		} else if (algorithm == "PureProRata") {
-			m_bookPtr = std::make_shared<PureProRataBook>(orderFactoryPtr, tradeFactoryPtr);
-			m_bookPtr->registerTradeLoggingCallback(loggingCallbackBound);
-		} else if (algorithm == "PriorityProRata") {
-			m_bookPtr = std::make_shared<PriorityProRataBook>(orderFactoryPtr, tradeFactoryPtr);
-			m_bookPtr->registerTradeLoggingCallback(loggingCallbackBound);
-		} else if (algorithm == "TimeProRata") {
-			m_bookPtr = std::make_shared<TimeProRataBook>(orderFactoryPtr, tradeFactoryPtr);
-			m_bookPtr->registerTradeLoggingCallback(loggingCallbackBound);
-		} else {
-			throw SimulationException("ExchangeAgent::configure(): unknown algorithm '" + algorithm + "'");
+		algorithm = simulation()->parameters().processString(att.as_string());
+		m_symbols.clear();
+		m_symbols.resize(symbolCount);
+		for (SymbolBook& symbolBook : m_symbols) {
+			symbolBook.book = BookFactory::make(algorithm, tickSize, ladderWindow);
 		}
 	}
 
@@ -214,44 +423,157 @@ void ExchangeAgent::configure(const pugi::xml_node& node, const std::string& con
 		std::string pd = simulation()->parameters().processString(att.as_string());
 		m_processingDelay = std::stoull(pd);
 	}
+
+	if (!(att = node.attribute("auctionInterval")).empty()) {
+		m_auctionInterval = std::stoull(simulation()->parameters().processString(att.as_string()));
+	}
+	if (algorithm == "BatchAuction" && m_auctionInterval == 0) {
+		throw SimulationException("ExchangeAgent::configure(): the BatchAuction algorithm needs a positive auctionInterval");
+	}
+
+	if (!(att = node.attribute("journal")).empty()) {
+		if (m_symbols.empty()) {
+			throw SimulationException("ExchangeAgent::configure(): a journal needs the book of an algorithm to journal");
+		}
+		// a journal replays into a single book, with several symbols every book gets its own
+		const std::string path = simulation()->parameters().processString(att.as_string());
+		for (SymbolId symbol = 0; symbol < m_symbols.size(); ++symbol) {
+			m_symbols[symbol].journal = std::make_unique<JournalWriter>(m_symbols.size() == 1 ? path : path + "." + std::to_string(symbol), algorithm, tickSize);
+		}
+	}
 }
 
-void ExchangeAgent::notifyMarketOrderSubscribers(MarketOrderPtr ptr) {
-	auto currentTimestamp = simulation()->currentTimestamp();
-	for(const std::string& subscriber : m_marketOrderSubscribers) {
-		auto pptr = std::make_shared<EventOrderMarketPayload>(*ptr);
-		simulation()->dispatchMessage(currentTimestamp, m_processingDelay, name(), subscriber, "EVENT_ORDER_MARKET", pptr);
+static void writeSubscribers(SnapshotWriter& writer, const std::vector<AgentId>& subscribers) {
+	writer.write((std::uint64_t)subscribers.size());
+	for (AgentId subscriber : subscribers) {
+		writer.write(subscriber);
 	}
 }
 
-void ExchangeAgent::notifyLimitOrderSubscribers(LimitOrderPtr ptr) {
-	auto currentTimestamp = simulation()->currentTimestamp();
-	for (const std::string& subscriber : m_limitOrderSubscribers) {
-		auto pptr = std::make_shared<EventOrderLimitPayload>(*ptr);
-		simulation()->dispatchMessage(currentTimestamp, m_processingDelay, name(), subscriber, "EVENT_ORDER_LIMIT", pptr);
+static void readSubscribers(SnapshotReader& reader, std::vector<AgentId>& subscribers) {
+	subscribers.resize(reader.read<std::uint64_t>());
+	for (AgentId& subscriber : subscribers) {
+		subscriber = reader.read<AgentId>();
 	}
 }
 
-void ExchangeAgent::notifyTradeSubscribers(TradePtr tradePtr) {
-	const auto currentTimestamp = simulation()->currentTimestamp();
-	tradePtr->setTimestamp(currentTimestamp); // the trade happens exactly on the receipt of the aggressing order, no processing delay there; the processing delay only kicks in sending out a response and events related to the matching
+void ExchangeAgent::saveState(SnapshotWriter& writer) {
+	writer.write((std::uint64_t)m_symbols.size());
+	for (const SymbolBook& symbolBook : m_symbols) {
+		symbolBook.book->saveState(writer);
 
-	for (const std::string& subscriber : m_tradeSubscribers) {
-		auto pptr = std::make_shared<EventTradePayload>(*tradePtr);
-		simulation()->dispatchMessage(currentTimestamp, m_processingDelay, name(), subscriber, "EVENT_TRADE", pptr);
+		for (const std::vector<AgentId>* subscribers : { &symbolBook.marketOrderSubscribers, &symbolBook.limitOrderSubscribers, &symbolBook.tradeSubscribers, &symbolBook.executionSubscribers }) {
+			writeSubscribers(writer, *subscribers);
+		}
+
+		writer.write((std::uint64_t)symbolBook.tradeByOrderSubscribers.size());
+		for (const auto& [orderId, subscribers] : symbolBook.tradeByOrderSubscribers) {
+			writer.write(orderId);
+			writeSubscribers(writer, subscribers);
+		}
+	}
+
+	for (const std::vector<AgentId>* subscribers : { &m_marketOrderSubscribers, &m_limitOrderSubscribers, &m_tradeSubscribers, &m_executionSubscribers }) {
+		writeSubscribers(writer, *subscribers);
+	}
+}
+
+void ExchangeAgent::loadState(SnapshotReader& reader) {
+	const std::uint64_t symbolCount = reader.read<std::uint64_t>();
+	if (symbolCount != m_symbols.size()) {
+		throw SimulationException("ExchangeAgent::loadState(): the snapshot of '" + name() + "' does not match its configured algorithm and symbols");
+	}
+
+	for (SymbolBook& symbolBook : m_symbols) {
+		symbolBook.book->loadState(reader);
+
+		for (std::vector<AgentId>* subscribers : { &symbolBook.marketOrderSubscribers, &symbolBook.limitOrderSubscribers, &symbolBook.tradeSubscribers, &symbolBook.executionSubscribers }) {
+			readSubscribers(reader, *subscribers);
+		}
+
+		symbolBook.tradeByOrderSubscribers.clear();
+		const std::uint64_t orderCount = reader.read<std::uint64_t>();
+		for (std::uint64_t orderIndex = 0; orderIndex < orderCount; ++orderIndex) {
+			readSubscribers(reader, symbolBook.tradeByOrderSubscribers[reader.read<OrderID>()]);
+		}
+	}
+
+	for (std::vector<AgentId>* subscribers : { &m_marketOrderSubscribers, &m_limitOrderSubscribers, &m_tradeSubscribers, &m_executionSubscribers }) {
+		readSubscribers(reader, *subscribers);
+	}
+}
+
+const std::vector<AgentId>& ExchangeAgent::subscribers(const std::vector<AgentId>& symbolSubscribers, const std::vector<AgentId>& allSubscribers) {
+	if (allSubscribers.empty()) {
+		return symbolSubscribers;
+	}
+	if (symbolSubscribers.empty()) {
+		return allSubscribers;
 	}
 
-	notifyTradeSubscribersByOrderID(tradePtr, tradePtr->aggressingOrderID());
-	notifyTradeSubscribersByOrderID(tradePtr, tradePtr->restingOrderID());
+	m_targets.clear();
+	std::set_union(symbolSubscribers.begin(), symbolSubscribers.end(), allSubscribers.begin(), allSubscribers.end(), std::back_inserter(m_targets));
+	return m_targets;
 }
 
-void ExchangeAgent::notifyTradeSubscribersByOrderID(TradePtr tradePtr, OrderID orderId) {
+void ExchangeAgent::notifyMarketOrderSubscribers(SymbolId symbol, MarketOrderPtr ptr) {
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), m_processingDelay, id(), subscribers(m_symbols[symbol].marketOrderSubscribers, m_marketOrderSubscribers),
+		MESSAGETYPE_EVENT_ORDER_MARKET, EventOrderMarketPayload(*ptr, symbol));
+}
+
+void ExchangeAgent::notifyLimitOrderSubscribers(SymbolId symbol, LimitOrderPtr ptr) {
+	simulation()->dispatchMessage(simulation()->currentTimestamp(), m_processingDelay, id(), subscribers(m_symbols[symbol].limitOrderSubscribers, m_limitOrderSubscribers),
+		MESSAGETYPE_EVENT_ORDER_LIMIT, EventOrderLimitPayload(*ptr, symbol));
+}
+
+void ExchangeAgent::notifyTradeSubscribers(SymbolId symbol) {
+	SymbolBook& symbolBook = m_symbols[symbol];
+	symbolBook.book->takeTrades(m_trades);
+
 	const auto currentTimestamp = simulation()->currentTimestamp();
-	if (m_tradeByOrderSubscribers.count(orderId) > 0) {
-		const auto& subscribers = m_tradeByOrderSubscribers[orderId];
-		for (const std::string& subscriber : subscribers) {
-			auto pptr = std::make_shared<EventTradePayload>(*tradePtr);
-			simulation()->dispatchMessage(currentTimestamp, m_processingDelay, name(), subscriber, "EVENT_TRADE", pptr);
+	for (Trade& trade : m_trades) {
+		trade.setTimestamp(currentTimestamp); // the trade happens exactly on the receipt of the aggressing order, no processing delay there; the processing delay only kicks in sending out a response and events related to the matching
+		if (symbolBook.journal != nullptr) {
+			symbolBook.journal->fill(trade);
 		}
+
+		simulation()->dispatchMessage(currentTimestamp, m_processingDelay, id(), subscribers(symbolBook.tradeSubscribers, m_tradeSubscribers), MESSAGETYPE_EVENT_TRADE, EventTradePayload(trade, symbol));
+		notifyTradeSubscribersByOrderID(symbol, trade, trade.aggressingOrderID());
+		notifyTradeSubscribersByOrderID(symbol, trade, trade.restingOrderID());
+
+		// the owners subscribed to their execution reports are told about their own orders, whichever they are
+		if (subscribesToExecutions(symbolBook, trade.aggressingAgent())) {
+			simulation()->dispatchMessage(currentTimestamp, m_processingDelay, id(), trade.aggressingAgent(), MESSAGETYPE_EVENT_EXECUTION, EventExecutionPayload(trade, trade.aggressingOrderID(), symbol));
+		}
+		if (subscribesToExecutions(symbolBook, trade.restingAgent())) {
+			simulation()->dispatchMessage(currentTimestamp, m_processingDelay, id(), trade.restingAgent(), MESSAGETYPE_EVENT_EXECUTION, EventExecutionPayload(trade, trade.restingOrderID(), symbol));
+		}
+	}
+
+	// once all the trades are out, an order may have been filled in several of them; the aggressing one, a triggered stop order
+	// included, is gone unless it rests with what is left of it
+	for (const Trade& trade : m_trades) {
+		dropTradeSubscribersByOrderID(symbolBook, trade.aggressingOrderID());
+		dropTradeSubscribersByOrderID(symbolBook, trade.restingOrderID());
+	}
+}
+
+bool ExchangeAgent::subscribesToExecutions(const SymbolBook& symbolBook, AgentId agent) const {
+	return agent != AGENTID_INVALID
+		&& (std::binary_search(symbolBook.executionSubscribers.begin(), symbolBook.executionSubscribers.end(), agent)
+			|| std::binary_search(m_executionSubscribers.begin(), m_executionSubscribers.end(), agent));
+}
+
+void ExchangeAgent::dropTradeSubscribersByOrderID(SymbolBook& symbolBook, OrderID orderId) {
+	if (!symbolBook.tradeByOrderSubscribers.empty() && !symbolBook.book->contains(orderId)) {
+		symbolBook.tradeByOrderSubscribers.erase(orderId);
+	}
+}
+
+void ExchangeAgent::notifyTradeSubscribersByOrderID(SymbolId symbol, const Trade& trade, OrderID orderId) {
+	const auto& tradeByOrderSubscribers = m_symbols[symbol].tradeByOrderSubscribers;
+	auto it = tradeByOrderSubscribers.find(orderId);
+	if (it != tradeByOrderSubscribers.end()) {
+		simulation()->dispatchMessage(simulation()->currentTimestamp(), m_processingDelay, id(), it->second, MESSAGETYPE_EVENT_TRADE, EventTradePayload(trade, symbol));
 	}
 }
@@ -1,33 +1,93 @@
 #pragma once
 
 #include "Agent.h"
+#include "MessageDispatchTable.h"
 #include "Book.h"
+#include "BookJournal.h"
+#include "SymbolId.h"
 
-#include <list>
 #include <map>
+#include <memory>
 
+// An exchange with a book for each of its symbols, the symbols 0, 1 and so on. The books all match with the same algorithm,
+// on the same tick size; an agent subscribes to the events of one symbol or of all of them, and so to the execution reports on
+// its own orders. Books matching in auctions are uncrossed all at once, every auction interval from the start of the simulation.
+// The stop orders wait in the books, and the orders they turn into once triggered are not announced to the order event
+// subscribers, only their trades are.
 class ExchangeAgent : public Agent {
 public:
 	ExchangeAgent(const Simulation* simulation);
+	// of the single symbol 0
 	ExchangeAgent(const Simulation* simulation, const std::string& name, const BookPtr& bookPtr, Timestamp processingDelay = 0);
 	virtual ~ExchangeAgent() = default;
 
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
 
 	Timestamp processingDelay() const { return m_processingDelay; }
+	SymbolId symbolCount() const { return (SymbolId)m_symbols.size(); }
 
 	void configure(const pugi::xml_node& node, const std::string& configurationPath) override;
+
+	void saveState(SnapshotWriter& writer) override;
+	void loadState(SnapshotReader& reader) override;
 private:
+	static const MessageDispatchTable<ExchangeAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& msg);
+	void handleWakeupForAuction(const MessagePtr& msg);
+	void handlePlaceOrderMarket(const MessagePtr& msg);
+	void handlePlaceOrderLimit(const MessagePtr& msg);
+	void handlePlaceOrderStop(const MessagePtr& msg);
+	void handleRetrieveOrders(const MessagePtr& msg);
+	void handleCancelOrders(const MessagePtr& msg);
+	void handleAmendOrders(const MessagePtr& msg);
+	void handleReplaceOrders(const MessagePtr& msg);
+	void handleRetrieveL1(const MessagePtr& msg);
+	void handleRetrieveBookAsk(const MessagePtr& msg);
+	void handleRetrieveBookBid(const MessagePtr& msg);
+	void handleSubscribeEventOrderMarket(const MessagePtr& msg);
+	void handleSubscribeEventOrderLimit(const MessagePtr& msg);
+	void handleSubscribeEventTrade(const MessagePtr& msg);
+	void handleSubscribeEventOrderTrade(const MessagePtr& msg);
+	void handleSubscribeEventExecution(const MessagePtr& msg);
+
+	struct SymbolBook {
+		BookPtr book;
+		std::unique_ptr<JournalWriter> journal; // nullptr unless the exchange journals its books
+
+		// sorted, an event goes out to all of them and to the subscribers to every symbol as one message
+		std::vector<AgentId> marketOrderSubscribers;
+		std::vector<AgentId> limitOrderSubscribers;
+		std::vector<AgentId> tradeSubscribers;
+		std::vector<AgentId> executionSubscribers; // to the execution reports on their own orders
+		std::map<OrderID, std::vector<AgentId>> tradeByOrderSubscribers;
+	};
+
 	Timestamp m_processingDelay;
-	BookPtr m_bookPtr;
+	Timestamp m_auctionInterval; // 0 unless the books match in auctions
+	std::vector<SymbolBook> m_symbols; // indexed by the symbol
+
+	// to the events of every symbol, sorted
+	std::vector<AgentId> m_marketOrderSubscribers;
+	std::vector<AgentId> m_limitOrderSubscribers;
+	std::vector<AgentId> m_tradeSubscribers;
+	std::vector<AgentId> m_executionSubscribers;
+	std::vector<Trade> m_trades; // taken from the book after every placement, the buffer is handed back and forth
+	std::vector<AgentId> m_targets; // the subscribers of an event, when they are merged
 
-	std::list<std::string> m_marketOrderSubscribers;
-	std::list<std::string> m_limitOrderSubscribers;
-	std::list<std::string> m_tradeSubscribers;
-	std::map<OrderID, std::vector<std::string>> m_tradeByOrderSubscribers;
+	// the book of the symbol; nullptr, with an error in response to the message, if the exchange has no such symbol
+	SymbolBook* symbolBook(const MessagePtr& msg, SymbolId symbol);
+	// the subscribers to the symbol and to every symbol
+	const std::vector<AgentId>& subscribers(const std::vector<AgentId>& symbolSubscribers, const std::vector<AgentId>& allSubscribers);
+	// to the symbol of the payload, to every symbol without one
+	void subscribe(const MessagePtr& msg, std::vector<AgentId> SymbolBook::* symbolSubscribers, std::vector<AgentId>& allSubscribers, const std::string& events);
 
-	void notifyMarketOrderSubscribers(MarketOrderPtr ptr);
-	void notifyLimitOrderSubscribers(LimitOrderPtr ptr);
-	void notifyTradeSubscribers(TradePtr tradePtr);
-	void notifyTradeSubscribersByOrderID(TradePtr tradePtr, OrderID orderId);
+	void notifyMarketOrderSubscribers(SymbolId symbol, MarketOrderPtr ptr);
+	void notifyLimitOrderSubscribers(SymbolId symbol, LimitOrderPtr ptr);
+	// of the trades of the last placement, the owners of both orders get an execution report if they subscribed to them
+	void notifyTradeSubscribers(SymbolId symbol);
+	bool subscribesToExecutions(const SymbolBook& symbolBook, AgentId agent) const;
+	void notifyTradeSubscribersByOrderID(SymbolId symbol, const Trade& trade, OrderID orderId);
+	// the subscriptions to the order, once it has left the book
+	void dropTradeSubscribersByOrderID(SymbolBook& symbolBook, OrderID orderId);
 };
@@ -5,22 +5,28 @@
 #include "Order.h"
 #include "Trade.h"
 #include "Book.h"
+#include "SymbolId.h"
 
+#include <optional>
 #include <vector>
 #include <string>
 
+// The requests about a book name its symbol, the symbol 0 by default, which is the only one of a single-book exchange.
+// The order ids are those of the book of the symbol, the orders of different symbols may share them.
+
 struct PlaceOrderMarketPayload : public MessagePayload {
 	OrderDirection direction;
 	Volume volume;
+	SymbolId symbol;
 
-	PlaceOrderMarketPayload(OrderDirection direction, Volume volume) : direction(direction), volume(volume) { }
+	PlaceOrderMarketPayload(OrderDirection direction, Volume volume, SymbolId symbol = 0) : direction(direction), volume(volume), symbol(symbol) { }
 };
 
 struct PlaceOrderMarketResponsePayload : public MessagePayload {
 	OrderID id;
-	std::shared_ptr<PlaceOrderMarketPayload> requestPayload;
+	PlaceOrderMarketPayload requestPayload;
 
-	PlaceOrderMarketResponsePayload(OrderID id, const std::shared_ptr<PlaceOrderMarketPayload>& requestPayload)
+	PlaceOrderMarketResponsePayload(OrderID id, const PlaceOrderMarketPayload& requestPayload)
 		: id(id), requestPayload(requestPayload) { }
 };
 
@@ -28,23 +34,45 @@ struct PlaceOrderLimitPayload : public MessagePayload {
 	OrderDirection direction;
 	Volume volume;
 	Money price;
+	SymbolId symbol;
 
-	PlaceOrderLimitPayload(OrderDirection direction, Volume volume, Money price) : direction(direction), volume(volume), price(price) { }
+	PlaceOrderLimitPayload(OrderDirection direction, Volume volume, Money price, SymbolId symbol = 0) : direction(direction), volume(volume), price(price), symbol(symbol) { }
 };
 
 struct PlaceOrderLimitResponsePayload : public MessagePayload {
 	OrderID id;
-	std::shared_ptr<PlaceOrderLimitPayload> requestPayload;
+	PlaceOrderLimitPayload requestPayload;
+
+	PlaceOrderLimitResponsePayload(OrderID id, const PlaceOrderLimitPayload& requestPayload)
+		: id(id), requestPayload(requestPayload) { }
+};
+
+// a stop-market order without the limit price, a stop-limit order with it; the response carries the id the order trades under once it triggers
+struct PlaceOrderStopPayload : public MessagePayload {
+	OrderDirection direction;
+	Volume volume;
+	Money stopPrice;
+	std::optional<Money> limitPrice;
+	SymbolId symbol;
+
+	PlaceOrderStopPayload(OrderDirection direction, Volume volume, Money stopPrice, std::optional<Money> limitPrice = std::nullopt, SymbolId symbol = 0)
+		: direction(direction), volume(volume), stopPrice(stopPrice), limitPrice(limitPrice), symbol(symbol) { }
+};
+
+struct PlaceOrderStopResponsePayload : public MessagePayload {
+	OrderID id;
+	PlaceOrderStopPayload requestPayload;
 
-	PlaceOrderLimitResponsePayload(OrderID id, const std::shared_ptr<PlaceOrderLimitPayload>& requestPayload)
+	PlaceOrderStopResponsePayload(OrderID id, const PlaceOrderStopPayload& requestPayload)
 		: id(id), requestPayload(requestPayload) { }
 };
 
 struct RetrieveOrdersPayload : public MessagePayload {
 	std::vector<OrderID> ids;
+	SymbolId symbol;
 
-	RetrieveOrdersPayload(const std::vector<OrderID>& ids)
-		: ids(ids) {}
+	RetrieveOrdersPayload(const std::vector<OrderID>& ids, SymbolId symbol = 0)
+		: ids(ids), symbol(symbol) {}
 };
 
 struct RetrieveOrdersResponsePayload : public MessagePayload {
@@ -62,31 +90,84 @@ struct CancelOrdersCancellation {
 
 struct CancelOrdersPayload : public MessagePayload {
 	std::vector<CancelOrdersCancellation> cancellations;
+	SymbolId symbol;
 
 	CancelOrdersPayload()
-		: cancellations() { }
-	CancelOrdersPayload(const std::vector<CancelOrdersCancellation>& cancellations)
-		: cancellations(cancellations) { }
+		: cancellations(), symbol(0) { }
+	CancelOrdersPayload(const std::vector<CancelOrdersCancellation>& cancellations, SymbolId symbol = 0)
+		: cancellations(cancellations), symbol(symbol) { }
+};
+
+struct AmendOrdersAmendment {
+	OrderID id;
+	Volume volume; // the new volume of the order, a higher one than it has loses its priority
+
+	AmendOrdersAmendment(OrderID id, Volume volume) : id(id), volume(volume) { }
+};
+
+struct AmendOrdersPayload : public MessagePayload {
+	std::vector<AmendOrdersAmendment> amendments;
+	SymbolId symbol;
+
+	AmendOrdersPayload()
+		: amendments(), symbol(0) { }
+	AmendOrdersPayload(const std::vector<AmendOrdersAmendment>& amendments, SymbolId symbol = 0)
+		: amendments(amendments), symbol(symbol) { }
+};
+
+struct ReplaceOrdersReplacement {
+	OrderID id; // whatever is left of it is cancelled, and if nothing is, the replacement is not placed; ORDERID_INVALID only places it
+	OrderDirection direction;
+	Volume volume;
+	Money price;
+
+	ReplaceOrdersReplacement(OrderID id, OrderDirection direction, Volume volume, Money price)
+		: id(id), direction(direction), volume(volume), price(price) { }
+};
+
+struct ReplaceOrdersPayload : public MessagePayload {
+	std::vector<ReplaceOrdersReplacement> replacements;
+	SymbolId symbol;
+
+	ReplaceOrdersPayload()
+		: replacements(), symbol(0) { }
+	ReplaceOrdersPayload(const std::vector<ReplaceOrdersReplacement>& replacements, SymbolId symbol = 0)
+		: replacements(replacements), symbol(symbol) { }
+};
+
+struct ReplaceOrdersResponsePayload : public MessagePayload {
+	std::vector<OrderID> ids; // of the replacements, in the order of the request; ORDERID_INVALID for the ones rejected
+	ReplaceOrdersPayload requestPayload;
+
+	ReplaceOrdersResponsePayload(const std::vector<OrderID>& ids, const ReplaceOrdersPayload& requestPayload)
+		: ids(ids), requestPayload(requestPayload) { }
 };
 
 struct RetrieveBookPayload : public MessagePayload {
 	unsigned int depth;
+	SymbolId symbol;
 
-	RetrieveBookPayload(unsigned int _)
-		: depth(_) { }
+	RetrieveBookPayload(unsigned int _, SymbolId symbol = 0)
+		: depth(_), symbol(symbol) { }
 };
 
 struct RetrieveBookResponsePayload : public MessagePayload {
 	Timestamp time;
 	std::vector<TickContainer> tickContainers;
+	SymbolId symbol;
 
-	RetrieveBookResponsePayload(Timestamp time)
-		: RetrieveBookResponsePayload(time, std::vector<TickContainer>()) { }
-	RetrieveBookResponsePayload(Timestamp time, const std::vector<TickContainer>& tickContainers)
-		: time(time), tickContainers(tickContainers) { }
+	RetrieveBookResponsePayload(Timestamp time, SymbolId symbol = 0)
+		: RetrieveBookResponsePayload(time, std::vector<TickContainer>(), symbol) { }
+	RetrieveBookResponsePayload(Timestamp time, const std::vector<TickContainer>& tickContainers, SymbolId symbol = 0)
+		: time(time), tickContainers(tickContainers), symbol(symbol) { }
 };
 
-struct RetrieveL1Payload : public MessagePayload { };
+// no payload at all asks about the symbol 0
+struct RetrieveL1Payload : public MessagePayload {
+	SymbolId symbol;
+
+	RetrieveL1Payload(SymbolId symbol = 0) : symbol(symbol) { }
+};
 
 struct RetrieveL1ResponsePayload : public MessagePayload {
 	Timestamp time;
@@ -97,32 +178,53 @@ struct RetrieveL1ResponsePayload : public MessagePayload {
 	Money bestBidPrice;
 	Volume bestBidVolume;
 	Volume bidTotalVolume;
+	SymbolId symbol;
 
 	RetrieveL1ResponsePayload() = default;
-	RetrieveL1ResponsePayload(Timestamp time, Money bestAskPrice, Volume bestAskVolume, Volume askTotalVolume, Money bestBidPrice, Volume bestBidVolume, Volume bidTotalVolume)
-		: time(time), bestAskPrice(bestAskPrice), bestAskVolume(bestAskVolume), askTotalVolume(askTotalVolume), bestBidPrice(bestBidPrice), bestBidVolume(bestBidVolume), bidTotalVolume(bidTotalVolume) { }
+	RetrieveL1ResponsePayload(Timestamp time, Money bestAskPrice, Volume bestAskVolume, Volume askTotalVolume, Money bestBidPrice, Volume bestBidVolume, Volume bidTotalVolume, SymbolId symbol = 0)
+		: time(time), bestAskPrice(bestAskPrice), bestAskVolume(bestAskVolume), askTotalVolume(askTotalVolume), bestBidPrice(bestBidPrice), bestBidVolume(bestBidVolume), bidTotalVolume(bidTotalVolume), symbol(symbol) { }
+};
+
+// to the market order, limit order or trade events of a symbol; no payload at all subscribes to those of every symbol
+struct SubscribeEventPayload : public MessagePayload {
+	SymbolId symbol;
+
+	SubscribeEventPayload(SymbolId symbol = SYMBOLID_ALL) : symbol(symbol) { }
 };
 
 struct SubscribeEventTradeByOrderPayload : public MessagePayload {
 	OrderID id;
+	SymbolId symbol;
 
-	SubscribeEventTradeByOrderPayload(OrderID id) : id(id) { }
+	SubscribeEventTradeByOrderPayload(OrderID id, SymbolId symbol = 0) : id(id), symbol(symbol) { }
 };
 
 struct EventOrderMarketPayload : public MessagePayload {
 	MarketOrder order;
+	SymbolId symbol;
 
-	EventOrderMarketPayload(const MarketOrder& order) : order(order) { }
+	EventOrderMarketPayload(const MarketOrder& order, SymbolId symbol = 0) : order(order), symbol(symbol) { }
 };
 
 struct EventOrderLimitPayload : public MessagePayload {
 	LimitOrder order;
+	SymbolId symbol;
 
-	EventOrderLimitPayload(const LimitOrder& order) : order(order) { }
+	EventOrderLimitPayload(const LimitOrder& order, SymbolId symbol = 0) : order(order), symbol(symbol) { }
 };
 
 struct EventTradePayload : public MessagePayload {
 	Trade trade;
+	SymbolId symbol;
+
+	EventTradePayload(const Trade& trade, SymbolId symbol = 0) : trade(trade), symbol(symbol) { }
+};
+
+// sent to the owner of an order on either side of the trade, only if the owner subscribed to the execution reports
+struct EventExecutionPayload : public MessagePayload {
+	Trade trade;
+	OrderID id; // the order of the owner, the aggressing or the resting one
+	SymbolId symbol;
 
-	EventTradePayload(const Trade& trade) : trade(trade) { }
+	EventExecutionPayload(const Trade& trade, OrderID id, SymbolId symbol = 0) : trade(trade), id(id), symbol(symbol) { }
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Message.h"
+
+#include <cstddef>
+#include <vector>
+
+// How the messages arriving at the same time are ordered. By deliveredBefore, which does not depend on when a message from another
+// partition was handed over, so that a simulation delivers the same whether it runs in parallel or not; a sequential simulation
+// can keep them in the order they were pushed instead.
+enum class MessageTieOrder {
+	Push,
+	Delivery
+};
+
+class IMessageQueue {
+public:
+	virtual ~IMessageQueue() = default;
+
+	// messages are popped by their arrival, the ties broken by the tie order of the queue
+	virtual void push(const MessagePtr& messagePtr) = 0;
+	virtual const MessagePtr& top() = 0;
+	virtual void pop() = 0;
+
+	virtual bool empty() const = 0;
+	virtual size_t size() const = 0;
+
+	// the queued messages, e.g. for a snapshot; in no particular order but for the ones arriving together, which come in the order they are delivered
+	virtual std::vector<MessagePtr> messages() const = 0;
+protected:
+	IMessageQueue() = default;
+};
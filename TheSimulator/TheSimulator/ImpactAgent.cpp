@@ -5,10 +5,10 @@
 #include "ParameterStorage.h"
 
 ImpactAgent::ImpactAgent(const Simulation* simulation)
-	: Agent(simulation), m_impactTime(0), m_impactSide("ask"), m_greed(0.0) {}
+	: Agent(simulation), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_impactTime(0), m_impactSide("ask"), m_greed(0.0) {}
 
 ImpactAgent::ImpactAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name), m_impactTime(0), m_impactSide("ask"), m_greed(0.0) { }
+	: Agent(simulation, name), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_impactTime(0), m_impactSide("ask"), m_greed(0.0) { }
 
 void ImpactAgent::configure(const pugi::xml_node& node, const std::string& configurationPath) {
 	Agent::configure(node, configurationPath);
@@ -18,6 +18,10 @@ void ImpactAgent::configure(const pugi::xml_node& node, const std::string& confi
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
 
+	if (!(att = node.attribute("symbol")).empty()) {
+		m_symbol = (SymbolId)std::stoul(simulation()->parameters().processString(att.as_string()));
+	}
+
 	if (!(att = node.attribute("greed")).empty()) {
 		m_greed = std::stod(simulation()->parameters().processString(att.as_string()));
 	}
@@ -34,19 +38,37 @@ void ImpactAgent::configure(const pugi::xml_node& node, const std::string& confi
 	}
 }
 
+void ImpactAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
+}
+
+const MessageDispatchTable<ImpactAgent> ImpactAgent::s_dispatchTable = MessageDispatchTable<ImpactAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &ImpactAgent::handleSimulationStart)
+	.on(MESSAGETYPE_WAKEUP_FOR_IMPACT, &ImpactAgent::handleWakeupForImpact)
+	.on(MESSAGETYPE_RESPONSE_RETRIEVE_L1, &ImpactAgent::handleRetrieveL1Response);
+
 void ImpactAgent::receiveMessage(const MessagePtr& msg) {
+	s_dispatchTable.dispatch(this, msg);
+}
+
+void ImpactAgent::handleSimulationStart(const MessagePtr& msg) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-	if (msg->type == "EVENT_SIMULATION_START") {
-		simulation()->dispatchMessage(currentTimestamp, m_impactTime - currentTimestamp, name(), name(), "WAKEUP_FOR_IMPACT", std::make_shared<EmptyPayload>());
-	} else if (msg->type == "WAKEUP_FOR_IMPACT") {
-		simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "RETRIEVE_L1", std::make_shared<EmptyPayload>());
-	} else if (msg->type == "RESPONSE_RETRIEVE_L1") {
-		auto pptr = std::dynamic_pointer_cast<RetrieveL1ResponsePayload>(msg->payload);
-		Volume relevantSideVolume = m_impactSide == "bid" ? pptr->bidTotalVolume : pptr->askTotalVolume;
-		Volume amountToTrade = (Volume)std::floor(m_greed * relevantSideVolume);
-
-		auto marketpayload = std::make_shared<PlaceOrderMarketPayload>(m_impactSide == "bid" ? OrderDirection::Sell : OrderDirection::Buy, amountToTrade);
-		simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "PLACE_ORDER_MARKET", marketpayload);
-	}
+	simulation()->dispatchMessage(currentTimestamp, m_impactTime - currentTimestamp, id(), id(), MESSAGETYPE_WAKEUP_FOR_IMPACT);
+}
+
+void ImpactAgent::handleWakeupForImpact(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_RETRIEVE_L1, RetrieveL1Payload(m_symbol));
+}
+
+void ImpactAgent::handleRetrieveL1Response(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	const auto& payload = std::get<RetrieveL1ResponsePayload>(msg->payload);
+	Volume relevantSideVolume = m_impactSide == "bid" ? payload.bidTotalVolume : payload.askTotalVolume;
+	Volume amountToTrade = (Volume)std::floor(m_greed * relevantSideVolume);
+
+	simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_MARKET, PlaceOrderMarketPayload(m_impactSide == "bid" ? OrderDirection::Sell : OrderDirection::Buy, amountToTrade, m_symbol));
 }
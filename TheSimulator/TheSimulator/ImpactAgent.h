@@ -1,5 +1,7 @@
 #pragma once
 #include "Agent.h"
+#include "MessageDispatchTable.h"
+#include "SymbolId.h"
 
 #include <memory>
 #include <fstream>
@@ -14,8 +16,17 @@ public:
 
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<ImpactAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& msg);
+	void handleWakeupForImpact(const MessagePtr& msg);
+	void handleRetrieveL1Response(const MessagePtr& msg);
+
 	std::string m_exchange;
+	AgentId m_exchangeId;
+	SymbolId m_symbol; // of the book on the exchange
 
 	double m_greed;
 	Timestamp m_impactTime;
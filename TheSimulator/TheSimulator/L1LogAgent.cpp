@@ -2,46 +2,71 @@
 
 #include "Simulation.h"
 #include "ExchangeAgentMessagePayloads.h"
+#include "Snapshot.h"
+
+#include <filesystem>
+#include <vector>
 
 #include <iostream>
 
 L1LogAgent::L1LogAgent(const Simulation* simulation)
-	: Agent(simulation), m_outputFile(), m_mostRecentPayload(nullptr), m_aggregationPeriod(0) { }
+	: Agent(simulation), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_outputPath(), m_outputFile(), m_mostRecentPayload(), m_aggregationPeriod(0) { }
 
 L1LogAgent::L1LogAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name), m_outputFile(), m_mostRecentPayload(nullptr), m_aggregationPeriod(0) { }
+	: Agent(simulation, name), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_outputPath(), m_outputFile(), m_mostRecentPayload(), m_aggregationPeriod(0) { }
+
+const MessageDispatchTable<L1LogAgent> L1LogAgent::s_dispatchTable = MessageDispatchTable<L1LogAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &L1LogAgent::handleSimulationStart)
+	.on(MESSAGETYPE_EVENT_ORDER_LIMIT, &L1LogAgent::handleL1Refresh)
+	.on(MESSAGETYPE_EVENT_ORDER_MARKET, &L1LogAgent::handleL1Refresh)
+	.on(MESSAGETYPE_WAKEUP_FOR_AGGREGATION, &L1LogAgent::handleL1Refresh)
+	.on(MESSAGETYPE_RESPONSE_RETRIEVE_L1, &L1LogAgent::handleRetrieveL1Response);
 
 void L1LogAgent::receiveMessage(const MessagePtr& messagePtr) {
+	s_dispatchTable.dispatch(this, messagePtr);
+}
+
+void L1LogAgent::handleSimulationStart(const MessagePtr& messagePtr) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-	if (messagePtr->type == "EVENT_SIMULATION_START") {
-		if(!m_aggregationPeriod) {
-			simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "SUBSCRIBE_EVENT_ORDER_LIMIT", std::make_shared<EmptyPayload>());
-			simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "SUBSCRIBE_EVENT_ORDER_MARKET", std::make_shared<EmptyPayload>());
-		} else {
-			Timestamp nextAggregation = computeNextAggregation(currentTimestamp);
-			simulation()->dispatchMessage(currentTimestamp, nextAggregation - currentTimestamp, name(), name(), "WAKEUP_FOR_AGGREGATION", std::make_shared<EmptyPayload>());
-		}
-	} else if (messagePtr->type == "EVENT_ORDER_LIMIT" || messagePtr->type == "EVENT_ORDER_MARKET" || messagePtr->type == "WAKEUP_FOR_AGGREGATION") {
-		simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "RETRIEVE_L1", std::make_shared<EmptyPayload>());
-	} else if (messagePtr->type == "RESPONSE_RETRIEVE_L1") {
-		auto pptr = std::dynamic_pointer_cast<RetrieveL1ResponsePayload>(messagePtr->payload);
-
-		if(!m_aggregationPeriod) {
-			if (m_mostRecentPayload != nullptr) {
-				if (pptr->bestAskPrice != m_mostRecentPayload->bestAskPrice || pptr->bestBidPrice != m_mostRecentPayload->bestBidPrice) {
-					logData(pptr);
-					m_mostRecentPayload = pptr;
-				}
-			} else {
-				m_mostRecentPayload = pptr;
+	if (!m_outputPath.empty()) {
+		m_outputFile.open(m_outputPath);
+	}
+
+	if(!m_aggregationPeriod) {
+		simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_LIMIT, SubscribeEventPayload(m_symbol));
+		simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_MARKET, SubscribeEventPayload(m_symbol));
+	} else {
+		Timestamp nextAggregation = computeNextAggregation(currentTimestamp);
+		simulation()->dispatchMessage(currentTimestamp, nextAggregation - currentTimestamp, id(), id(), MESSAGETYPE_WAKEUP_FOR_AGGREGATION);
+	}
+}
+
+void L1LogAgent::handleL1Refresh(const MessagePtr& messagePtr) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_RETRIEVE_L1, RetrieveL1Payload(m_symbol));
+}
+
+void L1LogAgent::handleRetrieveL1Response(const MessagePtr& messagePtr) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	const auto& payload = std::get<RetrieveL1ResponsePayload>(messagePtr->payload);
+
+	if(!m_aggregationPeriod) {
+		if (m_mostRecentPayload.has_value()) {
+			if (payload.bestAskPrice != m_mostRecentPayload->bestAskPrice || payload.bestBidPrice != m_mostRecentPayload->bestBidPrice) {
+				logData(payload);
+				m_mostRecentPayload = payload;
 			}
 		} else {
-			logData(pptr);
-			
-			Timestamp nextAggregation = computeNextAggregation(currentTimestamp);
-			simulation()->dispatchMessage(currentTimestamp, nextAggregation - currentTimestamp, name(), name(), "WAKEUP_FOR_AGGREGATION", std::make_shared<EmptyPayload>());
+			m_mostRecentPayload = payload;
 		}
+	} else {
+		logData(payload);
+		
+		Timestamp nextAggregation = computeNextAggregation(currentTimestamp);
+		simulation()->dispatchMessage(currentTimestamp, nextAggregation - currentTimestamp, id(), id(), MESSAGETYPE_WAKEUP_FOR_AGGREGATION);
 	}
 }
 
@@ -57,9 +82,9 @@ Timestamp L1LogAgent::computeNextAggregation(Timestamp current) const {
 	return nextAggregation;
 }
 
-void L1LogAgent::logData(std::shared_ptr<RetrieveL1ResponsePayload> pptr) {
-	m_outputFile << std::to_string(pptr->time) << "," << pptr->bestBidPrice.toCentString() << "," << pptr->bestAskPrice.toCentString() << std::endl;
-	// std::cout << std::to_string(pptr->time) << ": BID " << pptr->bestBidPrice.toCentString() << " ASK " << pptr->bestAskPrice.toCentString() << " SPREAD " << ((Money)(pptr->bestAskPrice - pptr->bestBidPrice)).toCentString() << std::endl;
+void L1LogAgent::logData(const RetrieveL1ResponsePayload& payload) {
+	m_outputFile << std::to_string(payload.time) << "," << payload.bestBidPrice.toCentString() << "," << payload.bestAskPrice.toCentString() << std::endl;
+	// std::cout << std::to_string(payload.time) << ": BID " << payload.bestBidPrice.toCentString() << " ASK " << payload.bestAskPrice.toCentString() << " SPREAD " << ((Money)(payload.bestAskPrice - payload.bestBidPrice)).toCentString() << std::endl;
 }
 
 #include "ParameterStorage.h"
@@ -72,11 +97,62 @@ void L1LogAgent::configure(const pugi::xml_node& node, const std::string& config
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
 
+	if (!(att = node.attribute("symbol")).empty()) {
+		m_symbol = (SymbolId)std::stoul(simulation()->parameters().processString(att.as_string()));
+	}
+
 	if (!(att = node.attribute("outputFile")).empty()) {
-		m_outputFile.open(simulation()->parameters().processString(att.as_string()));
+		m_outputPath = simulation()->parameters().processString(att.as_string());
 	}
 
 	if (!(att = node.attribute("aggregationPeriod")).empty()) {
 		m_aggregationPeriod = att.as_ullong();
 	}
-}
\ No newline at end of file
+}
+
+void L1LogAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
+}
+
+void L1LogAgent::saveState(SnapshotWriter& writer) {
+	writer.write(m_mostRecentPayload.has_value());
+	if (m_mostRecentPayload.has_value()) {
+		writer.writePayload(*m_mostRecentPayload);
+	}
+
+	// the length of the output so far, a run resumed from the snapshot drops whatever got written after it was taken
+	writer.write(m_outputFile.is_open());
+	if (m_outputFile.is_open()) {
+		m_outputFile.flush();
+		writer.writeString(m_outputPath);
+		writer.write((std::uint64_t)m_outputFile.tellp());
+	}
+}
+
+void L1LogAgent::loadState(SnapshotReader& reader) {
+	m_mostRecentPayload.reset();
+	if (reader.read<bool>()) {
+		m_mostRecentPayload = std::get<RetrieveL1ResponsePayload>(reader.readPayload());
+	}
+
+	if (reader.read<bool>()) {
+		const std::string savedOutputPath = reader.readString();
+		const std::uint64_t outputLength = reader.read<std::uint64_t>();
+		if (!m_outputPath.empty()) {
+			std::error_code error;
+			const std::uintmax_t existingLength = std::filesystem::file_size(m_outputPath, error);
+			if (m_outputPath == savedOutputPath && !error && existingLength >= outputLength) {
+				std::filesystem::resize_file(m_outputPath, outputLength);
+				m_outputFile.open(m_outputPath, std::ios::app);
+			} else {
+				// a run forked off into a file of its own starts it with the output written before the snapshot, as far as it is still there
+				std::vector<char> output(outputLength);
+				std::ifstream savedOutput(savedOutputPath, std::ios::binary);
+				savedOutput.read(output.data(), output.size());
+
+				m_outputFile.open(m_outputPath);
+				m_outputFile.write(output.data(), savedOutput.gcount());
+			}
+		}
+	}
+}
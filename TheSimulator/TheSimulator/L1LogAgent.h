@@ -1,8 +1,10 @@
 #pragma once
 #include "Agent.h"
+#include "MessageDispatchTable.h"
+#include "SymbolId.h"
 
-#include <memory>
 #include <fstream>
+#include <optional>
 #include "ExchangeAgentMessagePayloads.h"
 
 class L1LogAgent : public Agent {
@@ -12,14 +14,27 @@ public:
 
 	void configure(const pugi::xml_node& node, const std::string& configurationPath);
 
+	void saveState(SnapshotWriter& writer) override;
+	void loadState(SnapshotReader& reader) override;
+
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<L1LogAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& messagePtr);
+	void handleL1Refresh(const MessagePtr& messagePtr);
+	void handleRetrieveL1Response(const MessagePtr& messagePtr);
+
 	std::string m_exchange;
+	AgentId m_exchangeId;
+	SymbolId m_symbol; // of the book on the exchange
 
-	std::shared_ptr<RetrieveL1ResponsePayload> m_mostRecentPayload;
-	std::ofstream m_outputFile;
+	std::optional<RetrieveL1ResponsePayload> m_mostRecentPayload;
+	std::string m_outputPath;
+	std::ofstream m_outputFile; // opened once the simulation starts, so that loading a snapshot can resume the file instead of truncating it
 	Timestamp m_aggregationPeriod;
 	Timestamp computeNextAggregation(Timestamp current) const;
-	void logData(std::shared_ptr<RetrieveL1ResponsePayload> l1data);
+	void logData(const RetrieveL1ResponsePayload& l1data);
 };
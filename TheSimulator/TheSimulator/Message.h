@@ -1,33 +1,108 @@
 #pragma once
 
 #include "Timestamp.h"
+#include "AgentId.h"
+#include "MessageType.h"
 #include <string>
 #include <vector>
 
-#include "split.h"
 #include <memory>
+#include <utility>
 
-#include "MessagePayload.h"
+#include "MessagePayloadVariant.h"
+
+class MessagePool;
+class MessagePtr;
 
 struct Message {
 public:
-	Message(Timestamp occurrence, Timestamp arrival, const std::string& source, const std::string& target, const std::string& type, MessagePayloadPtr payload)
-		: occurrence(occurrence), arrival(arrival), source(source), type(type), payload(payload) {
-		this->targets = std::move(split(target, '|'));
-	}
+	Message(Timestamp occurrence, Timestamp arrival, AgentId source, AgentId target, MessageType type, MessagePayloadVariant payload)
+		: occurrence(occurrence), arrival(arrival), source(source), sequence(0), targets(1, target), type(type), payload(std::move(payload)), m_referenceCount(0), m_pool(nullptr) { }
+
+	Message(Timestamp occurrence, Timestamp arrival, AgentId source, const std::vector<AgentId>& targets, MessageType type, MessagePayloadVariant payload)
+		: occurrence(occurrence), arrival(arrival), source(source), sequence(0), targets(targets), type(type), payload(std::move(payload)), m_referenceCount(0), m_pool(nullptr) { }
 
-	Message(Timestamp occurrence, Timestamp arrival, const std::string& source, const std::vector<std::string>& targets, const std::string& type, MessagePayloadPtr payload)
-		: occurrence(occurrence), arrival(arrival), source(source), targets(targets), type(type), payload(payload) { }
-	
 	~Message() = default;
 
 	Timestamp occurrence;
 	Timestamp arrival;
 
-	std::string source;
-	std::vector<std::string> targets;
-	std::string type;
+	AgentId source;
+	unsigned long long sequence; // the number of messages the source dispatched before this one
+	std::vector<AgentId> targets;
+	MessageType type;
+
+	MessagePayloadVariant payload;
+private:
+	Message() : occurrence(0), arrival(0), source(AGENTID_INVALID), sequence(0), targets(), type(MESSAGETYPE_INVALID), payload(), m_referenceCount(0), m_pool(nullptr) { }
+
+	// the count is not atomic, a message never leaves the thread of the simulation that created it
+	unsigned int m_referenceCount;
+	MessagePool* m_pool;
+
+	// hands the message back to its pool, or deletes it if it was allocated on its own
+	void recycle();
 
-	MessagePayloadPtr payload;
+	friend class MessagePool;
+	friend class MessagePtr;
 };
-using MessagePtr = std::shared_ptr<Message>;
\ No newline at end of file
+
+// The order of delivery: by arrival, then by occurrence, then by source, and among the messages of one source in the order they were dispatched.
+// It depends on nothing but the messages themselves, so the partitions of a parallel simulation deliver in the same order however their threads interleave.
+inline bool deliveredBefore(const Message& a, const Message& b) {
+	if (a.arrival != b.arrival) {
+		return a.arrival < b.arrival;
+	}
+	if (a.occurrence != b.occurrence) {
+		return a.occurrence < b.occurrence;
+	}
+	if (a.source != b.source) {
+		return a.source < b.source;
+	}
+	return a.sequence < b.sequence;
+}
+
+// An intrusively reference-counted handle to a Message; the last handle to go away returns the message to its pool.
+class MessagePtr {
+public:
+	MessagePtr() : m_message(nullptr) { }
+	MessagePtr(std::nullptr_t) : m_message(nullptr) { }
+	explicit MessagePtr(Message* message) : m_message(message) { acquire(); }
+
+	MessagePtr(const MessagePtr& other) : m_message(other.m_message) { acquire(); }
+	MessagePtr(MessagePtr&& other) noexcept : m_message(other.m_message) { other.m_message = nullptr; }
+	~MessagePtr() { release(); }
+
+	MessagePtr& operator=(const MessagePtr& other) {
+		MessagePtr(other).swap(*this);
+		return *this;
+	}
+	MessagePtr& operator=(MessagePtr&& other) noexcept {
+		MessagePtr(std::move(other)).swap(*this);
+		return *this;
+	}
+
+	void reset() { release(); m_message = nullptr; }
+	void swap(MessagePtr& other) noexcept { std::swap(m_message, other.m_message); }
+
+	Message* get() const { return m_message; }
+	Message& operator*() const { return *m_message; }
+	Message* operator->() const { return m_message; }
+	explicit operator bool() const { return m_message != nullptr; }
+
+	bool operator==(const MessagePtr& other) const { return m_message == other.m_message; }
+	bool operator!=(const MessagePtr& other) const { return m_message != other.m_message; }
+private:
+	Message* m_message;
+
+	void acquire() {
+		if (m_message != nullptr) {
+			++m_message->m_referenceCount;
+		}
+	}
+	void release() {
+		if (m_message != nullptr && --m_message->m_referenceCount == 0) {
+			m_message->recycle();
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Message.h"
+
+#include <vector>
+
+// Maps the message types an agent reacts to onto its handler methods. Each agent class keeps a single
+// static table, built once with chained on() calls, so delivering a message is a bounds check and an indexed call.
+template <class T>
+class MessageDispatchTable {
+public:
+	using Handler = void (T::*)(const MessagePtr&);
+
+	MessageDispatchTable() : m_handlers() { }
+
+	MessageDispatchTable& on(MessageType type, Handler handler) {
+		if (type >= m_handlers.size()) {
+			m_handlers.resize(type + 1, nullptr);
+		}
+		m_handlers[type] = handler;
+
+		return *this;
+	}
+
+	bool handles(MessageType type) const { return type < m_handlers.size() && m_handlers[type] != nullptr; }
+
+	// returns false if the agent has no handler for the type of the message
+	bool dispatch(T* agent, const MessagePtr& msg) const {
+		if (!handles(msg->type)) {
+			return false;
+		}
+
+		(agent->*m_handlers[msg->type])(msg);
+		return true;
+	}
+private:
+	std::vector<Handler> m_handlers;
+};
@@ -0,0 +1,56 @@
+#include "MessagePayloadVariant.h"
+
+template <class T>
+static bool tryConvert(const MessagePayloadPtr& payloadPtr, MessagePayloadVariant& converted) {
+	const T* payload = dynamic_cast<const T*>(payloadPtr.get());
+	if (payload == nullptr) {
+		return false;
+	}
+
+	converted.emplace<T>(*payload);
+	return true;
+}
+
+template <class... Ts>
+static bool tryConvertAny(const MessagePayloadPtr& payloadPtr, MessagePayloadVariant& converted) {
+	return (tryConvert<Ts>(payloadPtr, converted) || ...);
+}
+
+MessagePayloadVariant toMessagePayloadVariant(const MessagePayloadPtr& payloadPtr) {
+	if (payloadPtr == nullptr || dynamic_cast<const EmptyPayload*>(payloadPtr.get()) != nullptr) {
+		return std::monostate();
+	}
+
+	// only taken for the messages dispatched from Python, so the chain of casts is not a concern
+	MessagePayloadVariant converted;
+	if (tryConvertAny<
+		ErrorResponsePayload,
+		SuccessResponsePayload,
+		PlaceOrderMarketPayload,
+		PlaceOrderMarketResponsePayload,
+		PlaceOrderLimitPayload,
+		PlaceOrderLimitResponsePayload,
+		PlaceOrderStopPayload,
+		PlaceOrderStopResponsePayload,
+		RetrieveOrdersPayload,
+		RetrieveOrdersResponsePayload,
+		CancelOrdersPayload,
+		AmendOrdersPayload,
+		ReplaceOrdersPayload,
+		ReplaceOrdersResponsePayload,
+		RetrieveBookPayload,
+		RetrieveBookResponsePayload,
+		RetrieveL1Payload,
+		RetrieveL1ResponsePayload,
+		SubscribeEventPayload,
+		SubscribeEventTradeByOrderPayload,
+		EventOrderMarketPayload,
+		EventOrderLimitPayload,
+		EventTradePayload,
+		EventExecutionPayload
+	>(payloadPtr, converted)) {
+		return converted;
+	}
+
+	return payloadPtr;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "MessagePayload.h"
+#include "ExchangeAgentMessagePayloads.h"
+
+#include <variant>
+
+// The payloads of the built-in message types live inline in the Message and are read back with std::get,
+// messages without a payload (wakeups, subscriptions to every symbol, L1 requests about the symbol 0) hold std::monostate.
+// Any other payload, e.g. the ones created by the Python agents or specific to a single agent, goes through the shared pointer at the end.
+using MessagePayloadVariant = std::variant<
+	std::monostate,
+	ErrorResponsePayload,
+	SuccessResponsePayload,
+	PlaceOrderMarketPayload,
+	PlaceOrderMarketResponsePayload,
+	PlaceOrderLimitPayload,
+	PlaceOrderLimitResponsePayload,
+	PlaceOrderStopPayload,
+	PlaceOrderStopResponsePayload,
+	RetrieveOrdersPayload,
+	RetrieveOrdersResponsePayload,
+	CancelOrdersPayload,
+	AmendOrdersPayload,
+	ReplaceOrdersPayload,
+	ReplaceOrdersResponsePayload,
+	RetrieveBookPayload,
+	RetrieveBookResponsePayload,
+	RetrieveL1Payload,
+	RetrieveL1ResponsePayload,
+	SubscribeEventPayload,
+	SubscribeEventTradeByOrderPayload,
+	EventOrderMarketPayload,
+	EventOrderLimitPayload,
+	EventTradePayload,
+	EventExecutionPayload,
+	MessagePayloadPtr
+>;
+
+// Moves a payload created outside of C++ into its inline form where the variant has one, otherwise keeps the pointer.
+MessagePayloadVariant toMessagePayloadVariant(const MessagePayloadPtr& payloadPtr);
@@ -0,0 +1,65 @@
+#include "MessagePool.h"
+
+#include <type_traits>
+
+void Message::recycle() {
+	if (m_pool != nullptr) {
+		m_pool->release(this);
+	} else {
+		delete this;
+	}
+}
+
+MessagePool::MessagePool(size_t slabSize)
+	: m_slabSize(slabSize > 0 ? slabSize : 1), m_slabs(), m_free() { }
+
+MessagePtr MessagePool::acquire(Timestamp occurrence, Timestamp arrival, AgentId source, AgentId target, MessageType type, MessagePayloadVariant payload) {
+	Message* message = allocate(occurrence, arrival, source, type, std::move(payload));
+	message->targets.push_back(target);
+	return MessagePtr(message);
+}
+
+MessagePtr MessagePool::acquire(Timestamp occurrence, Timestamp arrival, AgentId source, const std::vector<AgentId>& targets, MessageType type, MessagePayloadVariant payload) {
+	Message* message = allocate(occurrence, arrival, source, type, std::move(payload));
+	message->targets.assign(targets.begin(), targets.end());
+	return MessagePtr(message);
+}
+
+MessagePtr MessagePool::acquireCopy(const Message& message, const std::vector<AgentId>& targets) {
+	Message* copy = allocate(message.occurrence, message.arrival, message.source, message.type, MessagePayloadVariant(message.payload));
+	copy->sequence = message.sequence;
+	copy->targets.assign(targets.begin(), targets.end());
+	return MessagePtr(copy);
+}
+
+Message* MessagePool::allocate(Timestamp occurrence, Timestamp arrival, AgentId source, MessageType type, MessagePayloadVariant&& payload) {
+	if (m_free.empty()) {
+		std::unique_ptr<Message[]> slab(new Message[m_slabSize]);
+		m_free.reserve(capacity() + m_slabSize);
+		for (size_t i = m_slabSize; i > 0; --i) {
+			slab[i - 1].m_pool = this;
+			m_free.push_back(&slab[i - 1]);
+		}
+		m_slabs.push_back(std::move(slab));
+	}
+
+	Message* message = m_free.back();
+	m_free.pop_back();
+
+	message->occurrence = occurrence;
+	message->arrival = arrival;
+	message->source = source;
+	message->sequence = 0;
+	message->type = type;
+	// the payload of a free message is always empty, so the new one is constructed in place
+	std::visit([message](auto&& value) {
+		message->payload.emplace<std::decay_t<decltype(value)>>(std::move(value));
+	}, payload);
+	return message;
+}
+
+void MessagePool::release(Message* message) {
+	message->payload.emplace<std::monostate>();
+	message->targets.clear();
+	m_free.push_back(message);
+}
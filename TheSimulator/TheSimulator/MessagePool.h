@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Message.h"
+
+#include <memory>
+#include <vector>
+
+// Hands out Messages carved from fixed-size slabs and takes them back once their last MessagePtr is gone.
+// A recycled message keeps the capacity of its target list, so steady-state dispatching does not touch the allocator.
+// The pool has to outlive every MessagePtr it handed out.
+class MessagePool {
+public:
+	MessagePool(size_t slabSize = DEFAULT_SLAB_SIZE);
+	MessagePool(const MessagePool&) = delete;
+	MessagePool& operator=(const MessagePool&) = delete;
+	~MessagePool() = default;
+
+	MessagePtr acquire(Timestamp occurrence, Timestamp arrival, AgentId source, AgentId target, MessageType type, MessagePayloadVariant payload);
+	MessagePtr acquire(Timestamp occurrence, Timestamp arrival, AgentId source, const std::vector<AgentId>& targets, MessageType type, MessagePayloadVariant payload);
+	// a copy of the message, sequence included, addressed to the given subset of its targets
+	MessagePtr acquireCopy(const Message& message, const std::vector<AgentId>& targets);
+
+	size_t capacity() const { return m_slabs.size() * m_slabSize; }
+	size_t available() const { return m_free.size(); }
+
+	static constexpr size_t DEFAULT_SLAB_SIZE = 1024;
+private:
+	size_t m_slabSize;
+	std::vector<std::unique_ptr<Message[]>> m_slabs;
+	std::vector<Message*> m_free;
+
+	Message* allocate(Timestamp occurrence, Timestamp arrival, AgentId source, MessageType type, MessagePayloadVariant&& payload);
+	void release(Message* message);
+
+	friend struct Message;
+};
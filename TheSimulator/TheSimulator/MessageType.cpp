@@ -0,0 +1,170 @@
+#include "MessageType.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "SimulationException.h"
+
+static const char* const BUILTIN_MESSAGETYPE_NAMES[] = {
+	"EVENT_SIMULATION_START",
+	"EVENT_SIMULATION_STOP",
+
+	"PLACE_ORDER_MARKET",
+	"RESPONSE_PLACE_ORDER_MARKET",
+	"PLACE_ORDER_LIMIT",
+	"RESPONSE_PLACE_ORDER_LIMIT",
+	"PLACE_ORDER_STOP",
+	"RESPONSE_PLACE_ORDER_STOP",
+	"RETRIEVE_ORDERS",
+	"RESPONSE_RETRIEVE_ORDERS",
+	"CANCEL_ORDERS",
+	"RESPONSE_CANCEL_ORDERS",
+	"AMEND_ORDERS",
+	"RESPONSE_AMEND_ORDERS",
+	"REPLACE_ORDERS",
+	"RESPONSE_REPLACE_ORDERS",
+	"RETRIEVE_L1",
+	"RESPONSE_RETRIEVE_L1",
+	"RETRIEVE_BOOK_ASK",
+	"RESPONSE_RETRIEVE_BOOK_ASK",
+	"RETRIEVE_BOOK_BID",
+	"RESPONSE_RETRIEVE_BOOK_BID",
+	"SUBSCRIBE_EVENT_ORDER_MARKET",
+	"RESPONSE_SUBSCRIBE_EVENT_ORDER_MARKET",
+	"SUBSCRIBE_EVENT_ORDER_LIMIT",
+	"RESPONSE_SUBSCRIBE_EVENT_ORDER_LIMIT",
+	"SUBSCRIBE_EVENT_TRADE",
+	"RESPONSE_SUBSCRIBE_EVENT_TRADE",
+	"SUBSCRIBE_EVENT_ORDER_TRADE",
+	"RESPONSE_SUBSCRIBE_EVENT_ORDER_TRADE",
+	"SUBSCRIBE_EVENT_EXECUTION",
+	"RESPONSE_SUBSCRIBE_EVENT_EXECUTION",
+
+	"EVENT_ORDER_MARKET",
+	"EVENT_ORDER_LIMIT",
+	"EVENT_TRADE",
+	"EVENT_EXECUTION",
+
+	"WAKEUP_FOR_PLACEMENT",
+	"WAKEUP_FOR_CANCELLATION",
+	"WAKEUP_FOR_MARKETMAKING",
+	"WAKEUP_FOR_AGGREGATION",
+	"WAKEUP_FOR_IMPACT",
+	"WAKEUP_FOR_AUCTION",
+};
+static_assert(sizeof(BUILTIN_MESSAGETYPE_NAMES) / sizeof(BUILTIN_MESSAGETYPE_NAMES[0]) == MESSAGETYPE_BUILTIN_COUNT, "every built-in message type needs a name");
+
+namespace {
+
+// The built-in part is immutable once constructed and is read without locking; the simulations running
+// in parallel threads only need the mutex when they touch the types registered at runtime.
+class MessageTypeTable {
+public:
+	static MessageTypeTable& instance() {
+		static MessageTypeTable table;
+		return table;
+	}
+
+	bool tryLookup(const std::string& name, MessageType& type) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_types.find(name);
+		if (it == m_types.end()) {
+			return false;
+		}
+
+		type = it->second;
+		return true;
+	}
+
+	MessageType intern(const std::string& name) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return internLocked(name);
+	}
+
+	const std::string& name(MessageType type) {
+		if (type < MESSAGETYPE_BUILTIN_COUNT) {
+			return m_builtinNames[type];
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (type - MESSAGETYPE_BUILTIN_COUNT >= m_runtimeNames.size()) {
+			throw SimulationException("MessageTypeRegistry::name(): unknown message type " + std::to_string(type));
+		}
+		return m_runtimeNames[type - MESSAGETYPE_BUILTIN_COUNT]; // deque elements do not move as it grows
+	}
+
+	MessageType responseType(MessageType type) {
+		if (type < MESSAGETYPE_BUILTIN_COUNT && m_builtinResponseTypes[type] != MESSAGETYPE_INVALID) {
+			return m_builtinResponseTypes[type];
+		}
+
+		const std::string& typeName = name(type);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_runtimeResponseTypes.find(type);
+		if (it == m_runtimeResponseTypes.end()) {
+			it = m_runtimeResponseTypes.emplace(type, internLocked("RESPONSE_" + typeName)).first;
+		}
+		return it->second;
+	}
+private:
+	MessageTypeTable() {
+		m_builtinNames.reserve(MESSAGETYPE_BUILTIN_COUNT);
+		for (MessageType type = 0; type < MESSAGETYPE_BUILTIN_COUNT; ++type) {
+			m_builtinNames.emplace_back(BUILTIN_MESSAGETYPE_NAMES[type]);
+			m_types.emplace(m_builtinNames.back(), type);
+		}
+
+		m_builtinResponseTypes.resize(MESSAGETYPE_BUILTIN_COUNT, MESSAGETYPE_INVALID);
+		for (MessageType type = 0; type < MESSAGETYPE_BUILTIN_COUNT; ++type) {
+			auto it = m_types.find("RESPONSE_" + m_builtinNames[type]);
+			if (it != m_types.end()) {
+				m_builtinResponseTypes[type] = it->second;
+			}
+		}
+	}
+
+	MessageType internLocked(const std::string& name) {
+		auto it = m_types.find(name);
+		if (it != m_types.end()) {
+			return it->second;
+		}
+
+		const MessageType type = MESSAGETYPE_BUILTIN_COUNT + (MessageType)m_runtimeNames.size();
+		m_runtimeNames.push_back(name);
+		m_types.emplace(name, type);
+		return type;
+	}
+
+	std::vector<std::string> m_builtinNames;
+	std::vector<MessageType> m_builtinResponseTypes;
+
+	std::mutex m_mutex;
+	std::unordered_map<std::string, MessageType> m_types;
+	std::deque<std::string> m_runtimeNames;
+	std::unordered_map<MessageType, MessageType> m_runtimeResponseTypes;
+};
+
+}
+
+MessageType MessageTypeRegistry::lookup(const std::string& name) {
+	MessageType type;
+	if (!MessageTypeTable::instance().tryLookup(name, type)) {
+		throw SimulationException("MessageTypeRegistry::lookup(): unknown message type '" + name + "'");
+	}
+	return type;
+}
+
+MessageType MessageTypeRegistry::intern(const std::string& name) {
+	return MessageTypeTable::instance().intern(name);
+}
+
+const std::string& MessageTypeRegistry::name(MessageType type) {
+	return MessageTypeTable::instance().name(type);
+}
+
+MessageType MessageTypeRegistry::responseType(MessageType type) {
+	return MessageTypeTable::instance().responseType(type);
+}
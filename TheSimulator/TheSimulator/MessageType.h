@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+
+using MessageType = unsigned int;
+
+// The message types known to the C++ agents; the names in MessageType.cpp follow the same order.
+enum : MessageType {
+	MESSAGETYPE_EVENT_SIMULATION_START,
+	MESSAGETYPE_EVENT_SIMULATION_STOP,
+
+	MESSAGETYPE_PLACE_ORDER_MARKET,
+	MESSAGETYPE_RESPONSE_PLACE_ORDER_MARKET,
+	MESSAGETYPE_PLACE_ORDER_LIMIT,
+	MESSAGETYPE_RESPONSE_PLACE_ORDER_LIMIT,
+	MESSAGETYPE_PLACE_ORDER_STOP,
+	MESSAGETYPE_RESPONSE_PLACE_ORDER_STOP,
+	MESSAGETYPE_RETRIEVE_ORDERS,
+	MESSAGETYPE_RESPONSE_RETRIEVE_ORDERS,
+	MESSAGETYPE_CANCEL_ORDERS,
+	MESSAGETYPE_RESPONSE_CANCEL_ORDERS,
+	MESSAGETYPE_AMEND_ORDERS,
+	MESSAGETYPE_RESPONSE_AMEND_ORDERS,
+	MESSAGETYPE_REPLACE_ORDERS,
+	MESSAGETYPE_RESPONSE_REPLACE_ORDERS,
+	MESSAGETYPE_RETRIEVE_L1,
+	MESSAGETYPE_RESPONSE_RETRIEVE_L1,
+	MESSAGETYPE_RETRIEVE_BOOK_ASK,
+	MESSAGETYPE_RESPONSE_RETRIEVE_BOOK_ASK,
+	MESSAGETYPE_RETRIEVE_BOOK_BID,
+	MESSAGETYPE_RESPONSE_RETRIEVE_BOOK_BID,
+	MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_MARKET,
+	MESSAGETYPE_RESPONSE_SUBSCRIBE_EVENT_ORDER_MARKET,
+	MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_LIMIT,
+	MESSAGETYPE_RESPONSE_SUBSCRIBE_EVENT_ORDER_LIMIT,
+	MESSAGETYPE_SUBSCRIBE_EVENT_TRADE,
+	MESSAGETYPE_RESPONSE_SUBSCRIBE_EVENT_TRADE,
+	MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_TRADE,
+	MESSAGETYPE_RESPONSE_SUBSCRIBE_EVENT_ORDER_TRADE,
+	MESSAGETYPE_SUBSCRIBE_EVENT_EXECUTION,
+	MESSAGETYPE_RESPONSE_SUBSCRIBE_EVENT_EXECUTION,
+
+	MESSAGETYPE_EVENT_ORDER_MARKET,
+	MESSAGETYPE_EVENT_ORDER_LIMIT,
+	MESSAGETYPE_EVENT_TRADE,
+	MESSAGETYPE_EVENT_EXECUTION,
+
+	MESSAGETYPE_WAKEUP_FOR_PLACEMENT,
+	MESSAGETYPE_WAKEUP_FOR_CANCELLATION,
+	MESSAGETYPE_WAKEUP_FOR_MARKETMAKING,
+	MESSAGETYPE_WAKEUP_FOR_AGGREGATION,
+	MESSAGETYPE_WAKEUP_FOR_IMPACT,
+	MESSAGETYPE_WAKEUP_FOR_AUCTION,
+
+	MESSAGETYPE_BUILTIN_COUNT
+};
+
+constexpr MessageType MESSAGETYPE_INVALID = (MessageType)-1;
+
+// Maps the message type names onto compact ids. The built-in types are registered up front,
+// the ones introduced by the Python agents get the next free id the first time they are used.
+class MessageTypeRegistry {
+public:
+	// throws for a name that has not been registered
+	static MessageType lookup(const std::string& name);
+	// registers the name if it is not known yet
+	static MessageType intern(const std::string& name);
+
+	static const std::string& name(MessageType type);
+	static MessageType responseType(MessageType type);
+};
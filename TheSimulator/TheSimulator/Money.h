@@ -10,9 +10,12 @@ public:
 	Money(signed long long int wholes, unsigned int cents) : Money(wholes) { setCents(cents); }
 	Money(float val) : Decimal(val) {}
 	Money(double val) : Decimal(val) {}
-	Money(const Money& cpy) : Decimal() { setInternalValue(cpy.internalValue()); }
+	Money(const Money& cpy) = default;
 	Money(const Decimal& cpy) : Decimal(cpy) {} //for amazing convenience
 
+	// the amount nearest to the value, where the constructor floors it
+	static Money nearest(double val) { return Decimal::fromInternalValue((signed long long int)std::llround(val * WHOLE_OFFSET)); }
+
 	void setCents(unsigned int cents);
 	unsigned int cents() const { return (unsigned int)std::abs(fraction() / CENT_OFFSET); }
 	unsigned int roundedCents() const { return cents() + (cents() >= 50 ? 1 : 0); }
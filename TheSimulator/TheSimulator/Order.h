@@ -4,31 +4,30 @@
 #include "Volume.h"
 #include "Money.h"
 
-#include "IHumanPrintable.h"
-#include "ICSVPrintable.h"
-
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 
 using OrderID = unsigned long int;
 constexpr OrderID ORDERID_INVALID = 0;
 
-enum class OrderDirection : unsigned int {
+enum class OrderDirection : std::uint8_t {
 	Buy,
 	Sell
 };
 
-class BasicOrder : public IHumanPrintable, public ICSVPrintable {
+// The orders are plain records, copied around by value in the event payloads; the direction goes last so that it packs
+// in with the narrow volumes, a limit order then takes 32 bytes with MAXE_COMPACT_RECORDS and 40 without.
+class Order {
 public:
 	inline OrderID id() const { return m_id; }
 	inline Timestamp timestamp() const { return m_timestamp;  }
 	inline Volume volume() const { return m_volume; }
-
-	void printHuman() const override;
-	void printCSV() const override;
+	inline OrderDirection direction() const { return m_direction; }
 
 	void removeVolume(Volume decrease) { m_volume -= decrease; }
 protected:
-	BasicOrder(OrderID id, Timestamp timestamp, Volume orderVolume);
+	Order(OrderID id, OrderDirection orderDirection, Timestamp timestamp, Volume orderVolume);
 
 	void setVolume(Volume newVolume) { m_volume = newVolume; }
 
@@ -37,59 +36,36 @@ private:
 	OrderID m_id;
 	Timestamp m_timestamp;
 	Volume m_volume;
-};
-
-class Order : public BasicOrder {
-public:
-	virtual ~Order() = default;
-	inline OrderDirection direction() const { return m_direction; }
-
-	Order(const Order& order);
-	Order(Order&& order);
-
-	void printHuman() const override;
-	void printCSV() const override;
-
-protected:
-	Order(OrderID id, OrderDirection orderDirection, Timestamp timestamp, Volume orderVolume);
-private:
-	const OrderDirection m_direction;
+	OrderDirection m_direction;
 };
 using OrderPtr = std::shared_ptr<Order>;
 
 class MarketOrder : public Order {
-public:
-	MarketOrder(const MarketOrder& order) = default;
-	MarketOrder(MarketOrder&& order) = default;
-
-	void printHuman() const override;
-	void printCSV() const override;
 protected:
 	MarketOrder(OrderID id, OrderDirection direction, Timestamp timestamp, Volume volume);
 
 	friend class OrderFactory;
+	friend class SnapshotReader;
 };
 using MarketOrderPtr = std::shared_ptr<MarketOrder>;
 
 class LimitOrder : public Order {
 public:
-	LimitOrder(const LimitOrder& order) = default;
-	LimitOrder(LimitOrder&& order) = default;
-
 	inline Money price() const { return m_price; };
-
-	void printHuman() const override;
-	void printCSV() const override;
-
-	LimitOrder& operator=(const LimitOrder& _) { 
-		// TODO: WARNING: DANGER: BAD CODE, RETHINK THIS WHOLE HEADER FILE
-		return *this;
-	}
 protected:
 	LimitOrder(OrderID id, OrderDirection direction, Timestamp timestamp, Volume volume, const Money& price);
 
 	friend class OrderFactory;
+	friend class SnapshotReader;
+	friend class OrderPool;
 private:
-	const Money m_price;
+	Money m_price;
  };
-using LimitOrderPtr = std::shared_ptr<LimitOrder>;
\ No newline at end of file
+using LimitOrderPtr = std::shared_ptr<LimitOrder>;
+
+static_assert(std::is_trivially_copyable_v<MarketOrder> && std::is_trivially_copyable_v<LimitOrder>, "the orders are copied as plain records");
+
+void printHuman(const MarketOrder& order);
+void printCSV(const MarketOrder& order);
+void printHuman(const LimitOrder& order);
+void printCSV(const LimitOrder& order);
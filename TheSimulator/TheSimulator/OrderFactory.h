@@ -1,13 +1,14 @@
 #pragma once
 
-#include "IHumanPrintable.h"
-#include "ICSVPrintable.h"
 #include "Order.h"
 
 #include <memory>
 #include <map>
 #include <list>
 
+class SnapshotWriter;
+class SnapshotReader;
+
 class OrderFactory {
 public:
 	OrderFactory();
@@ -17,12 +18,20 @@ public:
 
 	MarketOrderPtr makeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume);
 	LimitOrderPtr makeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price);
+	// an order under an id handed out before, as a stop order keeps the id it was placed with once it triggers
+	MarketOrderPtr makeMarketOrder(OrderID id, OrderDirection direction, Timestamp timestamp, Volume volume);
+	LimitOrderPtr makeLimitOrder(OrderID id, OrderDirection direction, Timestamp timestamp, Volume volume, Money price);
+	// the next id, for an order made later on
+	OrderID makeId() { return ++m_orderCount; }
 
 	// convenience methods
 	MarketOrderPtr marketBuy(Timestamp timestamp, Volume volume);
 	MarketOrderPtr marketSell(Timestamp timestamp, Volume volume);
 	LimitOrderPtr limitBuy(Timestamp timestamp, Volume volume, Money price);
 	LimitOrderPtr limitSell(Timestamp timestamp, Volume volume, Money price);
+
+	void saveState(SnapshotWriter& writer) const;
+	void loadState(SnapshotReader& reader);
 private:
 	OrderID m_orderCount;
 };
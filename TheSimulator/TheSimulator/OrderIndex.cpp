@@ -0,0 +1,100 @@
+#include "OrderIndex.h"
+
+#include <algorithm>
+
+OrderIndex::OrderIndex()
+	: m_pages(), m_firstPage(0), m_sparePages(), m_size(0) { }
+
+OrderHandle OrderIndex::find(OrderID id) const {
+	const OrderID page = id / PAGE_SIZE;
+	if (page < m_firstPage || page - m_firstPage >= m_pages.size()) {
+		return ORDERHANDLE_NONE;
+	}
+
+	const Page* pagePtr = m_pages[page - m_firstPage].get();
+	return pagePtr != nullptr ? pagePtr->handles[id % PAGE_SIZE] : ORDERHANDLE_NONE;
+}
+
+void OrderIndex::insert(OrderID id, OrderHandle handle) {
+	const OrderID page = id / PAGE_SIZE;
+	if (m_pages.empty()) {
+		m_firstPage = page;
+	}
+	for (; page < m_firstPage; --m_firstPage) {
+		m_pages.emplace_front();
+	}
+	while (page - m_firstPage >= m_pages.size()) {
+		m_pages.emplace_back();
+	}
+
+	PagePtr& pagePtr = m_pages[page - m_firstPage];
+	if (pagePtr == nullptr) {
+		pagePtr = makePage();
+	}
+	OrderHandle& slot = pagePtr->handles[id % PAGE_SIZE];
+	if (slot == ORDERHANDLE_NONE) {
+		++pagePtr->count;
+		++m_size;
+	}
+	slot = handle;
+}
+
+void OrderIndex::erase(OrderID id) {
+	OrderHandle* slot = entry(id);
+	if (slot == nullptr || *slot == ORDERHANDLE_NONE) {
+		return;
+	}
+
+	*slot = ORDERHANDLE_NONE;
+	--m_size;
+	PagePtr& pagePtr = m_pages[id / PAGE_SIZE - m_firstPage];
+	if (--pagePtr->count == 0) {
+		m_sparePages.push_back(std::move(pagePtr));
+		trim();
+	}
+}
+
+void OrderIndex::clear() {
+	for (PagePtr& pagePtr : m_pages) {
+		if (pagePtr != nullptr) {
+			m_sparePages.push_back(std::move(pagePtr));
+		}
+	}
+	m_pages.clear();
+	m_firstPage = 0;
+	m_size = 0;
+}
+
+OrderHandle* OrderIndex::entry(OrderID id) {
+	const OrderID page = id / PAGE_SIZE;
+	if (page < m_firstPage || page - m_firstPage >= m_pages.size()) {
+		return nullptr;
+	}
+
+	Page* pagePtr = m_pages[page - m_firstPage].get();
+	return pagePtr != nullptr ? &pagePtr->handles[id % PAGE_SIZE] : nullptr;
+}
+
+OrderIndex::PagePtr OrderIndex::makePage() {
+	PagePtr pagePtr;
+	if (!m_sparePages.empty()) {
+		pagePtr = std::move(m_sparePages.back());
+		m_sparePages.pop_back();
+	} else {
+		pagePtr = std::make_unique<Page>();
+	}
+
+	std::fill(pagePtr->handles.begin(), pagePtr->handles.end(), ORDERHANDLE_NONE);
+	pagePtr->count = 0;
+	return pagePtr;
+}
+
+void OrderIndex::trim() {
+	while (!m_pages.empty() && m_pages.front() == nullptr) {
+		m_pages.pop_front();
+		++m_firstPage;
+	}
+	while (!m_pages.empty() && m_pages.back() == nullptr) {
+		m_pages.pop_back();
+	}
+}
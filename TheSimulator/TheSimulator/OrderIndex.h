@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Order.h"
+#include "OrderPool.h"
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// The resting orders of a book by their ids. The order factory hands the ids out one after the other and the orders resting
+// in the book keep to a band of the recent ones, so the index is a table of pages addressed directly by the id. The pages
+// behind the band are dropped as it moves on, and their storage is reused for the pages ahead of it.
+class OrderIndex {
+public:
+	OrderIndex();
+	OrderIndex(const OrderIndex&) = delete;
+	OrderIndex& operator=(const OrderIndex&) = delete;
+
+	// ORDERHANDLE_NONE unless the order rests in the book
+	OrderHandle find(OrderID id) const;
+	void insert(OrderID id, OrderHandle handle);
+	void erase(OrderID id);
+	void clear();
+
+	size_t size() const { return m_size; }
+
+	static constexpr size_t PAGE_SIZE = 4096;
+private:
+	struct Page {
+		std::array<OrderHandle, PAGE_SIZE> handles;
+		size_t count;
+	};
+	using PagePtr = std::unique_ptr<Page>;
+
+	std::deque<PagePtr> m_pages; // nullptr for the pages without a resting order
+	OrderID m_firstPage; // the number of the page at the front
+	std::vector<PagePtr> m_sparePages;
+	size_t m_size;
+
+	OrderHandle* entry(OrderID id);
+	PagePtr makePage();
+	void trim();
+};
@@ -4,31 +4,42 @@
 #include "ExchangeAgentMessagePayloads.h"
 
 OrderLogAgent::OrderLogAgent(const Simulation* simulation)
-	: Agent(simulation) { }
+	: Agent(simulation), m_exchangeId(AGENTID_INVALID) { }
 
 OrderLogAgent::OrderLogAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name) { }
+	: Agent(simulation, name), m_exchangeId(AGENTID_INVALID) { }
+
+const MessageDispatchTable<OrderLogAgent> OrderLogAgent::s_dispatchTable = MessageDispatchTable<OrderLogAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &OrderLogAgent::handleSimulationStart)
+	.on(MESSAGETYPE_EVENT_ORDER_MARKET, &OrderLogAgent::handleOrderMarketEvent)
+	.on(MESSAGETYPE_EVENT_ORDER_LIMIT, &OrderLogAgent::handleOrderLimitEvent);
 
 void OrderLogAgent::receiveMessage(const MessagePtr& messagePtr) {
+	s_dispatchTable.dispatch(this, messagePtr);
+}
+
+void OrderLogAgent::handleSimulationStart(const MessagePtr& messagePtr) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-	if (messagePtr->type == "EVENT_SIMULATION_START") {
-		simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "SUBSCRIBE_EVENT_ORDER_LIMIT", std::make_shared<EmptyPayload>());
-		simulation()->dispatchMessage(currentTimestamp, 0, name(), m_exchange, "SUBSCRIBE_EVENT_ORDER_MARKET", std::make_shared<EmptyPayload>());
-	} else if (messagePtr->type == "EVENT_ORDER_MARKET") {
-		auto pptr = std::dynamic_pointer_cast<EventOrderMarketPayload>(messagePtr->payload);
-		const auto& order = pptr->order;
-
-		std::cout << name() << ": ";
-		order.printHuman();
-	} else if (messagePtr->type == "EVENT_ORDER_LIMIT") {
-		auto pptr = std::dynamic_pointer_cast<EventOrderLimitPayload>(messagePtr->payload);
-		const auto& order = pptr->order;
-
-		std::cout << name() << ": ";
-		order.printHuman();
-		std::cout << std::endl;
-	}
+	simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_LIMIT);
+	simulation()->dispatchMessage(currentTimestamp, 0, id(), m_exchangeId, MESSAGETYPE_SUBSCRIBE_EVENT_ORDER_MARKET);
+}
+
+void OrderLogAgent::handleOrderMarketEvent(const MessagePtr& messagePtr) {
+	const auto& payload = std::get<EventOrderMarketPayload>(messagePtr->payload);
+	const auto& order = payload.order;
+
+	std::cout << name() << ": ";
+	printHuman(order);
+}
+
+void OrderLogAgent::handleOrderLimitEvent(const MessagePtr& messagePtr) {
+	const auto& payload = std::get<EventOrderLimitPayload>(messagePtr->payload);
+	const auto& order = payload.order;
+
+	std::cout << name() << ": ";
+	printHuman(order);
+	std::cout << std::endl;
 }
 
 #include "ParameterStorage.h"
@@ -40,4 +51,8 @@ void OrderLogAgent::configure(const pugi::xml_node& node, const std::string& con
 	if (!(att = node.attribute("exchange")).empty()) { 
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
+}
+
+void OrderLogAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
 }
\ No newline at end of file
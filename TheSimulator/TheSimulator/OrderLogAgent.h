@@ -1,5 +1,6 @@
 #pragma once
 #include "Agent.h"
+#include "MessageDispatchTable.h"
 
 class OrderLogAgent : public Agent {
 public:
@@ -10,6 +11,14 @@ public:
 
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<OrderLogAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& messagePtr);
+	void handleOrderMarketEvent(const MessagePtr& messagePtr);
+	void handleOrderLimitEvent(const MessagePtr& messagePtr);
+
 	std::string m_exchange;
+	AgentId m_exchangeId;
 };
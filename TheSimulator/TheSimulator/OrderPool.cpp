@@ -0,0 +1,45 @@
+#include "OrderPool.h"
+
+OrderPool::OrderPool(Money tickSize)
+	: m_tickSize(tickSize), m_records(), m_freeHead(ORDERHANDLE_NONE), m_size(0) { }
+
+OrderHandle OrderPool::allocate(const LimitOrder& order, AgentId owner) {
+	OrderHandle handle;
+	if (m_freeHead != ORDERHANDLE_NONE) {
+		handle = m_freeHead;
+		m_freeHead = m_records[handle].next;
+	} else {
+		handle = (OrderHandle)m_records.size();
+		m_records.emplace_back();
+	}
+
+	BookOrder& record = m_records[handle];
+	record.id = order.id();
+	record.timestamp = order.timestamp();
+	record.volume = order.volume();
+	record.price = Price::floorOf(order.price(), m_tickSize);
+	record.direction = order.direction();
+	record.owner = owner;
+	record.previous = ORDERHANDLE_NONE;
+	record.next = ORDERHANDLE_NONE;
+
+	++m_size;
+	return handle;
+}
+
+void OrderPool::release(OrderHandle handle) {
+	m_records[handle].next = m_freeHead;
+	m_freeHead = handle;
+	--m_size;
+}
+
+void OrderPool::clear() {
+	m_records.clear();
+	m_freeHead = ORDERHANDLE_NONE;
+	m_size = 0;
+}
+
+LimitOrderPtr OrderPool::snapshot(OrderHandle handle) const {
+	const BookOrder& record = m_records[handle];
+	return LimitOrderPtr(new LimitOrder(record.id, record.direction, record.timestamp, record.volume, record.price.toMoney(m_tickSize))); // has to be explicit because make_shared can't make use of friendships
+}
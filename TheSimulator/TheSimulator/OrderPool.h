@@ -0,0 +1,51 @@
+#pragma once
+
+#include "AgentId.h"
+#include "Order.h"
+#include "Price.h"
+
+#include <cstdint>
+#include <vector>
+
+using OrderHandle = std::uint32_t;
+constexpr OrderHandle ORDERHANDLE_NONE = (OrderHandle)-1;
+
+// A resting limit order the way the book keeps it: a plain record, linked into the queue of its price level.
+struct BookOrder {
+	OrderID id;
+	Timestamp timestamp;
+	Price price;
+	Volume volume;
+	OrderHandle previous;
+	OrderHandle next; // the next free record while the record is free
+	AgentId owner; // told about the fills of the order
+	OrderDirection direction;
+};
+
+// The slab holding the resting orders of a book. The records are addressed by their index, so that the handles stay valid
+// as the slab grows; the records released are reused first, most recent first. The prices of the records are in the ticks
+// of the book, the orders going in have to be on its grid already.
+class OrderPool {
+public:
+	OrderPool(Money tickSize);
+	OrderPool(const OrderPool&) = delete;
+	OrderPool& operator=(const OrderPool&) = delete;
+
+	OrderHandle allocate(const LimitOrder& order, AgentId owner);
+	void release(OrderHandle handle);
+	void clear();
+
+	BookOrder& operator[](OrderHandle handle) { return m_records[handle]; }
+	const BookOrder& operator[](OrderHandle handle) const { return m_records[handle]; }
+
+	// a copy of the record as a standalone order, for whoever asks the book about it
+	LimitOrderPtr snapshot(OrderHandle handle) const;
+
+	size_t size() const { return m_size; }
+	Money tickSize() const { return m_tickSize; }
+private:
+	Money m_tickSize;
+	std::vector<BookOrder> m_records;
+	OrderHandle m_freeHead;
+	size_t m_size;
+};
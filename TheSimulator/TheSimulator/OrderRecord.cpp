@@ -1,5 +1,6 @@
 #include "OrderFactory.h"
 #include "Order.h"
+#include "Snapshot.h"
 
 OrderFactory::OrderFactory()
 	: m_orderCount(0) { }
@@ -12,17 +13,21 @@ OrderFactory::~OrderFactory() {
 }
 
 MarketOrderPtr OrderFactory::makeMarketOrder(OrderDirection direction, Timestamp timestamp, Volume volume) {
-	++m_orderCount;
+	return makeMarketOrder(makeId(), direction, timestamp, volume);
+}
 
-	MarketOrderPtr op = MarketOrderPtr(new MarketOrder(m_orderCount, direction, timestamp, volume)); // has to be explicit because make_shared can't make use of friendships
+LimitOrderPtr OrderFactory::makeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price) {
+	return makeLimitOrder(makeId(), direction, timestamp, volume, price);
+}
+
+MarketOrderPtr OrderFactory::makeMarketOrder(OrderID id, OrderDirection direction, Timestamp timestamp, Volume volume) {
+	MarketOrderPtr op = MarketOrderPtr(new MarketOrder(id, direction, timestamp, volume)); // has to be explicit because make_shared can't make use of friendships
 
 	return op;
 }
 
-LimitOrderPtr OrderFactory::makeLimitOrder(OrderDirection direction, Timestamp timestamp, Volume volume, Money price) {
-	++m_orderCount;
-
-	LimitOrderPtr op = LimitOrderPtr(new LimitOrder(m_orderCount, direction, timestamp, volume, price)); // has to be explicit because make_shared can't make use of friendships
+LimitOrderPtr OrderFactory::makeLimitOrder(OrderID id, OrderDirection direction, Timestamp timestamp, Volume volume, Money price) {
+	LimitOrderPtr op = LimitOrderPtr(new LimitOrder(id, direction, timestamp, volume, price)); // has to be explicit because make_shared can't make use of friendships
 
 	return op;
 }
@@ -43,4 +48,12 @@ LimitOrderPtr OrderFactory::limitSell(Timestamp timestamp, Volume volume, Money
 	return makeLimitOrder(OrderDirection::Sell, timestamp, volume, price);
 }
 
+void OrderFactory::saveState(SnapshotWriter& writer) const {
+	writer.write(m_orderCount);
+}
+
+void OrderFactory::loadState(SnapshotReader& reader) {
+	m_orderCount = reader.read<OrderID>();
+}
+
 #include <iostream>
\ No newline at end of file
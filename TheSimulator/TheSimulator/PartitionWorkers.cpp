@@ -0,0 +1,75 @@
+#include "PartitionWorkers.h"
+
+PartitionWorkers::PartitionWorkers(size_t partitionCount, Task task)
+	: m_task(std::move(task)), m_threads(), m_errors(partitionCount), m_mutex(), m_windowStarted(), m_windowFinished(), m_window(0), m_pending(0), m_stopping(false) {
+	for (size_t partitionIndex = 1; partitionIndex < partitionCount; ++partitionIndex) {
+		m_threads.emplace_back(&PartitionWorkers::work, this, partitionIndex);
+	}
+}
+
+PartitionWorkers::~PartitionWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_windowStarted.notify_all();
+
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+}
+
+void PartitionWorkers::runWindow() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pending = m_threads.size();
+		++m_window;
+	}
+	m_windowStarted.notify_all();
+
+	runTask(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_windowFinished.wait(lock, [this]() { return m_pending == 0; });
+
+	std::exception_ptr firstError;
+	for (std::exception_ptr& error : m_errors) {
+		if (error != nullptr && firstError == nullptr) {
+			firstError = error;
+		}
+		error = nullptr;
+	}
+	if (firstError != nullptr) {
+		std::rethrow_exception(firstError);
+	}
+}
+
+void PartitionWorkers::work(size_t partitionIndex) {
+	unsigned long long lastWindow = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_windowStarted.wait(lock, [this, lastWindow]() { return m_stopping || m_window != lastWindow; });
+			if (m_stopping) {
+				return;
+			}
+			lastWindow = m_window;
+		}
+
+		runTask(partitionIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_pending;
+		}
+		m_windowFinished.notify_one();
+	}
+}
+
+void PartitionWorkers::runTask(size_t partitionIndex) {
+	try {
+		m_task(partitionIndex);
+	} catch (...) {
+		m_errors[partitionIndex] = std::current_exception();
+	}
+}
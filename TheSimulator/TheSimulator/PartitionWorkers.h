@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs a task for every partition of a simulation, one window at a time. The calling thread takes the partition 0,
+// every other partition gets a thread of its own which lives as long as the workers do.
+// runWindow returns once the tasks of all partitions are done, rethrowing the first exception any of them threw.
+class PartitionWorkers {
+public:
+	using Task = std::function<void(size_t partitionIndex)>;
+
+	PartitionWorkers(size_t partitionCount, Task task);
+	PartitionWorkers(const PartitionWorkers&) = delete;
+	PartitionWorkers& operator=(const PartitionWorkers&) = delete;
+	~PartitionWorkers();
+
+	void runWindow();
+private:
+	Task m_task;
+	std::vector<std::thread> m_threads;
+	std::vector<std::exception_ptr> m_errors;
+
+	std::mutex m_mutex;
+	std::condition_variable m_windowStarted;
+	std::condition_variable m_windowFinished;
+	unsigned long long m_window;
+	size_t m_pending;
+	bool m_stopping;
+
+	void work(size_t partitionIndex);
+	void runTask(size_t partitionIndex);
+};
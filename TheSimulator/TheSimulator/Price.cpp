@@ -0,0 +1,17 @@
+#include "Price.h"
+
+Price Price::floorOf(Money amount, Money tickSize) {
+	const long long tick = tickSize.internalValue();
+	const long long value = amount.internalValue();
+	return Price(value / tick - (value % tick < 0 ? 1 : 0));
+}
+
+Price Price::ceilOf(Money amount, Money tickSize) {
+	const long long tick = tickSize.internalValue();
+	const long long value = amount.internalValue();
+	return Price(value / tick + (value % tick > 0 ? 1 : 0));
+}
+
+Money Price::toMoney(Money tickSize) const {
+	return Decimal::fromInternalValue(m_ticks * tickSize.internalValue());
+}
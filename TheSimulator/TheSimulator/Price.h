@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Money.h"
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+
+// A price in whole ticks of the exchange it is quoted on. Within the book the prices only get compared, offset and hashed,
+// all in integers; the tick size only comes in converting from and to Money, where the orders enter and leave the book.
+class Price {
+public:
+	constexpr Price() : m_ticks(0) { }
+	constexpr explicit Price(long long ticks) : m_ticks(ticks) { }
+
+	constexpr long long ticks() const { return m_ticks; }
+
+	// the price on the grid of the tick size at or below the amount, resp. at or above it
+	static Price floorOf(Money amount, Money tickSize);
+	static Price ceilOf(Money amount, Money tickSize);
+	Money toMoney(Money tickSize) const;
+
+	static constexpr Price lowest() { return Price(std::numeric_limits<long long>::min()); }
+	static constexpr Price highest() { return Price(std::numeric_limits<long long>::max()); }
+
+	constexpr Price operator+(long long ticks) const { return Price(m_ticks + ticks); }
+	constexpr Price operator-(long long ticks) const { return Price(m_ticks - ticks); }
+	constexpr long long operator-(Price rhs) const { return m_ticks - rhs.m_ticks; }
+
+	constexpr bool operator==(Price rhs) const { return m_ticks == rhs.m_ticks; }
+	constexpr bool operator!=(Price rhs) const { return m_ticks != rhs.m_ticks; }
+	constexpr bool operator<(Price rhs) const { return m_ticks < rhs.m_ticks; }
+	constexpr bool operator>(Price rhs) const { return m_ticks > rhs.m_ticks; }
+	constexpr bool operator<=(Price rhs) const { return m_ticks <= rhs.m_ticks; }
+	constexpr bool operator>=(Price rhs) const { return m_ticks >= rhs.m_ticks; }
+private:
+	long long m_ticks;
+};
+
+namespace std {
+	template<> struct hash<Price> {
+		size_t operator()(Price price) const noexcept { return std::hash<long long>()(price.ticks()); }
+	};
+}
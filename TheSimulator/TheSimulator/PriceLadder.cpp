@@ -0,0 +1,271 @@
+#include "PriceLadder.h"
+
+#include "BitOperations.h"
+
+#include <algorithm>
+
+TickContainer::TickContainer(Money price)
+	: m_price(price), list() { }
+
+PriceLevel::PriceLevel(Price price, OrderPool* pool, Volume* sideVolume)
+	: m_price(price), m_pool(pool), m_sideVolume(sideVolume), m_front(ORDERHANDLE_NONE), m_back(ORDERHANDLE_NONE), m_size(0), m_volume(0) { }
+
+void PriceLevel::pushBack(OrderHandle handle) {
+	BookOrder& record = (*m_pool)[handle];
+	record.previous = m_back;
+	record.next = ORDERHANDLE_NONE;
+	if (m_back != ORDERHANDLE_NONE) {
+		(*m_pool)[m_back].next = handle;
+	} else {
+		m_front = handle;
+	}
+	m_back = handle;
+	++m_size;
+	m_volume += record.volume;
+	*m_sideVolume += record.volume;
+}
+
+void PriceLevel::unlink(OrderHandle handle) {
+	BookOrder& record = (*m_pool)[handle];
+	if (record.previous != ORDERHANDLE_NONE) {
+		(*m_pool)[record.previous].next = record.next;
+	} else {
+		m_front = record.next;
+	}
+	if (record.next != ORDERHANDLE_NONE) {
+		(*m_pool)[record.next].previous = record.previous;
+	} else {
+		m_back = record.previous;
+	}
+	record.previous = ORDERHANDLE_NONE;
+	record.next = ORDERHANDLE_NONE;
+	--m_size;
+	m_volume -= record.volume;
+	*m_sideVolume -= record.volume;
+}
+
+void PriceLevel::removeVolume(OrderHandle handle, Volume volume) {
+	(*m_pool)[handle].volume -= volume;
+	m_volume -= volume;
+	*m_sideVolume -= volume;
+}
+
+void PriceLevel::clear() {
+	*m_sideVolume -= m_volume;
+	m_front = ORDERHANDLE_NONE;
+	m_back = ORDERHANDLE_NONE;
+	m_size = 0;
+	m_volume = 0;
+}
+
+TickContainer PriceLevel::snapshot() const {
+	TickContainer tickContainer(m_price.toMoney(m_pool->tickSize()));
+	for (OrderHandle handle = m_front; handle != ORDERHANDLE_NONE; handle = (*m_pool)[handle].next) {
+		tickContainer.push_back(m_pool->snapshot(handle));
+	}
+	return tickContainer;
+}
+
+PriceLadder::PriceLadder(OrderDirection side, OrderPool* pool, size_t windowSize)
+	: m_side(side), m_pool(pool), m_volume(0), m_windowSize(windowSize), m_levels(), m_occupancy(), m_summary(0), m_windowCount(0), m_windowBase(0), m_overflow() { }
+
+PriceLevel& PriceLadder::best() {
+	return bestInWindow() ? m_levels[bestSlot()] : m_overflow.begin()->second;
+}
+
+const PriceLevel& PriceLadder::best() const {
+	return bestInWindow() ? m_levels[bestSlot()] : m_overflow.begin()->second;
+}
+
+void PriceLadder::popBest() {
+	if (bestInWindow()) {
+		vacate(bestSlot());
+	} else {
+		m_volume -= m_overflow.begin()->second.volume();
+		m_overflow.erase(m_overflow.begin());
+	}
+	settle();
+}
+
+PriceLevel* PriceLadder::find(Price price) {
+	const long long rank = rankOf(price);
+	size_t slot;
+	if (slotOf(rank, slot)) {
+		return (m_occupancy[slot >> 6] & (1ULL << (slot & 63))) != 0 ? &m_levels[slot] : nullptr;
+	}
+
+	auto it = m_overflow.find(rank);
+	return it != m_overflow.end() ? &it->second : nullptr;
+}
+
+std::pair<PriceLevel*, bool> PriceLadder::emplace(Price price) {
+	PriceLevel* level = find(price);
+	if (level != nullptr) {
+		return std::make_pair(level, false);
+	}
+
+	const long long rank = rankOf(price);
+	size_t slot;
+	if (slotOf(rank, slot)) {
+		occupy(slot, price);
+		level = &m_levels[slot];
+	} else {
+		level = &m_overflow.emplace(rank, PriceLevel(price, m_pool, &m_volume)).first->second;
+	}
+
+	// the level may have moved, into the window or out of it
+	if (settle()) {
+		level = find(price);
+	}
+	return std::make_pair(level, true);
+}
+
+void PriceLadder::erase(Price price) {
+	const long long rank = rankOf(price);
+	size_t slot;
+	if (slotOf(rank, slot)) {
+		vacate(slot);
+	} else {
+		auto it = m_overflow.find(rank);
+		m_volume -= it->second.volume();
+		m_overflow.erase(it);
+	}
+	settle();
+}
+
+void PriceLadder::clear() {
+	for (size_t slot = findOccupiedFrom(0); slot < m_windowSize; slot = findOccupiedFrom(slot + 1)) {
+		m_levels[slot].clear();
+	}
+	std::fill(m_occupancy.begin(), m_occupancy.end(), 0);
+	m_summary = 0;
+	m_windowCount = 0;
+	m_overflow.clear();
+	m_volume = 0;
+}
+
+PriceLadder::ConstIterator PriceLadder::begin() const {
+	return ConstIterator(this, m_windowCount > 0 ? bestSlot() : m_windowSize, m_overflow.cbegin());
+}
+
+PriceLadder::ConstIterator PriceLadder::end() const {
+	return ConstIterator(this, m_windowSize, m_overflow.cend());
+}
+
+long long PriceLadder::rankOf(Price price) const {
+	return m_side == OrderDirection::Sell ? price.ticks() : -price.ticks();
+}
+
+bool PriceLadder::slotOf(long long rank, size_t& slot) const {
+	// before the window is allocated, the first level goes to the overflow and the window settles around it
+	if (m_levels.empty() || rank < m_windowBase || rank >= m_windowBase + (long long)m_windowSize) {
+		return false;
+	}
+	slot = (size_t)(rank - m_windowBase);
+	return true;
+}
+
+size_t PriceLadder::bestSlot() const {
+	const size_t word = countTrailingZeros(m_summary);
+	return (word << 6) + countTrailingZeros(m_occupancy[word]);
+}
+
+size_t PriceLadder::findOccupiedFrom(size_t slot) const {
+	// none of the window is occupied before it is allocated
+	if (slot >= m_levels.size()) {
+		return m_windowSize;
+	}
+
+	size_t word = slot >> 6;
+	const unsigned long long bits = m_occupancy[word] & (~0ULL << (slot & 63));
+	if (bits != 0) {
+		return (word << 6) + countTrailingZeros(bits);
+	}
+
+	const unsigned long long words = word + 1 < 64 ? m_summary & (~0ULL << (word + 1)) : 0;
+	if (words == 0) {
+		return m_windowSize;
+	}
+	word = countTrailingZeros(words);
+	return (word << 6) + countTrailingZeros(m_occupancy[word]);
+}
+
+bool PriceLadder::bestInWindow() const {
+	// ranks within the window never sit in the overflow, so the two never tie
+	return m_windowCount > 0 && (m_overflow.empty() || m_windowBase + (long long)bestSlot() < m_overflow.begin()->first);
+}
+
+void PriceLadder::occupy(size_t slot, Price price) {
+	m_levels[slot].m_price = price;
+	m_occupancy[slot >> 6] |= 1ULL << (slot & 63);
+	m_summary |= 1ULL << (slot >> 6);
+	++m_windowCount;
+}
+
+void PriceLadder::vacate(size_t slot) {
+	m_levels[slot].clear();
+	m_occupancy[slot >> 6] &= ~(1ULL << (slot & 63));
+	if (m_occupancy[slot >> 6] == 0) {
+		m_summary &= ~(1ULL << (slot >> 6));
+	}
+	--m_windowCount;
+}
+
+bool PriceLadder::settle() {
+	if (empty()) {
+		return false;
+	}
+
+	// recentering once the best level gets into the last quarter of the window leaves a quarter of the window between
+	// the recenterings whichever way the touch drifts
+	const long long rank = bestInWindow() ? m_windowBase + (long long)bestSlot() : m_overflow.begin()->first;
+	if (!m_levels.empty() && rank >= m_windowBase && rank < m_windowBase + (long long)(m_windowSize / 4 * 3)) {
+		return false;
+	}
+
+	recenter(rank);
+	return true;
+}
+
+void PriceLadder::recenter(long long rank) {
+	if (m_levels.empty()) {
+		m_levels.assign(m_windowSize, PriceLevel(Price(), m_pool, &m_volume));
+		m_occupancy.assign(m_windowSize / 64, 0);
+	}
+
+	for (size_t slot = findOccupiedFrom(0); slot < m_windowSize; slot = findOccupiedFrom(slot + 1)) {
+		m_overflow.emplace(m_windowBase + (long long)slot, m_levels[slot]);
+		m_levels[slot] = PriceLevel(Price(), m_pool, &m_volume);
+	}
+	std::fill(m_occupancy.begin(), m_occupancy.end(), 0);
+	m_summary = 0;
+	m_windowCount = 0;
+
+	m_windowBase = rank - (long long)(m_windowSize / 2);
+	auto it = m_overflow.lower_bound(m_windowBase);
+	const auto windowEnd = m_overflow.lower_bound(m_windowBase + (long long)m_windowSize);
+	while (it != windowEnd) {
+		const size_t slot = (size_t)(it->first - m_windowBase);
+		m_levels[slot] = it->second;
+		occupy(slot, it->second.price());
+		it = m_overflow.erase(it);
+	}
+}
+
+const PriceLevel& PriceLadder::ConstIterator::operator*() const {
+	return windowFirst() ? m_ladder->m_levels[m_slot] : m_overflow->second;
+}
+
+PriceLadder::ConstIterator& PriceLadder::ConstIterator::operator++() {
+	if (windowFirst()) {
+		m_slot = m_ladder->findOccupiedFrom(m_slot + 1);
+	} else {
+		++m_overflow;
+	}
+	return *this;
+}
+
+bool PriceLadder::ConstIterator::windowFirst() const {
+	return m_slot < m_ladder->m_windowSize
+		&& (m_overflow == m_ladder->m_overflow.end() || m_ladder->m_windowBase + (long long)m_slot < m_overflow->first);
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Order.h"
+#include "OrderPool.h"
+#include "Money.h"
+#include "Price.h"
+#include "Volume.h"
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <map>
+#include <numeric>
+#include <vector>
+
+// The orders at one price as whoever asks the book gets them, standalone copies of the ones resting in the book
+class TickContainer : public std::list<LimitOrderPtr> {
+public:
+	TickContainer(Money price);
+
+	Money price() const { return m_price; }
+	Volume volume() const {
+		return std::accumulate(cbegin(), cend(), (Volume)0, [](Volume soFar, const LimitOrderPtr& lop) {
+			return soFar + lop->volume();
+		});
+	};
+private:
+	Money m_price;
+};
+
+// The orders resting at one price, the oldest one first, linked through their records in the pool of the book.
+// The level only links and unlinks the records, allocating and releasing them is up to the book. The volume of the linked
+// orders, of the level and of its whole side, is kept up to date as long as it only changes through the level.
+class PriceLevel {
+public:
+	PriceLevel(Price price, OrderPool* pool, Volume* sideVolume);
+
+	Price price() const { return m_price; }
+	Volume volume() const { return m_volume; }
+
+	bool empty() const { return m_front == ORDERHANDLE_NONE; }
+	size_t size() const { return m_size; }
+	OrderHandle front() const { return m_front; }
+
+	void pushBack(OrderHandle handle);
+	void unlink(OrderHandle handle);
+	void removeVolume(OrderHandle handle, Volume volume);
+	void clear();
+
+	TickContainer snapshot() const;
+private:
+	Price m_price;
+	OrderPool* m_pool;
+	Volume* m_sideVolume;
+	OrderHandle m_front;
+	OrderHandle m_back;
+	size_t m_size;
+	Volume m_volume;
+
+	friend class PriceLadder;
+};
+
+// The price levels of one side of a book, the best one first. The levels within a window of ticks around the touch sit in an
+// array indexed by the tick, with a two-level occupancy bitmap finding the best one in constant time; the far levels wait in an
+// ordered overflow map. Whenever the best level leaves the window or gets into its last quarter, the window recenters around it,
+// so that the levels near the touch stay in the array. The array is only allocated once the first level gets there, so a side
+// that never has an order costs nothing.
+// Internally the prices are ranked so that a lower rank is always the better price, whichever the side.
+class PriceLadder {
+public:
+	class ConstIterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = PriceLevel;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const PriceLevel*;
+		using reference = const PriceLevel&;
+
+		reference operator*() const;
+		pointer operator->() const { return &**this; }
+		ConstIterator& operator++();
+		ConstIterator operator++(int) { ConstIterator previous = *this; ++*this; return previous; }
+
+		bool operator==(const ConstIterator& other) const { return m_slot == other.m_slot && m_overflow == other.m_overflow; }
+		bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+	private:
+		ConstIterator(const PriceLadder* ladder, size_t slot, std::map<long long, PriceLevel>::const_iterator overflow)
+			: m_ladder(ladder), m_slot(slot), m_overflow(overflow) { }
+
+		const PriceLadder* m_ladder;
+		size_t m_slot; // the window size once the window is exhausted
+		std::map<long long, PriceLevel>::const_iterator m_overflow;
+
+		bool windowFirst() const;
+
+		friend class PriceLadder;
+	};
+
+	// the window size is a power of two from MIN_WINDOW_SIZE to MAX_WINDOW_SIZE ticks
+	PriceLadder(OrderDirection side, OrderPool* pool, size_t windowSize = DEFAULT_WINDOW_SIZE);
+
+	bool empty() const { return m_windowCount == 0 && m_overflow.empty(); }
+	size_t size() const { return m_windowCount + m_overflow.size(); }
+	Volume volume() const { return m_volume; } // of all the levels
+
+	// the ladder must not be empty
+	PriceLevel& best();
+	const PriceLevel& best() const;
+	void popBest();
+
+	// the level at the price, nullptr if there is none
+	PriceLevel* find(Price price);
+	// the level at the price, created empty unless there already is one; the flag tells whether it was
+	std::pair<PriceLevel*, bool> emplace(Price price);
+	// removes the level at the price, there has to be one
+	void erase(Price price);
+	void clear();
+
+	// best to worst
+	ConstIterator begin() const;
+	ConstIterator end() const;
+
+	size_t windowSize() const { return m_windowSize; }
+
+	static constexpr size_t MIN_WINDOW_SIZE = 64; // a single word of occupancy
+	static constexpr size_t MAX_WINDOW_SIZE = 4096; // 64 words of occupancy, indexed by the bits of a single summary word
+	static constexpr size_t DEFAULT_WINDOW_SIZE = 1024;
+private:
+	OrderDirection m_side;
+	OrderPool* m_pool;
+	Volume m_volume;
+	size_t m_windowSize;
+
+	std::vector<PriceLevel> m_levels; // empty until the window is first placed
+	std::vector<unsigned long long> m_occupancy;
+	unsigned long long m_summary; // a bit for every nonzero occupancy word
+	size_t m_windowCount;
+	long long m_windowBase; // the rank of the first slot
+
+	std::map<long long, PriceLevel> m_overflow; // keyed by the rank
+
+	long long rankOf(Price price) const;
+	bool slotOf(long long rank, size_t& slot) const;
+	size_t bestSlot() const;
+	size_t findOccupiedFrom(size_t slot) const;
+	bool bestInWindow() const;
+
+	void occupy(size_t slot, Price price);
+	void vacate(size_t slot);
+	bool settle(); // true if the window moved
+	void recenter(long long rank);
+};
@@ -2,18 +2,30 @@
 
 #include <deque>
 
-#include "Book.h"
+#include "BasicBook.h"
 
 class TickDeque : public TickContainer, public std::deque<LimitOrderPtr> {
 public:
 	TickDeque(Money price);
 };
 
-class PriceTimeBook : public Book {
+// Price-time priority: the orders of the level fill one after the other, the oldest one first
+class PriceTimeMatching {
 public:
-	PriceTimeBook(OrderFactoryPtr orderRecordPtr, TradeFactoryPtr tradeRecordPtr);
-protected:
-	void processAgainstTheBuyQueue(const OrderPtr& order, Money minPrice) override;
-	void processAgainstTheSellQueue(const OrderPtr& order, Money maxPrice) override;
+	template <class BookType>
+	void matchBettering(BookType&, Order&, PriceLadder&, OrderHandle) { }
+
+	template <class BookType>
+	void matchLevel(BookType& book, Order& order, PriceLevel& level) {
+		while (order.volume() > 0 && !level.empty()) {
+			const OrderHandle handle = level.front();
+			book.fill(order, level, handle, std::min(book.record(handle).volume, order.volume()), level.price());
+			if (book.record(handle).volume == 0) {
+				book.removeLimitOrder(level, handle);
+			}
+		}
+	}
 };
 
+using PriceTimeBook = BasicBook<PriceTimeMatching, BufferedTradeSink>;
+extern template class BasicBook<PriceTimeMatching, BufferedTradeSink>;
@@ -0,0 +1,23 @@
+#include "PriorityMessageQueue.h"
+
+PriorityMessageQueue::PriorityMessageQueue(MessageTieOrder tieOrder)
+	: m_sequence(0), m_queue(CompareArrival(tieOrder)) { }
+
+void PriorityMessageQueue::push(const MessagePtr& messagePtr) {
+	m_queue.emplace(m_sequence++, messagePtr);
+}
+
+
+std::vector<MessagePtr> PriorityMessageQueue::messages() const {
+	std::vector<MessagePtr> ret;
+	ret.reserve(m_queue.size());
+
+	// the heap does not expose its elements, a copy of it gets drained instead
+	PriorityMessageQueueContainer queue = m_queue;
+	while (!queue.empty()) {
+		ret.push_back(queue.top().messagePtr);
+		queue.pop();
+	}
+
+	return ret;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "IMessageQueue.h"
+
+#include <queue>
+#include <vector>
+
+struct PriorityMessageQueueEntry {
+	Timestamp arrival;
+	unsigned long long sequence; // the order of the push
+	MessagePtr messagePtr;
+
+	PriorityMessageQueueEntry(unsigned long long sequence, const MessagePtr& messagePtr)
+		: arrival(messagePtr->arrival), sequence(sequence), messagePtr(messagePtr) { }
+};
+
+struct CompareArrival {
+	MessageTieOrder tieOrder;
+
+	CompareArrival(MessageTieOrder tieOrder = MessageTieOrder::Delivery) : tieOrder(tieOrder) { }
+
+	bool operator()(const PriorityMessageQueueEntry& a, const PriorityMessageQueueEntry& b) const {
+		// return true if b is to be delivered before a; the arrival is kept in the entry so that only ties touch the messages
+		if (a.arrival != b.arrival) {
+			return a.arrival > b.arrival;
+		}
+		return tieOrder == MessageTieOrder::Push ? a.sequence > b.sequence : deliveredBefore(*b.messagePtr, *a.messagePtr);
+	}
+};
+
+using PriorityMessageQueueContainer = std::priority_queue<PriorityMessageQueueEntry, std::vector<PriorityMessageQueueEntry>, CompareArrival>;
+
+class PriorityMessageQueue : public IMessageQueue {
+public:
+	PriorityMessageQueue(MessageTieOrder tieOrder);
+
+	void push(const MessagePtr& messagePtr) override;
+	const MessagePtr& top() override { return m_queue.top().messagePtr; }
+	void pop() override { m_queue.pop(); }
+
+	bool empty() const override { return m_queue.empty(); }
+	size_t size() const override { return m_queue.size(); }
+
+	std::vector<MessagePtr> messages() const override;
+private:
+	unsigned long long m_sequence;
+	PriorityMessageQueueContainer m_queue;
+};
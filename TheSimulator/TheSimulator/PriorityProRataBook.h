@@ -2,11 +2,27 @@
 
 #include "PureProRataBook.h"
 
-class PriorityProRataBook : public PureProRataBook {
+// Pro-rata, but the last order to better the price on the other side fills first, as far as it goes, as long as its level is still
+// the best one; once a better level is in front of it, the levels are all pro-rata
+class PriorityProRataMatching : public PureProRataMatching {
 public:
-	PriorityProRataBook(OrderFactoryPtr orderRecordPtr, TradeFactoryPtr tradeRecordPtr);
-protected:
-	void processAgainstTheBuyQueue(const OrderPtr& order, Money minPrice) override;
-	void processAgainstTheSellQueue(const OrderPtr& order, Money minPrice) override;
+	template <class BookType>
+	void matchBettering(BookType& book, Order& order, PriceLadder& queue, OrderHandle bettering) {
+		// the aggressor crosses the best level, so the price is within its limit
+		PriceLevel& best = queue.best();
+		if (bettering == ORDERHANDLE_NONE || best.front() != bettering) {
+			return;
+		}
+
+		book.fill(order, best, bettering, std::min(order.volume(), book.record(bettering).volume), best.price());
+		if (book.record(bettering).volume == 0) {
+			book.removeLimitOrder(best, bettering);
+			if (best.empty()) {
+				queue.popBest();
+			}
+		}
+	}
 };
 
+using PriorityProRataBook = BasicBook<PriorityProRataMatching, BufferedTradeSink>;
+extern template class BasicBook<PriorityProRataMatching, BufferedTradeSink>;
@@ -0,0 +1,72 @@
+#include "ProRataKernel.h"
+
+#include <algorithm>
+#include <cstdint>
+
+// floor(a * b / c) without the product overflowing, for a quotient that fits in 64 bits
+static inline std::uint64_t mulDiv(std::uint64_t a, std::uint64_t b, std::uint64_t c) {
+	if (((a | b) >> 32) == 0) {
+		return a * b / c;
+	}
+#if defined(__SIZEOF_INT128__)
+	return (std::uint64_t)((unsigned __int128)a * b / c);
+#else
+	// the 128-bit product from the 32-bit halves, then divided a bit at a time; the quotient fits, so the high half is below c
+	const std::uint64_t aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32, bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+	const std::uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow;
+	const std::uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFFULL) + (highLow & 0xFFFFFFFFULL);
+	std::uint64_t low = (middle << 32) | (lowLow & 0xFFFFFFFFULL);
+	std::uint64_t high = aHigh * bHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+
+	std::uint64_t quotient = 0;
+	for (int bit = 0; bit < 64; ++bit) {
+		const bool carry = (high >> 63) != 0;
+		high = (high << 1) | (low >> 63);
+		low <<= 1;
+		quotient <<= 1;
+		if (carry || high >= c) {
+			high -= c;
+			quotient |= 1;
+		}
+	}
+	return quotient;
+#endif
+}
+
+void computePureProRataShares(Volume incomingVolume, Volume levelVolume, const Volume* volumes, Volume* shares, size_t count) {
+	if (incomingVolume >= levelVolume) {
+		std::copy(volumes, volumes + count, shares);
+		return;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		shares[i] = (Volume)mulDiv(incomingVolume, volumes[i], levelVolume);
+	}
+}
+
+void computeTimeProRataShares(Volume incomingVolume, Volume levelVolume, const Volume* volumes, Volume* shares, size_t count) {
+	// the volume preceding every order, the one pass that cannot run in parallel
+	Volume preceding = 0;
+	for (size_t i = 0; i < count; ++i) {
+		shares[i] = preceding;
+		preceding += volumes[i];
+	}
+
+	// v1^2 - v2^2 = v * (v1 + v2) = v * (2 * v1 - v), which fits in 64 bits as long as the level volume fits in 32
+	if (((std::uint64_t)levelVolume >> 32) == 0) {
+		const std::uint64_t levelSquared = (std::uint64_t)levelVolume * levelVolume;
+		for (size_t i = 0; i < count; ++i) {
+			const std::uint64_t volume = volumes[i];
+			const std::uint64_t weight = volume * (2 * (std::uint64_t)(levelVolume - shares[i]) - volume);
+			shares[i] = (Volume)std::min((std::uint64_t)volumes[i], mulDiv(incomingVolume, weight, levelSquared));
+		}
+		return;
+	}
+
+	// beyond that, in double precision
+	const double scale = (double)incomingVolume / ((double)levelVolume * (double)levelVolume);
+	for (size_t i = 0; i < count; ++i) {
+		const double volume = (double)volumes[i];
+		const double share = scale * volume * (2.0 * (double)(levelVolume - shares[i]) - volume);
+		shares[i] = std::min(volumes[i], (Volume)share);
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Volume.h"
+
+#include <cstddef>
+
+// The pro-rata shares of the orders of one level, given their volumes in the order of the level. The loops run over contiguous
+// arrays. The shares are the exact integer quotients, the products taken in 128 bits where they do not fit in 64, so that equal
+// orders get equal shares; each one is at most the volume of its order, and together they are at most the incoming volume.
+// Only the time weighted shares of a level of 2^32 lots or more fall back to double precision, and may then overshoot by the
+// rounding. What is left of the incoming volume is up to the book to hand out, in whole lots. The level volume, the sum of the
+// volumes, has to be positive.
+
+// every order gets floor(incomingVolume * volume / levelVolume), or its whole volume once the incoming volume covers the level
+void computePureProRataShares(Volume incomingVolume, Volume levelVolume, const Volume* volumes, Volume* shares, size_t count);
+
+// the earlier orders get more, every order gets floor(incomingVolume * (v1^2 - v2^2) / levelVolume^2) at most its volume,
+// where v1 and v2 are the volumes of the level from the order on and from after it
+void computeTimeProRataShares(Volume incomingVolume, Volume levelVolume, const Volume* volumes, Volume* shares, size_t count);
@@ -3,17 +3,65 @@
 #pragma warning( suppress : 4250 )
 
 #include <list>
+#include <vector>
 
-#include "Book.h"
+#include "BasicBook.h"
+#include "ProRataKernel.h"
 
-class PureProRataBook : public Book {
+// Pro-rata: every order of the level gets its share of the aggressor, see ProRataKernel.h, and the remainder from rounding
+// the shares down goes to the orders one after the other, the oldest one first
+class PureProRataMatching {
 public:
-	PureProRataBook(OrderFactoryPtr orderRecordPtr, TradeFactoryPtr tradeRecordPtr);
+	template <class BookType>
+	void matchBettering(BookType&, Order&, PriceLadder&, OrderHandle) { }
 
+	template <class BookType>
+	void matchLevel(BookType& book, Order& order, PriceLevel& level) {
+		matchLevelWith(book, order, level, computePureProRataShares);
+	}
 protected:
-	void processAgainstTheBuyQueue(const OrderPtr& order, Money minPrice) override;
-	void processAgainstTheSellQueue(const OrderPtr& order, Money maxPrice) override;
-
-	virtual std::vector<std::pair<LimitOrderPtr, Volume>> computePartialVolumes(Volume incomingVolume, TickContainer* bestList);
+	// the shares of the orders from the kernel, which takes their volumes in the order of the level
+	template <class BookType, class ComputeShares>
+	void matchLevelWith(BookType& book, Order& order, PriceLevel& level, ComputeShares computeShares);
+private:
+	// the orders of the level being matched, gathered side by side; kept between the matches so that they do not allocate
+	std::vector<OrderHandle> m_levelOrders;
+	std::vector<Volume> m_levelVolumes;
+	std::vector<Volume> m_partialVolumes;
 };
 
+template <class BookType, class ComputeShares>
+void PureProRataMatching::matchLevelWith(BookType& book, Order& order, PriceLevel& level, ComputeShares computeShares) {
+	m_levelOrders.clear();
+	m_levelVolumes.clear();
+	for (OrderHandle handle = level.front(); handle != ORDERHANDLE_NONE; handle = book.record(handle).next) {
+		m_levelOrders.push_back(handle);
+		m_levelVolumes.push_back(book.record(handle).volume);
+	}
+	const size_t count = m_levelOrders.size();
+	m_partialVolumes.assign(count, 0);
+	computeShares(order.volume(), level.volume(), m_levelVolumes.data(), m_partialVolumes.data(), count);
+
+	for (size_t i = 0; i < count; ++i) {
+		// the shares may overshoot by the rounding of the kernel, never by more than what is left
+		const OrderHandle handle = m_levelOrders[i];
+		book.fill(order, level, handle, std::min(m_partialVolumes[i], order.volume()), level.price());
+		if (book.record(handle).volume == 0) {
+			book.removeLimitOrder(level, handle);
+		}
+	}
+
+	// FIFO on the cummulative remainder from rounding down, the orders left in the level all have some volume
+	OrderHandle handle = level.front();
+	while (handle != ORDERHANDLE_NONE && order.volume() > 0) {
+		const OrderHandle next = book.record(handle).next;
+		book.fill(order, level, handle, std::min(book.record(handle).volume, order.volume()), level.price());
+		if (book.record(handle).volume == 0) {
+			book.removeLimitOrder(level, handle);
+		}
+		handle = next;
+	}
+}
+
+using PureProRataBook = BasicBook<PureProRataMatching, BufferedTradeSink>;
+extern template class BasicBook<PureProRataMatching, BufferedTradeSink>;
@@ -1,5 +1,6 @@
 #include "PythonAgent.h"
 #include "Simulation.h"
+#include "SimulationException.h"
 
 #include <pybind11/stl.h>
 
@@ -11,6 +12,7 @@ PythonAgent::PythonAgent(const Simulation* simulation, const std::string& name)
 
 void PythonAgent::configure(const pugi::xml_node& node, const std::string& configurationPath) {
 	Agent::configure(node, configurationPath);
+	setPartition(""); // the interpreter belongs to the thread running the default partition
 
 	for (const pugi::xml_attribute& attr : node.attributes()) {
 		if (std::string(attr.name()) != "file" && std::string(attr.name()) != "name") {
@@ -42,5 +44,13 @@ void PythonAgent::configure(const pugi::xml_node& node, const std::string& confi
 
 void PythonAgent::receiveMessage(const MessagePtr& msg) {
 	py::function receiveMessageFunction = py::reinterpret_borrow<py::function>(m_instance.attr("receiveMessage"));
-	py::object _ret = receiveMessageFunction(simulation(), msg->type, py::dict()/*, msg.toDict()*/);
+	py::object _ret = receiveMessageFunction(simulation(), MessageTypeRegistry::name(msg->type), py::dict()/*, msg.toDict()*/);
+}
+
+void PythonAgent::saveState(SnapshotWriter& writer) {
+	throw SimulationException("PythonAgent::saveState(): the state of the Python agent '" + name() + "' can not be saved");
+}
+
+void PythonAgent::loadState(SnapshotReader& reader) {
+	throw SimulationException("PythonAgent::loadState(): the state of the Python agent '" + name() + "' can not be loaded");
 }
@@ -12,6 +12,10 @@ public:
 
 	void configure(const pugi::xml_node& node, const std::string& configurationPath);
 
+	// the Python objects can not be saved, a simulation with Python agents can not take snapshots
+	void saveState(SnapshotWriter& writer) override;
+	void loadState(SnapshotReader& reader) override;
+
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
 private:
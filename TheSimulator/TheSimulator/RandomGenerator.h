@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// xoshiro256** by Blackman and Vigna: 32 bytes of state, so that every agent can draw from a stream of its own.
+// Satisfies UniformRandomBitGenerator, the <random> distributions take it the same way as std::mt19937.
+class RandomGenerator {
+public:
+	using result_type = std::uint64_t;
+	using State = std::array<std::uint64_t, 4>;
+
+	RandomGenerator() : RandomGenerator(0) { }
+	explicit RandomGenerator(std::uint64_t seed) { this->seed(seed); }
+
+	// expands the seed into the state with splitmix64, as the authors recommend
+	void seed(std::uint64_t seed) {
+		for (std::uint64_t& word : m_state) {
+			seed += 0x9E3779B97F4A7C15ULL;
+			word = mix(seed);
+		}
+	}
+
+	// advances the generator by 2^128 draws, the streams a generator and its jumped copies give never overlap in practice
+	void jump() {
+		static constexpr State JUMP = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+		jumpBy(JUMP);
+	}
+
+	// advances the generator by 2^192 draws, i.e. by 2^64 jumps
+	void longJump() {
+		static constexpr State LONG_JUMP = { 0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL };
+		jumpBy(LONG_JUMP);
+	}
+
+	// moves the generator onto a stream of its own for the given branch, away from the one it was on;
+	// e.g. for the runs forked off a shared state, the same state and branch always give the same stream
+	void branch(std::uint64_t branch) {
+		std::uint64_t key = mix(branch);
+		for (std::uint64_t& word : m_state) {
+			key += 0x9E3779B97F4A7C15ULL;
+			word = mix(word ^ mix(key));
+		}
+	}
+
+	result_type operator()() {
+		const std::uint64_t result = rotateLeft(m_state[1] * 5, 7) * 9;
+		const std::uint64_t shifted = m_state[1] << 17;
+
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+		m_state[2] ^= shifted;
+		m_state[3] = rotateLeft(m_state[3], 45);
+
+		return result;
+	}
+
+	// the whole state, e.g. for a snapshot; a generator set to it continues with the same draws
+	State state() const { return m_state; }
+	void setState(const State& state) { m_state = state; }
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+private:
+	State m_state;
+
+	static std::uint64_t rotateLeft(std::uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+	// the state the generator would reach after the draws the polynomial stands for
+	void jumpBy(const State& polynomial) {
+		State jumped = { 0, 0, 0, 0 };
+		for (std::uint64_t word : polynomial) {
+			for (int bit = 0; bit < 64; ++bit) {
+				if (word & (1ULL << bit)) {
+					for (size_t i = 0; i < jumped.size(); ++i) {
+						jumped[i] ^= m_state[i];
+					}
+				}
+				(*this)();
+			}
+		}
+		m_state = jumped;
+	}
+
+	// the splitmix64 finalizer
+	static std::uint64_t mix(std::uint64_t value) {
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+		return value ^ (value >> 31);
+	}
+};
@@ -2,12 +2,13 @@
 #include "RandomWalkMarketMakerAgent.h"
 
 #include "ExchangeAgentMessagePayloads.h"
+#include "Snapshot.h"
 
 RandomWalkMarketMakerAgent::RandomWalkMarketMakerAgent(const Simulation* simulation)
-	: Agent(simulation), m_exchange(""), m_p(0.5), m_halfSpread(0.01), m_depth(0), m_priceStep(0.01), m_timeStep(1), m_currentMidPrice(1), m_lb(1), m_ub(1), m_outstandingBuyOrder(0), m_outstandingSellOrder(0) { }
+	: Agent(simulation), m_exchange(""), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_p(0.5), m_halfSpread(0.01), m_depth(0), m_priceStep(0.01), m_timeStep(1), m_currentMidPrice(1), m_lb(1), m_ub(1), m_outstandingBuyOrder(0), m_outstandingSellOrder(0) { }
 
 RandomWalkMarketMakerAgent::RandomWalkMarketMakerAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name), m_exchange(""), m_p(0.5), m_halfSpread(0.01), m_depth(0), m_priceStep(0.01), m_timeStep(1), m_currentMidPrice(1), m_lb(1), m_ub(1), m_outstandingBuyOrder(0), m_outstandingSellOrder(0) { }
+	: Agent(simulation, name), m_exchange(""), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_p(0.5), m_halfSpread(0.01), m_depth(0), m_priceStep(0.01), m_timeStep(1), m_currentMidPrice(1), m_lb(1), m_ub(1), m_outstandingBuyOrder(0), m_outstandingSellOrder(0) { }
 
 void RandomWalkMarketMakerAgent::configure(const pugi::xml_node& node, const std::string& configurationPath) {
 	Agent::configure(node, configurationPath);
@@ -17,6 +18,10 @@ void RandomWalkMarketMakerAgent::configure(const pugi::xml_node& node, const std
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
 
+	if (!(att = node.attribute("symbol")).empty()) {
+		m_symbol = (SymbolId)std::stoul(simulation()->parameters().processString(att.as_string()));
+	}
+
 	if (!(att = node.attribute("p")).empty()) {
 		m_p = std::stod(simulation()->parameters().processString(att.as_string()));
 	}
@@ -50,59 +55,79 @@ void RandomWalkMarketMakerAgent::configure(const pugi::xml_node& node, const std
 	}
 }
 
+void RandomWalkMarketMakerAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
+}
+
+const MessageDispatchTable<RandomWalkMarketMakerAgent> RandomWalkMarketMakerAgent::s_dispatchTable = MessageDispatchTable<RandomWalkMarketMakerAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &RandomWalkMarketMakerAgent::handleSimulationStart)
+	.on(MESSAGETYPE_WAKEUP_FOR_MARKETMAKING, &RandomWalkMarketMakerAgent::handleWakeupForMarketmaking)
+	.on(MESSAGETYPE_RESPONSE_REPLACE_ORDERS, &RandomWalkMarketMakerAgent::handleReplaceOrdersResponse);
+
 void RandomWalkMarketMakerAgent::receiveMessage(const MessagePtr& msg) {
+	s_dispatchTable.dispatch(this, msg);
+}
+
+void RandomWalkMarketMakerAgent::handleSimulationStart(const MessagePtr& msg) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-	if (msg->type == "EVENT_SIMULATION_START") {
-		// trigger immediate market making
-		simulation()->dispatchMessage(currentTimestamp, 0, this->name(), this->name(), "WAKEUP_FOR_MARKETMAKING", std::make_shared<EmptyPayload>());
-	} else if (msg->type == "WAKEUP_FOR_MARKETMAKING") {
-		// cancel the outstanding orders
-		auto cpptr = std::make_shared<CancelOrdersPayload>();
-		if (m_outstandingBuyOrder != 0) {
-			cpptr->cancellations.push_back(CancelOrdersCancellation(m_outstandingBuyOrder, m_depth));
-		}
-		if (m_outstandingSellOrder != 0) {
-			cpptr->cancellations.push_back(CancelOrdersCancellation(m_outstandingSellOrder, m_depth));
-		}
-		if (cpptr->cancellations.size() > 0) {
-			simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "CANCEL_ORDERS", cpptr);
-		}
+	// trigger immediate market making
+	simulation()->dispatchMessage(currentTimestamp, 0, this->id(), this->id(), MESSAGETYPE_WAKEUP_FOR_MARKETMAKING);
+}
 
-		// walk a step
-		std::bernoulli_distribution stepTypeDistribution(m_p);
-		Money step = stepTypeDistribution(simulation()->randomGenerator()) ? m_priceStep : -m_priceStep;
-		m_currentMidPrice += step;
-		if (m_currentMidPrice < m_lb) {
-			m_currentMidPrice = m_lb;
-		}
-		if (m_currentMidPrice > m_ub) {
-			m_currentMidPrice = m_ub;
-		}
+void RandomWalkMarketMakerAgent::handleWakeupForMarketmaking(const MessagePtr& msg) {
+	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-		// place new orders
-		Money newSellPrice = m_currentMidPrice + m_halfSpread;
-		Money newBuyPrice = m_currentMidPrice - m_halfSpread;
+	// walk a step
+	std::bernoulli_distribution stepTypeDistribution(m_p);
+	Money step = stepTypeDistribution(simulation()->randomGenerator()) ? m_priceStep : -m_priceStep;
+	m_currentMidPrice += step;
+	if (m_currentMidPrice < m_lb) {
+		m_currentMidPrice = m_lb;
+	}
+	if (m_currentMidPrice > m_ub) {
+		m_currentMidPrice = m_ub;
+	}
 
-		auto pptr = std::make_shared<PlaceOrderLimitPayload>(OrderDirection::Sell, m_depth, newSellPrice);
-		simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "PLACE_ORDER_LIMIT", pptr);
+	// replace the outstanding orders with the new ones, in a single request; there are none to replace at first, and none after
+	// the exchange rejected the replacement of an order that had filled in the meantime
+	Money newSellPrice = m_currentMidPrice + m_halfSpread;
+	Money newBuyPrice = m_currentMidPrice - m_halfSpread;
 
-		pptr = std::make_shared<PlaceOrderLimitPayload>(OrderDirection::Buy, m_depth, newBuyPrice);
-		simulation()->dispatchMessage(currentTimestamp, 0, this->name(), m_exchange, "PLACE_ORDER_LIMIT", pptr);
+	ReplaceOrdersPayload replacePayload;
+	replacePayload.symbol = m_symbol;
+	replacePayload.replacements.push_back(ReplaceOrdersReplacement(m_outstandingSellOrder, OrderDirection::Sell, m_depth, newSellPrice));
+	replacePayload.replacements.push_back(ReplaceOrdersReplacement(m_outstandingBuyOrder, OrderDirection::Buy, m_depth, newBuyPrice));
+	simulation()->dispatchMessage(currentTimestamp, 0, this->id(), m_exchangeId, MESSAGETYPE_REPLACE_ORDERS, std::move(replacePayload));
 
-		// schedule next marketMaking
-		scheduleMarketMaking();
-	} else if (msg->type == "RESPONSE_PLACE_ORDER_LIMIT") {
-		auto payload = std::dynamic_pointer_cast<PlaceOrderLimitResponsePayload>(msg->payload);
-		if (payload->requestPayload->direction == OrderDirection::Buy) {
-			m_outstandingBuyOrder = payload->id;
+	// schedule next marketMaking
+	scheduleMarketMaking();
+}
+
+void RandomWalkMarketMakerAgent::handleReplaceOrdersResponse(const MessagePtr& msg) {
+	const auto& payload = std::get<ReplaceOrdersResponsePayload>(msg->payload);
+	for (size_t index = 0; index < payload.ids.size(); ++index) {
+		if (payload.requestPayload.replacements[index].direction == OrderDirection::Buy) {
+			m_outstandingBuyOrder = payload.ids[index];
 		} else {
-			m_outstandingSellOrder = payload->id;
+			m_outstandingSellOrder = payload.ids[index];
 		}
 	}
 }
 
 void RandomWalkMarketMakerAgent::scheduleMarketMaking() {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
-	simulation()->dispatchMessage(currentTimestamp, m_timeStep, this->name(), this->name(), "WAKEUP_FOR_MARKETMAKING", std::make_shared<EmptyPayload>());
+	simulation()->dispatchMessage(currentTimestamp, m_timeStep, this->id(), this->id(), MESSAGETYPE_WAKEUP_FOR_MARKETMAKING);
+}
+
+void RandomWalkMarketMakerAgent::saveState(SnapshotWriter& writer) {
+	writer.writeMoney(m_currentMidPrice);
+	writer.write(m_outstandingBuyOrder);
+	writer.write(m_outstandingSellOrder);
+}
+
+void RandomWalkMarketMakerAgent::loadState(SnapshotReader& reader) {
+	m_currentMidPrice = reader.readMoney();
+	m_outstandingBuyOrder = reader.read<OrderID>();
+	m_outstandingSellOrder = reader.read<OrderID>();
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Agent.h"
+#include "MessageDispatchTable.h"
+#include "SymbolId.h"
 #include "Order.h"
 
 class RandomWalkMarketMakerAgent : public Agent {
@@ -10,10 +12,22 @@ public:
 
 	void configure(const pugi::xml_node& node, const std::string& configurationPath);
 
+	void saveState(SnapshotWriter& writer) override;
+	void loadState(SnapshotReader& reader) override;
+
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<RandomWalkMarketMakerAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& msg);
+	void handleWakeupForMarketmaking(const MessagePtr& msg);
+	void handleReplaceOrdersResponse(const MessagePtr& msg);
+
 	std::string m_exchange;
+	AgentId m_exchangeId;
+	SymbolId m_symbol; // of the book on the exchange
 	double m_p;
 	
 	Money m_halfSpread;
@@ -4,10 +4,10 @@
 #include "Simulation.h"
 
 SetupAgent::SetupAgent(const Simulation* simulation)
-	: Agent(simulation), m_setupTime(0), m_askVolume(0), m_askPrice(0), m_bidVolume(0), m_bidPrice(0) {}
+	: Agent(simulation), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_setupTime(0), m_askVolume(0), m_askPrice(0), m_bidVolume(0), m_bidPrice(0) {}
 
 SetupAgent::SetupAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name), m_setupTime(0), m_askVolume(0), m_askPrice(0), m_bidVolume(0), m_bidPrice(0) { }
+	: Agent(simulation, name), m_exchangeId(AGENTID_INVALID), m_symbol(0), m_setupTime(0), m_askVolume(0), m_askPrice(0), m_bidVolume(0), m_bidPrice(0) { }
 
 void SetupAgent::configure(const pugi::xml_node& node, const std::string& configurationPath) {
 	Agent::configure(node, configurationPath);
@@ -17,6 +17,10 @@ void SetupAgent::configure(const pugi::xml_node& node, const std::string& config
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
 
+	if (!(att = node.attribute("symbol")).empty()) {
+		m_symbol = (SymbolId)std::stoul(simulation()->parameters().processString(att.as_string()));
+	}
+
 	if (!(att = node.attribute("setupTime")).empty()) {
 		m_setupTime = att.as_ullong();
 	}
@@ -38,13 +42,20 @@ void SetupAgent::configure(const pugi::xml_node& node, const std::string& config
 	}
 }
 
+void SetupAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
+}
+
+const MessageDispatchTable<SetupAgent> SetupAgent::s_dispatchTable = MessageDispatchTable<SetupAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &SetupAgent::handleSimulationStart);
+
 void SetupAgent::receiveMessage(const MessagePtr& msg) {
+	s_dispatchTable.dispatch(this, msg);
+}
+
+void SetupAgent::handleSimulationStart(const MessagePtr& msg) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
 
-	if (msg->type == "EVENT_SIMULATION_START") {
-		auto bidPayload = std::make_shared<PlaceOrderLimitPayload>(OrderDirection::Buy, m_bidVolume, Money(0, m_bidPrice));
-		auto askPayload = std::make_shared<PlaceOrderLimitPayload>(OrderDirection::Sell, m_askVolume, Money(0, m_askPrice));
-		simulation()->dispatchMessage(currentTimestamp, m_setupTime - currentTimestamp, name(), m_exchange, "PLACE_ORDER_LIMIT", bidPayload);
-		simulation()->dispatchMessage(currentTimestamp, m_setupTime - currentTimestamp, name(), m_exchange, "PLACE_ORDER_LIMIT", askPayload);
-	}
+	simulation()->dispatchMessage(currentTimestamp, m_setupTime - currentTimestamp, id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_LIMIT, PlaceOrderLimitPayload(OrderDirection::Buy, m_bidVolume, Money(0, m_bidPrice), m_symbol));
+	simulation()->dispatchMessage(currentTimestamp, m_setupTime - currentTimestamp, id(), m_exchangeId, MESSAGETYPE_PLACE_ORDER_LIMIT, PlaceOrderLimitPayload(OrderDirection::Sell, m_askVolume, Money(0, m_askPrice), m_symbol));
 }
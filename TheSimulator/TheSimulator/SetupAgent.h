@@ -1,5 +1,7 @@
 #pragma once
 #include "Agent.h"
+#include "MessageDispatchTable.h"
+#include "SymbolId.h"
 #include "Volume.h"
 
 #include <memory>
@@ -17,8 +19,15 @@ public:
 
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<SetupAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& msg);
+
 	std::string m_exchange;
+	AgentId m_exchangeId;
+	SymbolId m_symbol; // of the book on the exchange
 
 	Timestamp m_setupTime;
 	Volume m_bidVolume;
@@ -12,9 +12,18 @@
 #include "DoobAgent.h"
 #include "PythonAgent.h"
 
+#include "PriorityMessageQueue.h"
+#include "TimingWheelMessageQueue.h"
+#include "PartitionWorkers.h"
+#include "Snapshot.h"
+
 #include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
 
+#include "split.h"
 #include "SimulationException.h"
 #include "ParameterStorage.h"
 
@@ -23,12 +32,35 @@ Simulation::Simulation(ParameterStorage* parameters)
 	
 }
 
+thread_local SimulationPartition* Simulation::s_activePartition = nullptr;
+
+namespace {
+
+// marks the partition whose messages the current thread delivers
+class ActivePartitionScope {
+public:
+	ActivePartitionScope(SimulationPartition*& activePartition, SimulationPartition* partition)
+		: m_activePartition(activePartition), m_previous(activePartition) {
+		m_activePartition = partition;
+	}
+	~ActivePartitionScope() { m_activePartition = m_previous; }
+private:
+	SimulationPartition*& m_activePartition;
+	SimulationPartition* m_previous;
+};
+
+}
+
 Simulation::Simulation(ParameterStorage* parameters, Timestamp startTimestamp, Timestamp duration, const std::string& directory)
-	: IMessageable(this, "SIMULATION"), m_parameters(parameters), m_startTimestamp(startTimestamp), m_currentTimestamp(startTimestamp), m_durationTimestamp(duration), m_messageQueue(std::make_unique <std::priority_queue<MessagePtr, std::vector<MessagePtr>, CompareArrival>>()), m_state(SimulationState::INACTIVE), m_randomDevice(), m_randomGenerator(std::make_unique<std::mt19937>(m_randomDevice())) {
+	: IMessageable(this, "SIMULATION"), m_parameters(parameters), m_startTimestamp(startTimestamp), m_durationTimestamp(duration), m_state(SimulationState::INACTIVE),
+	m_seed(0), m_randomGenerators(1, RandomGenerator(m_seed)), m_dispatchCounts(1, 0),
+	m_scheduler("PriorityQueue"), m_wheelSize(TimingWheelMessageQueue::DEFAULT_WHEEL_SIZE), m_tieOrder(MessageTieOrder::Delivery), m_lookahead(0) {
+	m_id = AGENTID_SIMULATION;
+	m_partitions.push_back(std::make_unique<SimulationPartition>(this, 0, startTimestamp, createMessageQueue()));
 }
 
 void Simulation::simulate() {
-	simulate(m_startTimestamp + m_durationTimestamp - m_currentTimestamp);
+	simulate(m_startTimestamp + m_durationTimestamp - currentTimestamp());
 }
 
 void Simulation::simulate(Timestamp howMuch) {
@@ -40,54 +72,308 @@ void Simulation::simulate(Timestamp howMuch) {
 		this->start();
 	}
 
-	Timestamp toSimulate = std::min(m_startTimestamp + m_durationTimestamp - m_currentTimestamp, howMuch);
+	const Timestamp remaining = m_startTimestamp + m_durationTimestamp - currentTimestamp();
+	const Timestamp toSimulate = std::min(remaining, howMuch);
 	if (toSimulate > 0) {
 		step(toSimulate);
 	}
 
-	this->stop();
+	// a shorter step leaves the simulation running, to be stepped on or saved in a snapshot
+	if (toSimulate == remaining) {
+		this->stop();
+	}
 }
 
 void Simulation::deliverMessage(const MessagePtr& messagePtr) {
-	for (const std::string& target : messagePtr->targets) {
-		if (target == "*") {
-			receiveMessage(messagePtr);
+	deliverMessage(activePartition(), messagePtr);
+}
 
-			for (const auto& agentPtr : m_agentList) {
-				agentPtr->receiveMessage(messagePtr);
+void Simulation::deliverMessage(SimulationPartition& partition, const MessagePtr& messagePtr) {
+	for (AgentId target : messagePtr->targets) {
+		if (target == AGENTID_BROADCAST) {
+			// every partition gets a copy of a broadcast, the simulation itself lives in the default one
+			if (partition.index == 0) {
+				partition.currentAgent = AGENTID_SIMULATION;
+				receiveMessage(messagePtr);
 			}
-		} else if (target == "SIMULATION") {
-			receiveMessage(messagePtr);
-		} else if (target.back() == '*') {
-			std::string prefix = target;
-			prefix.pop_back();
-			
-			auto cmpPredLb = [](const auto& agentPtr, const std::string& val) {
-				return agentPtr->name().find(val, 0) != 0;
-			};
-
-			auto cmpPredUb = [](const std::string& val, const auto& agentPtr) {
-				return agentPtr->name().find(val, 0) == 0;
-			};
-
-			auto lb = std::lower_bound(m_agentList.begin(), m_agentList.end(), prefix, cmpPredLb);
-			auto ub = std::upper_bound(lb, m_agentList.end(), prefix, cmpPredUb);
-
-			for (; lb != ub; ++lb) {
-				(*lb)->receiveMessage(messagePtr);
+
+			for (AgentId subscriber : subscribers(partition, messagePtr->type)) {
+				partition.currentAgent = subscriber;
+				m_agentList[subscriber]->receiveMessage(messagePtr);
 			}
+		} else if (target == AGENTID_SIMULATION) {
+			partition.currentAgent = AGENTID_SIMULATION;
+			receiveMessage(messagePtr);
+		} else if (target < m_agentList.size()) {
+			partition.currentAgent = target;
+			m_agentList[target]->receiveMessage(messagePtr);
 		} else {
-			auto it = std::lower_bound(m_agentList.begin(), m_agentList.end(), target, [](const auto& agentPtr, const std::string& val) {
+			throw SimulationException("Simulation::deliverMessage(): unknown message target id " + std::to_string(target));
+		}
+	}
+
+	partition.currentAgent = AGENTID_SIMULATION;
+}
+
+AgentId Simulation::agentId(const std::string& name) const {
+	if (name == this->name()) {
+		return AGENTID_SIMULATION;
+	}
+
+	auto it = std::lower_bound(m_agentList.begin(), m_agentList.end(), name, [](const auto& agentPtr, const std::string& val) {
+		return agentPtr->name() < val;
+	});
+
+	if (it != m_agentList.end() && (*it)->name() == name) {
+		return (*it)->id();
+	} else {
+		throw SimulationException("Simulation::agentId(): unknown agent '" + name + "'");
+	}
+}
+
+const std::string& Simulation::agentName(AgentId id) const {
+	if (id == AGENTID_SIMULATION) {
+		return this->name();
+	} else if (id < m_agentList.size()) {
+		return m_agentList[id]->name();
+	} else {
+		throw SimulationException("Simulation::agentName(): unknown agent id " + std::to_string(id));
+	}
+}
+
+const std::vector<AgentId>& Simulation::resolveTargets(const std::string& target, MessageType type) const {
+	auto& resolvedByType = activePartition().resolvedTargets[target];
+	auto fit = resolvedByType.find(type);
+	if (fit != resolvedByType.end()) {
+		return fit->second;
+	}
+
+	std::vector<AgentId> resolved;
+	for (const std::string& targetName : split(target, '|')) {
+		if (targetName == "*") {
+			resolved.push_back(AGENTID_BROADCAST);
+		} else if (!targetName.empty() && targetName.back() == '*') {
+			const std::string prefix(targetName, 0, targetName.length() - 1);
+
+			// the agents are sorted by name, so the ones sharing the prefix form a contiguous range
+			auto lb = std::lower_bound(m_agentList.begin(), m_agentList.end(), prefix, [](const auto& agentPtr, const std::string& val) {
 				return agentPtr->name() < val;
 			});
+			for (; lb != m_agentList.end() && (*lb)->name().compare(0, prefix.length(), prefix) == 0; ++lb) {
+				if ((*lb)->consumes(type)) {
+					resolved.push_back((*lb)->id());
+				}
+			}
+		} else {
+			resolved.push_back(agentId(targetName));
+		}
+	}
 
-			if (it != m_agentList.end()) { 
-				(*it)->receiveMessage(messagePtr);
-			} else {
-				throw SimulationException("Simulation::deliverMessage(): unknown message target '" + target + "'");
+	return resolvedByType.emplace(type, std::move(resolved)).first->second;
+}
+
+const std::vector<AgentId>& Simulation::subscribers(SimulationPartition& partition, MessageType type) {
+	if (type >= partition.subscribers.size()) {
+		partition.subscribers.resize(type + 1);
+	}
+
+	auto& subscribers = partition.subscribers[type];
+	if (!subscribers.has_value()) {
+		subscribers.emplace();
+		for (AgentId agent : partition.agents) {
+			if (m_agentList[agent]->consumes(type)) {
+				subscribers->push_back(agent);
+			}
+		}
+	}
+
+	return *subscribers;
+}
+
+std::vector<AgentId> Simulation::targetsIn(const Message& message, size_t partitionIndex) const {
+	std::vector<AgentId> targets;
+	for (AgentId target : message.targets) {
+		if (target == AGENTID_BROADCAST || partitionOf(target) == partitionIndex) {
+			targets.push_back(target);
+		}
+	}
+
+	return targets;
+}
+
+void Simulation::routeMessage(const MessagePtr& messagePtr) const {
+	// the message comes from the pool of this partition, and only this partition may hand it back
+	SimulationPartition& origin = activePartition();
+
+	bool local = true;
+	for (AgentId target : messagePtr->targets) {
+		if (target == AGENTID_BROADCAST || partitionOf(target) != origin.index) {
+			local = false;
+			break;
+		}
+	}
+
+	if (local) {
+		origin.messageQueue->push(messagePtr);
+	} else if (s_activePartition == &origin) {
+		// the other partitions are running, they get the message once the window is over
+		std::vector<AgentId> localTargets = targetsIn(*messagePtr, origin.index);
+		if (!localTargets.empty()) {
+			origin.messageQueue->push(origin.messagePool.acquireCopy(*messagePtr, localTargets));
+		}
+		origin.outbox.push_back(messagePtr);
+	} else {
+		// outside of a step nothing runs concurrently
+		distributeMessage(*messagePtr, std::numeric_limits<size_t>::max());
+	}
+}
+
+void Simulation::distributeMessage(const Message& message, size_t excludedPartitionIndex) const {
+	for (const auto& partition : m_partitions) {
+		if (partition->index == excludedPartitionIndex) {
+			continue;
+		}
+
+		std::vector<AgentId> targets = targetsIn(message, partition->index);
+		if (!targets.empty()) {
+			partition->messageQueue->push(partition->messagePool.acquireCopy(message, targets));
+		}
+	}
+}
+
+void Simulation::exchangeOutboxes(Timestamp windowEnd) {
+	for (const auto& partition : m_partitions) {
+		for (const MessagePtr& messagePtr : partition->outbox) {
+			if (messagePtr->arrival < windowEnd) {
+				throw SimulationException("Simulation::step(): the message of type '" + MessageTypeRegistry::name(messagePtr->type)
+					+ "' from '" + agentName(messagePtr->source)
+					+ "' arrives at " + std::to_string(messagePtr->arrival)
+					+ " in another partition, before the parallel window ending at " + std::to_string(windowEnd)
+					+ " is over; messages between partitions need a delay of at least the lookahead " + std::to_string(m_lookahead)
+				);
 			}
+
+			distributeMessage(*messagePtr, partition->index);
+		}
+		partition->outbox.clear();
+	}
+}
+
+void Simulation::saveSnapshot(const std::string& path) const {
+	std::ofstream stream(path, std::ios::binary);
+	if (!stream) {
+		throw SimulationException("Simulation::saveSnapshot(): could not open the file '" + path + "'");
+	}
+
+	saveSnapshot(stream);
+	if (!stream.flush()) {
+		throw SimulationException("Simulation::saveSnapshot(): could not write the file '" + path + "'");
+	}
+}
+
+void Simulation::saveSnapshot(std::ostream& stream) const {
+	if (s_activePartition != nullptr) {
+		throw SimulationException("Simulation::saveSnapshot(): a snapshot can only be taken between the steps");
+	}
+
+	SnapshotWriter writer(stream);
+	writer.write(m_state);
+
+	// the agents and the partitions come from the configuration, they are only there to check the snapshot against it
+	writer.write((std::uint64_t)m_agentList.size());
+	for (const auto& agentPtr : m_agentList) {
+		writer.writeString(agentPtr->name());
+	}
+	writer.write((std::uint64_t)m_partitions.size());
+
+	for (const RandomGenerator& randomGenerator : m_randomGenerators) {
+		for (std::uint64_t word : randomGenerator.state()) {
+			writer.write(word);
+		}
+	}
+	for (unsigned long long dispatchCount : m_dispatchCounts) {
+		writer.write(dispatchCount);
+	}
+
+	for (const auto& partition : m_partitions) {
+		writer.write(partition->currentTimestamp);
+
+		const std::vector<MessagePtr> messages = partition->messageQueue->messages();
+		writer.write((std::uint64_t)messages.size());
+		for (const MessagePtr& messagePtr : messages) {
+			writer.writeMessage(*messagePtr);
+		}
+	}
+
+	for (const auto& agentPtr : m_agentList) {
+		agentPtr->saveState(writer);
+	}
+}
+
+void Simulation::loadSnapshot(const std::string& path) {
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream) {
+		throw SimulationException("Simulation::loadSnapshot(): could not open the file '" + path + "'");
+	}
+
+	loadSnapshot(stream);
+}
+
+void Simulation::loadSnapshot(std::istream& stream) {
+	if (m_state != SimulationState::INACTIVE || s_activePartition != nullptr) {
+		throw SimulationException("Simulation::loadSnapshot(): a snapshot can only be loaded before the simulation starts");
+	}
+
+	SnapshotReader reader(stream);
+	const SimulationState state = reader.read<SimulationState>();
+
+	const std::uint64_t agentCount = reader.read<std::uint64_t>();
+	if (agentCount != m_agentList.size()) {
+		throw SimulationException("Simulation::loadSnapshot(): the snapshot holds " + std::to_string(agentCount) + " agents, the simulation is configured with " + std::to_string(m_agentList.size()));
+	}
+	for (const auto& agentPtr : m_agentList) {
+		const std::string name = reader.readString();
+		if (name != agentPtr->name()) {
+			throw SimulationException("Simulation::loadSnapshot(): the snapshot holds the agent '" + name + "' where the simulation is configured with '" + agentPtr->name() + "'");
 		}
 	}
+	const std::uint64_t partitionCount = reader.read<std::uint64_t>();
+	if (partitionCount != m_partitions.size()) {
+		throw SimulationException("Simulation::loadSnapshot(): the snapshot holds " + std::to_string(partitionCount) + " partitions, the simulation is configured with " + std::to_string(m_partitions.size()));
+	}
+
+	for (RandomGenerator& randomGenerator : m_randomGenerators) {
+		RandomGenerator::State randomGeneratorState;
+		for (std::uint64_t& word : randomGeneratorState) {
+			word = reader.read<std::uint64_t>();
+		}
+		randomGenerator.setState(randomGeneratorState);
+	}
+	for (unsigned long long& dispatchCount : m_dispatchCounts) {
+		dispatchCount = reader.read<unsigned long long>();
+	}
+
+	for (const auto& partition : m_partitions) {
+		partition->currentTimestamp = reader.read<Timestamp>();
+
+		partition->messageQueue = createMessageQueue();
+		const std::uint64_t messageCount = reader.read<std::uint64_t>();
+		for (std::uint64_t index = 0; index < messageCount; ++index) {
+			partition->messageQueue->push(reader.readMessage(partition->messagePool));
+		}
+	}
+
+	for (const auto& agentPtr : m_agentList) {
+		agentPtr->loadState(reader);
+	}
+
+	m_state = state;
+}
+
+void Simulation::branchRandomGenerators(std::uint64_t branch) {
+	for (RandomGenerator& randomGenerator : m_randomGenerators) {
+		randomGenerator.branch(branch);
+	}
 }
 
 void Simulation::receiveMessage(const MessagePtr& msg) {
@@ -95,22 +381,62 @@ void Simulation::receiveMessage(const MessagePtr& msg) {
 }
 
 void Simulation::start() {
-	this->dispatchMessage(m_startTimestamp, 0, "SIMULATION", "*", "EVENT_SIMULATION_START", nullptr);
-	this->dispatchMessage(m_startTimestamp, m_durationTimestamp-1, "SIMULATION", "*", "EVENT_SIMULATION_STOP", nullptr);
+	this->dispatchMessage(m_startTimestamp, 0, AGENTID_SIMULATION, AGENTID_BROADCAST, MESSAGETYPE_EVENT_SIMULATION_START);
+	this->dispatchMessage(m_startTimestamp, m_durationTimestamp-1, AGENTID_SIMULATION, AGENTID_BROADCAST, MESSAGETYPE_EVENT_SIMULATION_STOP);
 
 	m_state = SimulationState::STARTED;
 }
 
 void Simulation::step(Timestamp step) {
-	Timestamp cutoff = m_currentTimestamp + step;
+	const Timestamp cutoff = currentTimestamp() + step;
+	if (m_partitions.size() == 1) {
+		stepPartition(*m_partitions.front(), cutoff);
+		return;
+	}
+
+	Timestamp windowEnd = cutoff;
+	PartitionWorkers workers(m_partitions.size(), [this, &windowEnd](size_t partitionIndex) {
+		stepPartition(*m_partitions[partitionIndex], windowEnd);
+	});
+
+	while (true) {
+		// idle time is skipped, the window starts with the earliest message of any partition
+		Timestamp windowStart = cutoff;
+		for (const auto& partition : m_partitions) {
+			if (!partition->messageQueue->empty()) {
+				windowStart = std::min(windowStart, partition->messageQueue->top()->arrival);
+			}
+		}
+		if (windowStart >= cutoff) {
+			break;
+		}
+
+		windowEnd = cutoff - windowStart > m_lookahead ? windowStart + m_lookahead : cutoff;
+		workers.runWindow();
+		exchangeOutboxes(windowEnd);
+	}
+
+	// between the steps the partitions agree on the time of the latest delivery
+	Timestamp latest = 0;
+	for (const auto& partition : m_partitions) {
+		latest = std::max(latest, partition->currentTimestamp);
+	}
+	for (const auto& partition : m_partitions) {
+		partition->currentTimestamp = latest;
+	}
+}
+
+void Simulation::stepPartition(SimulationPartition& partition, Timestamp cutoff) {
+	ActivePartitionScope scope(s_activePartition, &partition);
+	IMessageQueue& messageQueue = *partition.messageQueue;
 
 	Timestamp topMessageTimestamp;
-	while (!m_messageQueue->empty() && (topMessageTimestamp = m_messageQueue->top()->arrival) < cutoff) {
-		m_currentTimestamp = topMessageTimestamp;
+	while (!messageQueue.empty() && (topMessageTimestamp = messageQueue.top()->arrival) < cutoff) {
+		partition.currentTimestamp = topMessageTimestamp;
 
-		MessagePtr topMessage = m_messageQueue->top();
-		m_messageQueue->pop(); // ordering intentional
-		deliverMessage(topMessage);
+		MessagePtr topMessage = messageQueue.top();
+		messageQueue.pop(); // ordering intentional
+		deliverMessage(partition, topMessage);
 	}
 }
 
@@ -221,5 +547,155 @@ void Simulation::configure(const pugi::xml_node& node, const std::string& config
 		m_durationTimestamp = (Timestamp)att.as_ullong();
 	}
 
+	setupMessageQueue(node);
 	setupChildConfiguration(node, configurationPath);
+	assignAgentIds();
+	for (const auto& agentPtr : m_agentList) {
+		agentPtr->resolveAgentIds();
+	}
+	setupRandomGenerators(node);
+	setupPartitions(node);
+}
+
+void Simulation::assignAgentIds() {
+	// the agents are already sorted by name, the ids follow the same order
+	for (AgentId id = 0; id < (AgentId)m_agentList.size(); ++id) {
+		m_agentList[id]->m_id = id;
+	}
+
+	m_dispatchCounts.assign(m_agentList.size() + 1, 0);
+}
+
+void Simulation::setupRandomGenerators(const pugi::xml_node& node) {
+	// the attribute takes precedence over the seed parameter, e.g. set from the command line
+	pugi::xml_attribute att;
+	std::string seed;
+	if (!(att = node.attribute("seed")).empty()) {
+		seed = m_parameters->processString(att.as_string());
+	} else if (!m_parameters->tryGet("seed", seed)) {
+		seed = "0";
+	}
+	std::string runIndex;
+	if (!m_parameters->tryGet("runIndex", runIndex)) {
+		runIndex = "0";
+	}
+
+	m_seed = std::stoull(seed);
+
+	// the runs lie 2^192 draws apart and the agents of a run 2^128 apart, so each (seed, runIndex, agent id) has a stream of its own;
+	// the simulation takes the first stream of the run and the agent with the id i the one after i+1 jumps
+	RandomGenerator runGenerator(m_seed);
+	for (unsigned long long run = std::stoull(runIndex); run > 0; --run) {
+		runGenerator.longJump();
+	}
+
+	m_randomGenerators.assign(m_agentList.size() + 1, runGenerator);
+	for (AgentId id = 0; id < (AgentId)m_agentList.size(); ++id) {
+		runGenerator.jump();
+		m_randomGenerators[id] = runGenerator;
+	}
+}
+
+void Simulation::setupMessageQueue(const pugi::xml_node& node) {
+	pugi::xml_attribute att;
+	if (!(att = node.attribute("scheduler")).empty()) {
+		std::string scheduler = m_parameters->processString(att.as_string());
+		if (scheduler == "PriorityQueue") {
+			m_scheduler = scheduler;
+		} else if (scheduler == "TimingWheel") {
+			m_scheduler = scheduler;
+			if (!(att = node.attribute("wheelSize")).empty()) {
+				m_wheelSize = std::stoull(m_parameters->processString(att.as_string()));
+			}
+		} else {
+			throw SimulationException("Simulation::configure(): unknown scheduler '" + scheduler + "'");
+		}
+	}
+}
+
+std::unique_ptr<IMessageQueue> Simulation::createMessageQueue() const {
+	if (m_scheduler == "TimingWheel") {
+		return std::make_unique<TimingWheelMessageQueue>(m_wheelSize, m_tieOrder);
+	} else {
+		return std::make_unique<PriorityMessageQueue>(m_tieOrder);
+	}
+}
+
+void Simulation::setupPartitions(const pugi::xml_node& node) {
+	pugi::xml_attribute att;
+	bool parallel = false;
+	if (!(att = node.attribute("parallel")).empty()) {
+		parallel = m_parameters->processString(att.as_string()) == "true";
+	}
+	// ordered by delivery, a sequential run delivers exactly like a parallel one; the order of the pushes is an opt-out for the
+	// sequential runs only, as it depends on how the threads of a parallel one interleave
+	m_tieOrder = MessageTieOrder::Delivery;
+	if (!(att = node.attribute("tieOrder")).empty()) {
+		const std::string tieOrder = m_parameters->processString(att.as_string());
+		if (tieOrder == "Push" && !parallel) {
+			m_tieOrder = MessageTieOrder::Push;
+		} else if (tieOrder == "Push") {
+			throw SimulationException("Simulation::configure(): the parallel simulation needs the 'Delivery' tie order");
+		} else if (tieOrder != "Delivery") {
+			throw SimulationException("Simulation::configure(): unknown tie order '" + tieOrder + "'");
+		}
+	}
+
+	m_partitions.clear();
+	m_partitions.push_back(std::make_unique<SimulationPartition>(this, 0, m_startTimestamp, createMessageQueue()));
+	m_agentPartitions.assign(m_agentList.size(), 0);
+
+	if (parallel) {
+		// the agents sharing a partition key run together, in the order in which the keys first show up
+		std::unordered_map<std::string, size_t> partitionIndices;
+		for (const auto& agentPtr : m_agentList) {
+			const std::string& key = agentPtr->partition();
+			if (key.empty()) {
+				continue;
+			}
+
+			auto it = partitionIndices.find(key);
+			if (it == partitionIndices.end()) {
+				it = partitionIndices.emplace(key, m_partitions.size()).first;
+				m_partitions.push_back(std::make_unique<SimulationPartition>(this, m_partitions.size(), m_startTimestamp, createMessageQueue()));
+			}
+			m_agentPartitions[agentPtr->id()] = it->second;
+		}
+
+		// unless given, the lookahead is the shortest time an exchange takes to respond
+		m_lookahead = std::numeric_limits<Timestamp>::max();
+		if (!(att = node.attribute("lookahead")).empty()) {
+			m_lookahead = std::stoull(m_parameters->processString(att.as_string()));
+		} else {
+			for (const auto& agentPtr : m_agentList) {
+				if (const ExchangeAgent* exchange = dynamic_cast<const ExchangeAgent*>(agentPtr.get())) {
+					m_lookahead = std::min(m_lookahead, exchange->processingDelay());
+				}
+			}
+		}
+
+		if (m_partitions.size() > 1 && (m_lookahead == 0 || m_lookahead == std::numeric_limits<Timestamp>::max())) {
+			throw SimulationException("Simulation::configure(): the parallel simulation needs a positive lookahead, set the 'lookahead' attribute or the exchanges' 'processingDelay'");
+		}
+	}
+
+	for (AgentId id = 0; id < (AgentId)m_agentPartitions.size(); ++id) {
+		m_partitions[m_agentPartitions[id]]->agents.push_back(id);
+	}
+
+	// the first partition keeps the first stream of the run for the simulation, the others take the streams after the last agent's
+	RandomGenerator partitionGenerator = m_randomGenerators[m_agentList.empty() ? 0 : m_agentList.size() - 1];
+	m_randomGenerators.resize(m_agentList.size() + 1);
+	for (size_t index = 1; index < m_partitions.size(); ++index) {
+		partitionGenerator.jump();
+		m_randomGenerators.push_back(partitionGenerator);
+	}
+	m_dispatchCounts.assign(m_agentList.size() + m_partitions.size(), 0);
+
+	// the built-in types are known up front, only the types registered at runtime get their lists on first use
+	for (const auto& partition : m_partitions) {
+		for (MessageType type = 0; type < MESSAGETYPE_BUILTIN_COUNT; ++type) {
+			subscribers(*partition, type);
+		}
+	}
 }
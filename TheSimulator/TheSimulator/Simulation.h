@@ -6,9 +6,13 @@
 #include "Agent.h"
 #include "IConfigurable.h"
 #include "ParameterStorage.h"
+#include "IMessageQueue.h"
+#include "MessagePool.h"
+#include "SimulationPartition.h"
+#include "RandomGenerator.h"
 
+#include <iosfwd>
 #include <string>
-#include <queue>
 #include <vector>
 #include <memory>
 
@@ -24,13 +28,6 @@ enum class SimulationState {
 	STOPPED
 };
 
-struct CompareArrival {
-	bool operator()(const MessagePtr& a, const MessagePtr& b) {
-		// return true if b arrives before a
-		return a->arrival > b->arrival;
-	}
-};
-
 class ParameterStorage;
 
 class Simulation : public IMessageable, public IConfigurable {
@@ -42,21 +39,73 @@ public:
 	void simulate();
 	void simulate(Timestamp howMuch);
 
-	void queueMessage(const MessagePtr& messagePtr) const { m_messageQueue->push(messagePtr); }
+	void queueMessage(const MessagePtr& messagePtr) const {
+		if (m_partitions.size() == 1) {
+			m_partitions.front()->messageQueue->push(messagePtr);
+		} else {
+			routeMessage(messagePtr);
+		}
+	}
+	void dispatchMessage(Timestamp occurrence, Timestamp delay, AgentId source, AgentId target, MessageType type, MessagePayloadVariant payload = MessagePayloadVariant()) const {
+		MessagePtr messagePtr = activePartition().messagePool.acquire(occurrence, occurrence + delay, source, target, type, std::move(payload));
+		messagePtr->sequence = nextSequence(source);
+		queueMessage(messagePtr);
+	}
+	// a single message delivered to the targets in their order, they all see the one payload; no targets is no message
+	void dispatchMessage(Timestamp occurrence, Timestamp delay, AgentId source, const std::vector<AgentId>& targets, MessageType type, MessagePayloadVariant payload = MessagePayloadVariant()) const {
+		if (targets.empty()) {
+			return;
+		}
+		MessagePtr messagePtr = activePartition().messagePool.acquire(occurrence, occurrence + delay, source, targets, type, std::move(payload));
+		messagePtr->sequence = nextSequence(source);
+		queueMessage(messagePtr);
+	}
+	void dispatchMessage(Timestamp occurrence, Timestamp delay, AgentId source, const std::string& target, MessageType type, MessagePayloadVariant payload = MessagePayloadVariant()) const {
+		MessagePtr messagePtr = activePartition().messagePool.acquire(occurrence, occurrence + delay, source, resolveTargets(target, type), type, std::move(payload));
+		messagePtr->sequence = nextSequence(source);
+		queueMessage(messagePtr);
+	}
+	// the type has to be one of the registered ones, a misspelled type throws here rather than reaching the target
 	void dispatchMessage(Timestamp occurrence, Timestamp delay, const std::string& source, const std::string& target, const std::string& type, MessagePayloadPtr payload) const {
-		queueMessage(MessagePtr(new Message(occurrence, occurrence + delay, source, target, type, payload)));
+		dispatchMessage(occurrence, delay, agentId(source), target, MessageTypeRegistry::lookup(type), toMessagePayloadVariant(payload));
 	}
+	// generic messages may introduce new types, these get registered on first use
 	void dispatchGenericMessage(Timestamp occurrence, Timestamp delay, const std::string& source, const std::string& target, const std::string& type, const std::map<std::string, std::string>& payload) {
-		queueMessage(MessagePtr(new Message(occurrence, occurrence + delay, source, target, type, std::make_unique<GenericPayload>(payload))));
+		dispatchMessage(occurrence, delay, agentId(source), target, MessageTypeRegistry::intern(type), MessagePayloadPtr(std::make_shared<GenericPayload>(payload)));
 	}
 
 	void deliverMessage(const MessagePtr& messagePtr);
 
 	SimulationState state() const { return m_state; }
-	Timestamp currentTimestamp() const { return m_currentTimestamp; }
+	// while a parallel step runs, every partition keeps its own time
+	Timestamp currentTimestamp() const { return activePartition().currentTimestamp; }
 	ParameterStorage& parameters() const { return *m_parameters; }
 
-	std::mt19937 & randomGenerator() const { return *m_randomGenerator; };
+	AgentId agentId(const std::string& name) const;
+	const std::string& agentName(AgentId id) const;
+	// wildcard parts of the target only resolve to the agents consuming the type, "*" stays a single broadcast target
+	const std::vector<AgentId>& resolveTargets(const std::string& target, MessageType type) const;
+
+	// the stream of the agent handling the message being delivered, so that the draws of an agent do not depend on what the others do;
+	// the simulation itself has a stream in every partition
+	RandomGenerator& randomGenerator() const {
+		const AgentId agent = activePartition().currentAgent;
+		return m_randomGenerators[agent < m_agentList.size() ? agent : simulationSlot()];
+	}
+	std::uint64_t seed() const { return m_seed; }
+
+	size_t partitionCount() const { return m_partitions.size(); }
+	Timestamp lookahead() const { return m_lookahead; }
+
+	// A snapshot holds whatever the simulation changed since it was configured: the clocks, the queued messages, the random streams
+	// and the state of the agents. Loaded into a simulation configured from the same file which has not started yet, it carries on
+	// the way the one the snapshot was taken of would. Snapshots are taken and loaded between the steps only.
+	void saveSnapshot(const std::string& path) const;
+	void saveSnapshot(std::ostream& stream) const;
+	void loadSnapshot(const std::string& path);
+	void loadSnapshot(std::istream& stream);
+	// after loading a snapshot shared by several runs, gives every agent of this one its own stream from then on
+	void branchRandomGenerators(std::uint64_t branch);
 
 	// Inherited via IMessageable
 	virtual void receiveMessage(const MessagePtr& msg) override;
@@ -71,14 +120,55 @@ private:
 
 	Timestamp m_startTimestamp;
 	Timestamp m_durationTimestamp;
-	Timestamp m_currentTimestamp;
 	ParameterStorage* m_parameters;
 
-	std::random_device m_randomDevice;
-	std::unique_ptr<std::mt19937> m_randomGenerator;
+	std::uint64_t m_seed;
+	// one per agent, then one for the simulation in every partition, so that the threads running the partitions only touch their own
+	mutable std::vector<RandomGenerator> m_randomGenerators;
+	mutable std::vector<unsigned long long> m_dispatchCounts; // the same, counting the messages each of them dispatched
 
 	void setupChildConfiguration(const pugi::xml_node& node, const std::string& configurationPath);
+	void assignAgentIds();
+	void setupRandomGenerators(const pugi::xml_node& node);
+
+	std::string m_scheduler;
+	size_t m_wheelSize;
+	MessageTieOrder m_tieOrder; // by delivery unless a sequential simulation opts out, so that it delivers like a parallel one
+	void setupMessageQueue(const pugi::xml_node& node);
+	std::unique_ptr<IMessageQueue> createMessageQueue() const;
 
-	std::unique_ptr<std::priority_queue<MessagePtr, std::vector<MessagePtr>, CompareArrival>> m_messageQueue;
 	std::vector<std::unique_ptr<Agent>> m_agentList;
+
+	// The partitions run in parallel windows as long as the lookahead: a message between partitions has to arrive
+	// no sooner than the end of the window it was sent in, which is checked as the windows end.
+	std::vector<std::unique_ptr<SimulationPartition>> m_partitions;
+	std::vector<size_t> m_agentPartitions;
+	Timestamp m_lookahead;
+	void setupPartitions(const pugi::xml_node& node);
+
+	static thread_local SimulationPartition* s_activePartition;
+	SimulationPartition& activePartition() const {
+		if (m_partitions.size() > 1 && s_activePartition != nullptr && s_activePartition->simulation == this) {
+			return *s_activePartition;
+		}
+		return *m_partitions.front();
+	}
+	size_t partitionOf(AgentId target) const { return target < m_agentPartitions.size() ? m_agentPartitions[target] : 0; }
+	std::vector<AgentId> targetsIn(const Message& message, size_t partitionIndex) const;
+	void routeMessage(const MessagePtr& messagePtr) const;
+	void distributeMessage(const Message& message, size_t excludedPartitionIndex) const;
+	void exchangeOutboxes(Timestamp windowEnd);
+
+	size_t simulationSlot() const { return m_agentList.size() + activePartition().index; }
+	unsigned long long nextSequence(AgentId source) const {
+		if (source < m_agentList.size()) {
+			return m_dispatchCounts[source]++;
+		}
+		// the partitions take turns, so that no two messages of the simulation share a sequence
+		return m_dispatchCounts[simulationSlot()]++ * m_partitions.size() + activePartition().index;
+	}
+
+	void stepPartition(SimulationPartition& partition, Timestamp cutoff);
+	void deliverMessage(SimulationPartition& partition, const MessagePtr& messagePtr);
+	const std::vector<AgentId>& subscribers(SimulationPartition& partition, MessageType type);
 };
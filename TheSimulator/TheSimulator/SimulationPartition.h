@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Timestamp.h"
+#include "AgentId.h"
+#include "MessageType.h"
+#include "MessagePool.h"
+#include "IMessageQueue.h"
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Simulation;
+
+// A group of agents run as one logical process. The partition owns its clock, the messages addressed to its agents,
+// and everything cached lazily while dispatching, so that partitions running on different threads share no mutable state.
+// A simulation which is not parallel consists of a single partition holding every agent.
+struct SimulationPartition {
+	SimulationPartition(const Simulation* simulation, size_t index, Timestamp currentTimestamp, std::unique_ptr<IMessageQueue> messageQueue)
+		: simulation(simulation), index(index), currentTimestamp(currentTimestamp), currentAgent(AGENTID_SIMULATION),
+		messagePool(), messageQueue(std::move(messageQueue)), outbox(), agents(), subscribers(), resolvedTargets() { }
+	SimulationPartition(const SimulationPartition&) = delete;
+	SimulationPartition& operator=(const SimulationPartition&) = delete;
+
+	const Simulation* simulation;
+	size_t index;
+
+	Timestamp currentTimestamp;
+	AgentId currentAgent; // the agent handling the message being delivered, its stream serves the random draws
+
+	MessagePool messagePool; // declared before the queue so that it outlives the messages still queued
+	std::unique_ptr<IMessageQueue> messageQueue;
+	std::vector<MessagePtr> outbox; // messages for the other partitions, handed over once the window is over
+
+	std::vector<AgentId> agents;
+	std::deque<std::optional<std::vector<AgentId>>> subscribers; // indexed by the message type, a deque so that growing it leaves the lists being delivered to in place
+	std::unordered_map<std::string, std::unordered_map<MessageType, std::vector<AgentId>>> resolvedTargets;
+};
@@ -0,0 +1,565 @@
+#include "Snapshot.h"
+
+#include "ExchangeAgentMessagePayloads.h"
+#include "AdaptiveOfferingAgent.h"
+
+#include <cstring>
+#include <typeinfo>
+#include <utility>
+#include <variant>
+
+static const char SNAPSHOT_MAGIC[8] = { 'M', 'A', 'X', 'E', 'S', 'N', 'A', 'P' };
+static const std::uint32_t SNAPSHOT_VERSION = 11;
+
+// the payloads behind the MessagePayloadPtr alternative which can be saved
+enum class SnapshotPayloadKind : std::uint8_t {
+	Null,
+	Empty,
+	Generic,
+	WakeupForCancellation
+};
+
+namespace {
+
+struct PayloadWriter {
+	SnapshotWriter& writer;
+
+	void operator()(const std::monostate&) { }
+	void operator()(const ErrorResponsePayload& payload) { writer.writeString(payload.message); }
+	void operator()(const SuccessResponsePayload& payload) { writer.writeString(payload.message); }
+	void operator()(const PlaceOrderMarketPayload& payload) {
+		writer.write(payload.direction);
+		writer.write(payload.volume);
+		writer.write(payload.symbol);
+	}
+	void operator()(const PlaceOrderMarketResponsePayload& payload) {
+		writer.write(payload.id);
+		(*this)(payload.requestPayload);
+	}
+	void operator()(const PlaceOrderLimitPayload& payload) {
+		writer.write(payload.direction);
+		writer.write(payload.volume);
+		writer.writeMoney(payload.price);
+		writer.write(payload.symbol);
+	}
+	void operator()(const PlaceOrderLimitResponsePayload& payload) {
+		writer.write(payload.id);
+		(*this)(payload.requestPayload);
+	}
+	void operator()(const PlaceOrderStopPayload& payload) {
+		writer.write(payload.direction);
+		writer.write(payload.volume);
+		writer.writeMoney(payload.stopPrice);
+		writer.write(payload.limitPrice.has_value());
+		writer.writeMoney(payload.limitPrice.value_or(Money()));
+		writer.write(payload.symbol);
+	}
+	void operator()(const PlaceOrderStopResponsePayload& payload) {
+		writer.write(payload.id);
+		(*this)(payload.requestPayload);
+	}
+	void operator()(const RetrieveOrdersPayload& payload) {
+		writer.write((std::uint64_t)payload.ids.size());
+		for (OrderID id : payload.ids) {
+			writer.write(id);
+		}
+		writer.write(payload.symbol);
+	}
+	void operator()(const RetrieveOrdersResponsePayload& payload) {
+		writer.write((std::uint64_t)payload.orders.size());
+		for (const LimitOrder& order : payload.orders) {
+			writer.writeLimitOrder(order);
+		}
+	}
+	void operator()(const CancelOrdersPayload& payload) {
+		writer.write((std::uint64_t)payload.cancellations.size());
+		for (const CancelOrdersCancellation& cancellation : payload.cancellations) {
+			writer.write(cancellation.id);
+			writer.write(cancellation.volume);
+		}
+		writer.write(payload.symbol);
+	}
+	void operator()(const AmendOrdersPayload& payload) {
+		writer.write((std::uint64_t)payload.amendments.size());
+		for (const AmendOrdersAmendment& amendment : payload.amendments) {
+			writer.write(amendment.id);
+			writer.write(amendment.volume);
+		}
+		writer.write(payload.symbol);
+	}
+	void operator()(const ReplaceOrdersPayload& payload) {
+		writer.write((std::uint64_t)payload.replacements.size());
+		for (const ReplaceOrdersReplacement& replacement : payload.replacements) {
+			writer.write(replacement.id);
+			writer.write(replacement.direction);
+			writer.write(replacement.volume);
+			writer.writeMoney(replacement.price);
+		}
+		writer.write(payload.symbol);
+	}
+	void operator()(const ReplaceOrdersResponsePayload& payload) {
+		writer.write((std::uint64_t)payload.ids.size());
+		for (OrderID id : payload.ids) {
+			writer.write(id);
+		}
+		(*this)(payload.requestPayload);
+	}
+	void operator()(const RetrieveBookPayload& payload) {
+		writer.write(payload.depth);
+		writer.write(payload.symbol);
+	}
+	void operator()(const RetrieveBookResponsePayload& payload) {
+		writer.write(payload.time);
+		writer.write((std::uint64_t)payload.tickContainers.size());
+		for (const TickContainer& tickContainer : payload.tickContainers) {
+			writer.writeTickContainer(tickContainer);
+		}
+		writer.write(payload.symbol);
+	}
+	void operator()(const RetrieveL1Payload& payload) { writer.write(payload.symbol); }
+	void operator()(const RetrieveL1ResponsePayload& payload) {
+		writer.write(payload.time);
+		writer.writeMoney(payload.bestAskPrice);
+		writer.write(payload.bestAskVolume);
+		writer.write(payload.askTotalVolume);
+		writer.writeMoney(payload.bestBidPrice);
+		writer.write(payload.bestBidVolume);
+		writer.write(payload.bidTotalVolume);
+		writer.write(payload.symbol);
+	}
+	void operator()(const SubscribeEventPayload& payload) { writer.write(payload.symbol); }
+	void operator()(const SubscribeEventTradeByOrderPayload& payload) {
+		writer.write(payload.id);
+		writer.write(payload.symbol);
+	}
+	void operator()(const EventOrderMarketPayload& payload) {
+		writer.writeMarketOrder(payload.order);
+		writer.write(payload.symbol);
+	}
+	void operator()(const EventOrderLimitPayload& payload) {
+		writer.writeLimitOrder(payload.order);
+		writer.write(payload.symbol);
+	}
+	void operator()(const EventTradePayload& payload) {
+		writer.writeTrade(payload.trade);
+		writer.write(payload.symbol);
+	}
+	void operator()(const EventExecutionPayload& payload) {
+		writer.writeTrade(payload.trade);
+		writer.write(payload.id);
+		writer.write(payload.symbol);
+	}
+	void operator()(const MessagePayloadPtr& payloadPtr) {
+		if (payloadPtr == nullptr) {
+			writer.write(SnapshotPayloadKind::Null);
+		} else if (const auto* generic = dynamic_cast<const GenericPayload*>(payloadPtr.get())) {
+			writer.write(SnapshotPayloadKind::Generic);
+			writer.write((std::uint64_t)generic->size());
+			for (const auto& [key, value] : *generic) {
+				writer.writeString(key);
+				writer.writeString(value);
+			}
+		} else if (const auto* wakeup = dynamic_cast<const WakeupForCancellationPayload*>(payloadPtr.get())) {
+			writer.write(SnapshotPayloadKind::WakeupForCancellation);
+			writer.write(wakeup->orderToCancelId);
+		} else if (dynamic_cast<const EmptyPayload*>(payloadPtr.get()) != nullptr) {
+			writer.write(SnapshotPayloadKind::Empty);
+		} else {
+			throw SimulationException(std::string("SnapshotWriter::writePayload(): payloads of type '") + typeid(*payloadPtr).name() + "' can not be saved");
+		}
+	}
+};
+
+MessagePayloadVariant readPayloadOf(SnapshotReader&, std::in_place_type_t<std::monostate>) {
+	return std::monostate();
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<ErrorResponsePayload>) {
+	return ErrorResponsePayload(reader.readString());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<SuccessResponsePayload>) {
+	return SuccessResponsePayload(reader.readString());
+}
+
+PlaceOrderMarketPayload readPlaceOrderMarketPayload(SnapshotReader& reader) {
+	const OrderDirection direction = reader.read<OrderDirection>();
+	const Volume volume = reader.read<Volume>();
+	const SymbolId symbol = reader.read<SymbolId>();
+	return PlaceOrderMarketPayload(direction, volume, symbol);
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<PlaceOrderMarketPayload>) {
+	return readPlaceOrderMarketPayload(reader);
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<PlaceOrderMarketResponsePayload>) {
+	const OrderID id = reader.read<OrderID>();
+	return PlaceOrderMarketResponsePayload(id, readPlaceOrderMarketPayload(reader));
+}
+
+PlaceOrderLimitPayload readPlaceOrderLimitPayload(SnapshotReader& reader) {
+	const OrderDirection direction = reader.read<OrderDirection>();
+	const Volume volume = reader.read<Volume>();
+	const Money price = reader.readMoney();
+	const SymbolId symbol = reader.read<SymbolId>();
+	return PlaceOrderLimitPayload(direction, volume, price, symbol);
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<PlaceOrderLimitPayload>) {
+	return readPlaceOrderLimitPayload(reader);
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<PlaceOrderLimitResponsePayload>) {
+	const OrderID id = reader.read<OrderID>();
+	return PlaceOrderLimitResponsePayload(id, readPlaceOrderLimitPayload(reader));
+}
+
+PlaceOrderStopPayload readPlaceOrderStopPayload(SnapshotReader& reader) {
+	const OrderDirection direction = reader.read<OrderDirection>();
+	const Volume volume = reader.read<Volume>();
+	const Money stopPrice = reader.readMoney();
+	const bool limit = reader.read<bool>();
+	const Money limitPrice = reader.readMoney();
+	const SymbolId symbol = reader.read<SymbolId>();
+	return PlaceOrderStopPayload(direction, volume, stopPrice, limit ? std::optional<Money>(limitPrice) : std::nullopt, symbol);
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<PlaceOrderStopPayload>) {
+	return readPlaceOrderStopPayload(reader);
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<PlaceOrderStopResponsePayload>) {
+	const OrderID id = reader.read<OrderID>();
+	return PlaceOrderStopResponsePayload(id, readPlaceOrderStopPayload(reader));
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<RetrieveOrdersPayload>) {
+	std::vector<OrderID> ids(reader.read<std::uint64_t>());
+	for (OrderID& id : ids) {
+		id = reader.read<OrderID>();
+	}
+	return RetrieveOrdersPayload(ids, reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<RetrieveOrdersResponsePayload>) {
+	RetrieveOrdersResponsePayload payload;
+	const std::uint64_t count = reader.read<std::uint64_t>();
+	payload.orders.reserve(count);
+	for (std::uint64_t index = 0; index < count; ++index) {
+		payload.orders.push_back(reader.readLimitOrder());
+	}
+	return payload;
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<CancelOrdersPayload>) {
+	CancelOrdersPayload payload;
+	const std::uint64_t count = reader.read<std::uint64_t>();
+	payload.cancellations.reserve(count);
+	for (std::uint64_t index = 0; index < count; ++index) {
+		const OrderID id = reader.read<OrderID>();
+		const Volume volume = reader.read<Volume>();
+		payload.cancellations.emplace_back(id, volume);
+	}
+	payload.symbol = reader.read<SymbolId>();
+	return payload;
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<AmendOrdersPayload>) {
+	AmendOrdersPayload payload;
+	const std::uint64_t count = reader.read<std::uint64_t>();
+	payload.amendments.reserve(count);
+	for (std::uint64_t index = 0; index < count; ++index) {
+		const OrderID id = reader.read<OrderID>();
+		const Volume volume = reader.read<Volume>();
+		payload.amendments.emplace_back(id, volume);
+	}
+	payload.symbol = reader.read<SymbolId>();
+	return payload;
+}
+
+ReplaceOrdersPayload readReplaceOrdersPayload(SnapshotReader& reader) {
+	ReplaceOrdersPayload payload;
+	const std::uint64_t count = reader.read<std::uint64_t>();
+	payload.replacements.reserve(count);
+	for (std::uint64_t index = 0; index < count; ++index) {
+		const OrderID id = reader.read<OrderID>();
+		const OrderDirection direction = reader.read<OrderDirection>();
+		const Volume volume = reader.read<Volume>();
+		const Money price = reader.readMoney();
+		payload.replacements.emplace_back(id, direction, volume, price);
+	}
+	payload.symbol = reader.read<SymbolId>();
+	return payload;
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<ReplaceOrdersPayload>) {
+	return readReplaceOrdersPayload(reader);
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<ReplaceOrdersResponsePayload>) {
+	std::vector<OrderID> ids(reader.read<std::uint64_t>());
+	for (OrderID& id : ids) {
+		id = reader.read<OrderID>();
+	}
+	return ReplaceOrdersResponsePayload(ids, readReplaceOrdersPayload(reader));
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<RetrieveBookPayload>) {
+	const unsigned int depth = reader.read<unsigned int>();
+	return RetrieveBookPayload(depth, reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<RetrieveBookResponsePayload>) {
+	RetrieveBookResponsePayload payload(reader.read<Timestamp>());
+	const std::uint64_t count = reader.read<std::uint64_t>();
+	payload.tickContainers.reserve(count);
+	for (std::uint64_t index = 0; index < count; ++index) {
+		payload.tickContainers.push_back(reader.readTickContainer());
+	}
+	payload.symbol = reader.read<SymbolId>();
+	return payload;
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<RetrieveL1Payload>) {
+	return RetrieveL1Payload(reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<RetrieveL1ResponsePayload>) {
+	RetrieveL1ResponsePayload payload;
+	payload.time = reader.read<Timestamp>();
+	payload.bestAskPrice = reader.readMoney();
+	payload.bestAskVolume = reader.read<Volume>();
+	payload.askTotalVolume = reader.read<Volume>();
+	payload.bestBidPrice = reader.readMoney();
+	payload.bestBidVolume = reader.read<Volume>();
+	payload.bidTotalVolume = reader.read<Volume>();
+	payload.symbol = reader.read<SymbolId>();
+	return payload;
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<SubscribeEventPayload>) {
+	return SubscribeEventPayload(reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<SubscribeEventTradeByOrderPayload>) {
+	const OrderID id = reader.read<OrderID>();
+	return SubscribeEventTradeByOrderPayload(id, reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<EventOrderMarketPayload>) {
+	const MarketOrder order = reader.readMarketOrder();
+	return EventOrderMarketPayload(order, reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<EventOrderLimitPayload>) {
+	const LimitOrder order = reader.readLimitOrder();
+	return EventOrderLimitPayload(order, reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<EventTradePayload>) {
+	const Trade trade = reader.readTrade();
+	return EventTradePayload(trade, reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<EventExecutionPayload>) {
+	const Trade trade = reader.readTrade();
+	const OrderID id = reader.read<OrderID>();
+	return EventExecutionPayload(trade, id, reader.read<SymbolId>());
+}
+
+MessagePayloadVariant readPayloadOf(SnapshotReader& reader, std::in_place_type_t<MessagePayloadPtr>) {
+	switch (reader.read<SnapshotPayloadKind>()) {
+	case SnapshotPayloadKind::Null:
+		return MessagePayloadPtr();
+	case SnapshotPayloadKind::Empty:
+		return MessagePayloadPtr(std::make_shared<EmptyPayload>());
+	case SnapshotPayloadKind::Generic: {
+		std::map<std::string, std::string> entries;
+		const std::uint64_t count = reader.read<std::uint64_t>();
+		for (std::uint64_t index = 0; index < count; ++index) {
+			std::string key = reader.readString();
+			entries[key] = reader.readString();
+		}
+		return MessagePayloadPtr(std::make_shared<GenericPayload>(entries));
+	}
+	case SnapshotPayloadKind::WakeupForCancellation:
+		return MessagePayloadPtr(std::make_shared<WakeupForCancellationPayload>(reader.read<OrderID>()));
+	default:
+		throw SimulationException("SnapshotReader::readPayload(): unknown payload kind");
+	}
+}
+
+template<size_t Index = 0>
+MessagePayloadVariant readAlternative(SnapshotReader& reader, size_t alternative) {
+	if constexpr (Index < std::variant_size_v<MessagePayloadVariant>) {
+		if (alternative == Index) {
+			return readPayloadOf(reader, std::in_place_type<std::variant_alternative_t<Index, MessagePayloadVariant>>);
+		}
+		return readAlternative<Index + 1>(reader, alternative);
+	} else {
+		throw SimulationException("SnapshotReader::readPayload(): unknown payload alternative " + std::to_string(alternative));
+	}
+}
+
+}
+
+SnapshotWriter::SnapshotWriter(std::ostream& stream)
+	: m_stream(stream) {
+	m_stream.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	write(SNAPSHOT_VERSION);
+}
+
+void SnapshotWriter::writeString(const std::string& value) {
+	write((std::uint64_t)value.size());
+	m_stream.write(value.data(), value.size());
+}
+
+void SnapshotWriter::writeMoney(const Money& value) {
+	write(value.internalValue());
+}
+
+void SnapshotWriter::writeMarketOrder(const MarketOrder& order) {
+	write(order.id());
+	write(order.direction());
+	write(order.timestamp());
+	write(order.volume());
+}
+
+void SnapshotWriter::writeLimitOrder(const LimitOrder& order) {
+	write(order.id());
+	write(order.direction());
+	write(order.timestamp());
+	write(order.volume());
+	writeMoney(order.price());
+}
+
+void SnapshotWriter::writeTrade(const Trade& trade) {
+	write(trade.id());
+	write(trade.timestamp());
+	write(trade.direction());
+	write(trade.aggressingOrderID());
+	write(trade.restingOrderID());
+	write(trade.volume());
+	writeMoney(trade.price());
+	write(trade.aggressingAgent());
+	write(trade.restingAgent());
+}
+
+void SnapshotWriter::writeTickContainer(const TickContainer& tickContainer) {
+	writeMoney(tickContainer.price());
+	write((std::uint64_t)tickContainer.size());
+	for (const LimitOrderPtr& order : tickContainer) {
+		writeLimitOrder(*order);
+	}
+}
+
+void SnapshotWriter::writePayload(const MessagePayloadVariant& payload) {
+	write((std::uint32_t)payload.index());
+	std::visit(PayloadWriter{ *this }, payload);
+}
+
+void SnapshotWriter::writeMessage(const Message& message) {
+	write(message.occurrence);
+	write(message.arrival);
+	write(message.source);
+	write(message.sequence);
+	write((std::uint64_t)message.targets.size());
+	for (AgentId target : message.targets) {
+		write(target);
+	}
+	// by name, the types registered at runtime need not get the same ids when the snapshot is loaded
+	writeString(MessageTypeRegistry::name(message.type));
+	writePayload(message.payload);
+}
+
+SnapshotReader::SnapshotReader(std::istream& stream)
+	: m_stream(stream) {
+	char magic[sizeof(SNAPSHOT_MAGIC)];
+	m_stream.read(magic, sizeof(magic));
+	if (!m_stream || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+		throw SimulationException("SnapshotReader::SnapshotReader(): the file is not a simulation snapshot");
+	}
+
+	const std::uint32_t version = read<std::uint32_t>();
+	if (version != SNAPSHOT_VERSION) {
+		throw SimulationException("SnapshotReader::SnapshotReader(): unsupported snapshot version " + std::to_string(version));
+	}
+}
+
+void SnapshotReader::readBytes(char* bytes, size_t count) {
+	m_stream.read(bytes, count);
+	if (!m_stream) {
+		throw SimulationException("SnapshotReader::read(): the snapshot ends prematurely");
+	}
+}
+
+std::string SnapshotReader::readString() {
+	std::string value(read<std::uint64_t>(), '\0');
+	readBytes(value.data(), value.size());
+	return value;
+}
+
+Money SnapshotReader::readMoney() {
+	return Money(Decimal::fromInternalValue(read<signed long long int>()));
+}
+
+MarketOrder SnapshotReader::readMarketOrder() {
+	const OrderID id = read<OrderID>();
+	const OrderDirection direction = read<OrderDirection>();
+	const Timestamp timestamp = read<Timestamp>();
+	const Volume volume = read<Volume>();
+	return MarketOrder(id, direction, timestamp, volume);
+}
+
+LimitOrder SnapshotReader::readLimitOrder() {
+	const OrderID id = read<OrderID>();
+	const OrderDirection direction = read<OrderDirection>();
+	const Timestamp timestamp = read<Timestamp>();
+	const Volume volume = read<Volume>();
+	const Money price = readMoney();
+	return LimitOrder(id, direction, timestamp, volume, price);
+}
+
+Trade SnapshotReader::readTrade() {
+	const TradeID id = read<TradeID>();
+	const Timestamp timestamp = read<Timestamp>();
+	const OrderDirection direction = read<OrderDirection>();
+	const OrderID aggressingOrderID = read<OrderID>();
+	const OrderID restingOrderID = read<OrderID>();
+	const Volume volume = read<Volume>();
+	const Money price = readMoney();
+	const AgentId aggressingAgent = read<AgentId>();
+	const AgentId restingAgent = read<AgentId>();
+	return Trade(id, timestamp, direction, aggressingOrderID, restingOrderID, volume, price, aggressingAgent, restingAgent);
+}
+
+TickContainer SnapshotReader::readTickContainer() {
+	TickContainer tickContainer(readMoney());
+	const std::uint64_t count = read<std::uint64_t>();
+	for (std::uint64_t index = 0; index < count; ++index) {
+		tickContainer.push_back(std::make_shared<LimitOrder>(readLimitOrder()));
+	}
+	return tickContainer;
+}
+
+MessagePayloadVariant SnapshotReader::readPayload() {
+	return readAlternative(*this, read<std::uint32_t>());
+}
+
+MessagePtr SnapshotReader::readMessage(MessagePool& pool) {
+	const Timestamp occurrence = read<Timestamp>();
+	const Timestamp arrival = read<Timestamp>();
+	const AgentId source = read<AgentId>();
+	const unsigned long long sequence = read<unsigned long long>();
+	std::vector<AgentId> targets(read<std::uint64_t>());
+	for (AgentId& target : targets) {
+		target = read<AgentId>();
+	}
+	const MessageType type = MessageTypeRegistry::intern(readString());
+	MessagePayloadVariant payload = readPayload();
+
+	MessagePtr messagePtr = pool.acquire(occurrence, arrival, source, targets, type, std::move(payload));
+	messagePtr->sequence = sequence;
+	return messagePtr;
+}
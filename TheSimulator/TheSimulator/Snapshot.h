@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Money.h"
+#include "Order.h"
+#include "Trade.h"
+#include "Book.h"
+#include "Message.h"
+#include "MessagePool.h"
+#include "SimulationException.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+// The binary encoding of the simulation snapshots. Numbers are written the way they lie in memory, so a snapshot
+// is meant to be read back by a build for the same platform; the header only tells the snapshots from other files.
+class SnapshotWriter {
+public:
+	SnapshotWriter(std::ostream& stream);
+
+	template<class T>
+	void write(T value) {
+		static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "only numbers and enums are written as they are");
+		m_stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+	void writeString(const std::string& value);
+	void writeMoney(const Money& value);
+	void writeMarketOrder(const MarketOrder& order);
+	void writeLimitOrder(const LimitOrder& order);
+	void writeTrade(const Trade& trade);
+	void writeTickContainer(const TickContainer& tickContainer);
+	void writePayload(const MessagePayloadVariant& payload);
+	void writeMessage(const Message& message);
+private:
+	std::ostream& m_stream;
+};
+
+class SnapshotReader {
+public:
+	SnapshotReader(std::istream& stream);
+
+	template<class T>
+	T read() {
+		static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "only numbers and enums are read as they are");
+		T value;
+		readBytes(reinterpret_cast<char*>(&value), sizeof(T));
+		return value;
+	}
+	std::string readString();
+	Money readMoney();
+	MarketOrder readMarketOrder();
+	LimitOrder readLimitOrder();
+	Trade readTrade();
+	TickContainer readTickContainer();
+	MessagePayloadVariant readPayload();
+	// the message comes from the given pool, the same way as the ones dispatched while simulating
+	MessagePtr readMessage(MessagePool& pool);
+private:
+	std::istream& m_stream;
+
+	void readBytes(char* bytes, size_t count);
+};
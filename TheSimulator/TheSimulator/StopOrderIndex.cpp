@@ -0,0 +1,85 @@
+#include "StopOrderIndex.h"
+#include "Snapshot.h"
+
+void StopOrderIndex::insert(const StopOrder& order) {
+	Stops& stops = order.direction == OrderDirection::Buy ? m_buyStops : m_sellStops;
+	// the equal ranks keep the order of insertion
+	m_byId.emplace(order.id, stops.emplace(rankOf(order.direction, order.stopPrice), order));
+}
+
+StopOrder* StopOrderIndex::find(OrderID id) {
+	auto it = m_byId.find(id);
+	return it != m_byId.end() ? &it->second->second : nullptr;
+}
+
+const StopOrder* StopOrderIndex::find(OrderID id) const {
+	auto it = m_byId.find(id);
+	return it != m_byId.end() ? &it->second->second : nullptr;
+}
+
+void StopOrderIndex::erase(OrderID id) {
+	auto it = m_byId.find(id);
+	if (it == m_byId.end()) {
+		return;
+	}
+
+	(it->second->second.direction == OrderDirection::Buy ? m_buyStops : m_sellStops).erase(it->second);
+	m_byId.erase(it);
+}
+
+void StopOrderIndex::clear() {
+	m_buyStops.clear();
+	m_sellStops.clear();
+	m_byId.clear();
+}
+
+void StopOrderIndex::trigger(Price highest, Price lowest, std::vector<StopOrder>& triggered) {
+	takeTriggered(m_buyStops, rankOf(OrderDirection::Buy, highest), triggered);
+	takeTriggered(m_sellStops, rankOf(OrderDirection::Sell, lowest), triggered);
+}
+
+void StopOrderIndex::takeTriggered(Stops& stops, long long rank, std::vector<StopOrder>& triggered) {
+	const auto end = stops.upper_bound(rank);
+	for (auto it = stops.begin(); it != end; ++it) {
+		triggered.push_back(it->second);
+		m_byId.erase(it->second.id);
+	}
+	stops.erase(stops.begin(), end);
+}
+
+void StopOrderIndex::saveState(SnapshotWriter& writer) const {
+	for (const Stops* stops : { &m_buyStops, &m_sellStops }) {
+		writer.write((std::uint64_t)stops->size());
+		for (const auto& [rank, order] : *stops) {
+			writer.write(order.id);
+			writer.write(order.timestamp);
+			writer.write(order.stopPrice.ticks());
+			writer.writeMoney(order.limitPrice);
+			writer.write(order.volume);
+			writer.write(order.owner);
+			writer.write(order.direction);
+			writer.write(order.limit);
+		}
+	}
+}
+
+void StopOrderIndex::loadState(SnapshotReader& reader) {
+	clear();
+
+	// the stops of either side come in the order they trigger, and go back in the same order
+	for (int side = 0; side < 2; ++side) {
+		const std::uint64_t count = reader.read<std::uint64_t>();
+		for (std::uint64_t index = 0; index < count; ++index) {
+			StopOrder order;
+			order.id = reader.read<OrderID>();
+			order.timestamp = reader.read<Timestamp>();
+			order.stopPrice = Price(reader.read<long long>());
+			order.limitPrice = reader.readMoney();
+			order.volume = reader.read<Volume>();
+			order.owner = reader.read<AgentId>();
+			order.direction = reader.read<OrderDirection>();
+			order.limit = reader.read<bool>();
+			insert(order);
+		}
+	}
+}
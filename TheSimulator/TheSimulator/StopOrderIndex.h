@@ -0,0 +1,65 @@
+#pragma once
+
+#include "AgentId.h"
+#include "Money.h"
+#include "Order.h"
+#include "Price.h"
+#include "Timestamp.h"
+#include "Volume.h"
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// An order waiting in the book for the price to reach its stop: a buy stop triggers on a trade at its stop price or above it,
+// a sell stop on one at its stop price or below it. It then goes into the book as a market order, or as a limit order at its
+// limit price, under the id it was given when it was placed.
+struct StopOrder {
+	OrderID id;
+	Timestamp timestamp;
+	Price stopPrice;
+	Money limitPrice; // of a stop-limit order only
+	Volume volume;
+	AgentId owner;
+	OrderDirection direction;
+	bool limit; // a stop-limit order rather than a stop-market one
+};
+
+// The stop orders of a book by their stop prices. Like in the price ladder, the stop prices are ranked so that a lower rank
+// triggers first, whichever the side: the buy stops from the lowest stop price up, the sell stops from the highest one down,
+// the stops at the same price in the order they were placed. The trades then trigger the k stops they reach in O(log n + k),
+// the buy stops before the sell stops.
+class StopOrderIndex {
+public:
+	bool empty() const { return m_byId.empty(); }
+	size_t size() const { return m_byId.size(); }
+	bool contains(OrderID id) const { return m_byId.find(id) != m_byId.end(); }
+
+	void insert(const StopOrder& order);
+	// nullptr unless the stop order waits in the index; the volume may change through it
+	StopOrder* find(OrderID id);
+	const StopOrder* find(OrderID id) const;
+	// a no-op for an order not in the index
+	void erase(OrderID id);
+	void clear();
+
+	// the stops the trades between the prices trigger, the buy stops up to the highest and the sell stops down to the lowest,
+	// taken out of the index and appended in the order they trigger
+	void trigger(Price highest, Price lowest, std::vector<StopOrder>& triggered);
+
+	void saveState(SnapshotWriter& writer) const;
+	void loadState(SnapshotReader& reader);
+private:
+	using Stops = std::multimap<long long, StopOrder>; // by the rank of the stop price
+
+	Stops m_buyStops;
+	Stops m_sellStops;
+	std::unordered_map<OrderID, Stops::iterator> m_byId;
+
+	static long long rankOf(OrderDirection direction, Price price) { return direction == OrderDirection::Buy ? price.ticks() : -price.ticks(); }
+	void takeTriggered(Stops& stops, long long rank, std::vector<StopOrder>& triggered);
+};
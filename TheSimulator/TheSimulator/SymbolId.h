@@ -0,0 +1,5 @@
+#pragma once
+
+using SymbolId = unsigned int;
+
+constexpr SymbolId SYMBOLID_ALL = (SymbolId)-1; // subscribes to the events of every symbol of the exchange
@@ -10,7 +10,7 @@ PYBIND11_EMBEDDED_MODULE(thesimulator, m) {
 	py::class_<Simulation>(m, "Simulation")
 		.def("currentTimestamp", &Simulation::currentTimestamp)
 		.def("dispatchGenericMessage", &Simulation::dispatchGenericMessage)
-		.def("dispatchMessage", &Simulation::dispatchMessage)
+		.def("dispatchMessage", py::overload_cast<Timestamp, Timestamp, const std::string&, const std::string&, const std::string&, MessagePayloadPtr>(&Simulation::dispatchMessage, py::const_))
 		.def("queueMessage", &Simulation::queueMessage)
 		;
 
@@ -94,32 +94,55 @@ PYBIND11_EMBEDDED_MODULE(thesimulator, m) {
 
 	py::class_<PlaceOrderMarketPayload, MessagePayload, std::shared_ptr<PlaceOrderMarketPayload>>(m, "PlaceOrderMarketPayload")
 		.def(py::init<OrderDirection, Volume>())
+		.def(py::init<OrderDirection, Volume, SymbolId>())
 		.def_readwrite("direction", &PlaceOrderMarketPayload::direction)
 		.def_readwrite("volume", &PlaceOrderMarketPayload::volume)
+		.def_readwrite("symbol", &PlaceOrderMarketPayload::symbol)
 		;
 
 	py::class_<PlaceOrderMarketResponsePayload, MessagePayload, std::shared_ptr<PlaceOrderMarketResponsePayload>>(m, "PlaceOrderMarketResponsePayload")
-		.def(py::init<OrderID, const std::shared_ptr<PlaceOrderMarketPayload>&>())
+		.def(py::init<OrderID, const PlaceOrderMarketPayload&>())
 		.def_readwrite("id", &PlaceOrderMarketResponsePayload::id)
 		.def_readwrite("requestPayload", &PlaceOrderMarketResponsePayload::requestPayload)
 		;
 	
 	py::class_<PlaceOrderLimitPayload, MessagePayload, std::shared_ptr<PlaceOrderLimitPayload>>(m, "PlaceOrderLimitPayload")
 		.def(py::init<OrderDirection, Volume, Money>())
+		.def(py::init<OrderDirection, Volume, Money, SymbolId>())
 		.def_readwrite("direction", &PlaceOrderLimitPayload::direction)
 		.def_readwrite("volume", &PlaceOrderLimitPayload::volume)
 		.def_readwrite("price", &PlaceOrderLimitPayload::price)
+		.def_readwrite("symbol", &PlaceOrderLimitPayload::symbol)
 		;
 
 	py::class_<PlaceOrderLimitResponsePayload, MessagePayload, std::shared_ptr<PlaceOrderLimitResponsePayload>>(m, "PlaceOrderLimitResponsePayload")
-		.def(py::init<OrderID, const std::shared_ptr<PlaceOrderLimitPayload>&>())
+		.def(py::init<OrderID, const PlaceOrderLimitPayload&>())
 		.def_readwrite("id", &PlaceOrderLimitResponsePayload::id)
 		.def_readwrite("requestPayload", &PlaceOrderLimitResponsePayload::requestPayload)
 		;
 
+	py::class_<PlaceOrderStopPayload, MessagePayload, std::shared_ptr<PlaceOrderStopPayload>>(m, "PlaceOrderStopPayload")
+		.def(py::init<OrderDirection, Volume, Money>())
+		.def(py::init<OrderDirection, Volume, Money, std::optional<Money>>())
+		.def(py::init<OrderDirection, Volume, Money, std::optional<Money>, SymbolId>())
+		.def_readwrite("direction", &PlaceOrderStopPayload::direction)
+		.def_readwrite("volume", &PlaceOrderStopPayload::volume)
+		.def_readwrite("stopPrice", &PlaceOrderStopPayload::stopPrice)
+		.def_readwrite("limitPrice", &PlaceOrderStopPayload::limitPrice)
+		.def_readwrite("symbol", &PlaceOrderStopPayload::symbol)
+		;
+
+	py::class_<PlaceOrderStopResponsePayload, MessagePayload, std::shared_ptr<PlaceOrderStopResponsePayload>>(m, "PlaceOrderStopResponsePayload")
+		.def(py::init<OrderID, const PlaceOrderStopPayload&>())
+		.def_readwrite("id", &PlaceOrderStopResponsePayload::id)
+		.def_readwrite("requestPayload", &PlaceOrderStopResponsePayload::requestPayload)
+		;
+
 	py::class_<RetrieveOrdersPayload, MessagePayload, std::shared_ptr<RetrieveOrdersPayload>>(m, "RetrieveOrdersPayload")
 		.def(py::init<const std::vector<OrderID>&>())
+		.def(py::init<const std::vector<OrderID>&, SymbolId>())
 		.def_readwrite("ids", &RetrieveOrdersPayload::ids)
+		.def_readwrite("symbol", &RetrieveOrdersPayload::symbol)
 		;
 
 	py::class_<RetrieveOrdersResponsePayload, MessagePayload, std::shared_ptr<RetrieveOrdersResponsePayload>>(m, "RetrieveOrdersResponsePayload")
@@ -135,26 +158,69 @@ PYBIND11_EMBEDDED_MODULE(thesimulator, m) {
 
 	py::class_<CancelOrdersPayload, MessagePayload, std::shared_ptr<CancelOrdersPayload>>(m, "CancelOrdersPayload")
 		.def(py::init<const std::vector<CancelOrdersCancellation>&>())
+		.def(py::init<const std::vector<CancelOrdersCancellation>&, SymbolId>())
 		.def_readwrite("cancellations", &CancelOrdersPayload::cancellations)
+		.def_readwrite("symbol", &CancelOrdersPayload::symbol)
+		;
+
+	py::class_<AmendOrdersAmendment>(m, "AmendOrdersAmendment")
+		.def(py::init<OrderID, Volume>())
+		.def_readwrite("id", &AmendOrdersAmendment::id)
+		.def_readwrite("volume", &AmendOrdersAmendment::volume)
+		;
+
+	py::class_<AmendOrdersPayload, MessagePayload, std::shared_ptr<AmendOrdersPayload>>(m, "AmendOrdersPayload")
+		.def(py::init<const std::vector<AmendOrdersAmendment>&>())
+		.def(py::init<const std::vector<AmendOrdersAmendment>&, SymbolId>())
+		.def_readwrite("amendments", &AmendOrdersPayload::amendments)
+		.def_readwrite("symbol", &AmendOrdersPayload::symbol)
+		;
+
+	py::class_<ReplaceOrdersReplacement>(m, "ReplaceOrdersReplacement")
+		.def(py::init<OrderID, OrderDirection, Volume, Money>())
+		.def_readwrite("id", &ReplaceOrdersReplacement::id)
+		.def_readwrite("direction", &ReplaceOrdersReplacement::direction)
+		.def_readwrite("volume", &ReplaceOrdersReplacement::volume)
+		.def_readwrite("price", &ReplaceOrdersReplacement::price)
+		;
+
+	py::class_<ReplaceOrdersPayload, MessagePayload, std::shared_ptr<ReplaceOrdersPayload>>(m, "ReplaceOrdersPayload")
+		.def(py::init<const std::vector<ReplaceOrdersReplacement>&>())
+		.def(py::init<const std::vector<ReplaceOrdersReplacement>&, SymbolId>())
+		.def_readwrite("replacements", &ReplaceOrdersPayload::replacements)
+		.def_readwrite("symbol", &ReplaceOrdersPayload::symbol)
+		;
+
+	py::class_<ReplaceOrdersResponsePayload, MessagePayload, std::shared_ptr<ReplaceOrdersResponsePayload>>(m, "ReplaceOrdersResponsePayload")
+		.def(py::init<const std::vector<OrderID>&, const ReplaceOrdersPayload&>())
+		.def_readwrite("ids", &ReplaceOrdersResponsePayload::ids)
+		.def_readwrite("requestPayload", &ReplaceOrdersResponsePayload::requestPayload)
 		;
 
 	py::class_<RetrieveBookPayload, MessagePayload, std::shared_ptr<RetrieveBookPayload>>(m, "RetrieveBookPayload")
 		.def(py::init<unsigned int>())
+		.def(py::init<unsigned int, SymbolId>())
 		.def_readwrite("depth", &RetrieveBookPayload::depth)
+		.def_readwrite("symbol", &RetrieveBookPayload::symbol)
 		;
 
 	py::class_<RetrieveBookResponsePayload, MessagePayload, std::shared_ptr<RetrieveBookResponsePayload>>(m, "RetrieveBookResponsePayload")
 		.def(py::init<Timestamp, const std::vector<TickContainer>&>())
+		.def(py::init<Timestamp, const std::vector<TickContainer>&, SymbolId>())
 		.def_readwrite("time", &RetrieveBookResponsePayload::time)
 		.def_readwrite("tickContainers", &RetrieveBookResponsePayload::tickContainers)
+		.def_readwrite("symbol", &RetrieveBookResponsePayload::symbol)
 		;
 
 	py::class_<RetrieveL1Payload, MessagePayload, std::shared_ptr<RetrieveL1Payload>>(m, "RetrieveL1Payload")
 		.def(py::init<>())
+		.def(py::init<SymbolId>())
+		.def_readwrite("symbol", &RetrieveL1Payload::symbol)
 		;
 
 	py::class_<RetrieveL1ResponsePayload, MessagePayload, std::shared_ptr<RetrieveL1ResponsePayload>>(m, "RetrieveL1ResponsePayload")
 		.def(py::init<Timestamp, Money, Volume, Volume, Money, Volume, Volume>())
+		.def(py::init<Timestamp, Money, Volume, Volume, Money, Volume, Volume, SymbolId>())
 		.def_readwrite("time", &RetrieveL1ResponsePayload::time)
 		.def_readwrite("bestAskPrice", &RetrieveL1ResponsePayload::bestAskPrice)
 		.def_readwrite("bestAskVolume", &RetrieveL1ResponsePayload::bestAskVolume)
@@ -162,25 +228,48 @@ PYBIND11_EMBEDDED_MODULE(thesimulator, m) {
 		.def_readwrite("bestBidPrice", &RetrieveL1ResponsePayload::bestBidPrice)
 		.def_readwrite("bestBidVolume", &RetrieveL1ResponsePayload::bestBidVolume)
 		.def_readwrite("bidTotalVolume", &RetrieveL1ResponsePayload::bidTotalVolume)
+		.def_readwrite("symbol", &RetrieveL1ResponsePayload::symbol)
+		;
+
+	py::class_<SubscribeEventPayload, MessagePayload, std::shared_ptr<SubscribeEventPayload>>(m, "SubscribeEventPayload")
+		.def(py::init<>())
+		.def(py::init<SymbolId>())
+		.def_readwrite("symbol", &SubscribeEventPayload::symbol)
 		;
 
 	py::class_<SubscribeEventTradeByOrderPayload, MessagePayload, std::shared_ptr<SubscribeEventTradeByOrderPayload>>(m, "SubscribeEventTradeByOrderPayload")
 		.def(py::init<OrderID>())
+		.def(py::init<OrderID, SymbolId>())
 		.def_readwrite("id", &SubscribeEventTradeByOrderPayload::id)
+		.def_readwrite("symbol", &SubscribeEventTradeByOrderPayload::symbol)
 		;
 
 	py::class_<EventOrderMarketPayload, MessagePayload, std::shared_ptr<EventOrderMarketPayload>>(m, "EventOrderMarketPayload")
 		.def(py::init<MarketOrder>())
+		.def(py::init<MarketOrder, SymbolId>())
 		.def_readonly("order", &EventOrderMarketPayload::order)
+		.def_readonly("symbol", &EventOrderMarketPayload::symbol)
 		;
 
 	py::class_<EventOrderLimitPayload, MessagePayload, std::shared_ptr<EventOrderLimitPayload>>(m, "EventOrderLimitPayload")
 		.def(py::init<LimitOrder>())
+		.def(py::init<LimitOrder, SymbolId>())
 		.def_readonly("order", &EventOrderLimitPayload::order)
+		.def_readonly("symbol", &EventOrderLimitPayload::symbol)
 		;
 
 	py::class_<EventTradePayload, MessagePayload, std::shared_ptr<EventTradePayload>>(m, "EventTradePayload")
 		.def(py::init<Trade>())
+		.def(py::init<Trade, SymbolId>())
 		.def_readonly("trade", &EventTradePayload::trade)
+		.def_readonly("symbol", &EventTradePayload::symbol)
+		;
+
+	py::class_<EventExecutionPayload, MessagePayload, std::shared_ptr<EventExecutionPayload>>(m, "EventExecutionPayload")
+		.def(py::init<Trade, OrderID>())
+		.def(py::init<Trade, OrderID, SymbolId>())
+		.def_readonly("trade", &EventExecutionPayload::trade)
+		.def_readonly("id", &EventExecutionPayload::id)
+		.def_readonly("symbol", &EventExecutionPayload::symbol)
 		;
 }
\ No newline at end of file
@@ -4,13 +4,16 @@
 
 #include <list>
 
-#include "Book.h"
 #include "PureProRataBook.h"
 
-class TimeProRataBook : public PureProRataBook {
+// Pro-rata with the shares weighted towards the earlier orders of the level
+class TimeProRataMatching : public PureProRataMatching {
 public:
-	TimeProRataBook(OrderFactoryPtr orderRecordPtr, TradeFactoryPtr tradeRecordPtr);
-
-protected:
-	std::vector<std::pair<LimitOrderPtr, Volume>> computePartialVolumes(Volume incomingVolume, TickContainer* bestList) override;
+	template <class BookType>
+	void matchLevel(BookType& book, Order& order, PriceLevel& level) {
+		matchLevelWith(book, order, level, computeTimeProRataShares);
+	}
 };
+
+using TimeProRataBook = BasicBook<TimeProRataMatching, BufferedTradeSink>;
+extern template class BasicBook<TimeProRataMatching, BufferedTradeSink>;
@@ -0,0 +1,134 @@
+#include "TimingWheelMessageQueue.h"
+
+#include "BitOperations.h"
+
+TimingWheelMessageQueue::TimingWheelMessageQueue(size_t wheelSize, MessageTieOrder tieOrder)
+	: m_slots(), m_occupancy(), m_mask(0), m_wheelCount(0), m_cursor(0), m_tieOrder(tieOrder), m_sequence(0), m_overflow(CompareArrival(tieOrder)) {
+	size_t roundedSize = 64;
+	while (roundedSize < wheelSize) {
+		roundedSize <<= 1;
+	}
+
+	m_slots.assign(roundedSize, TimingWheelSlot(tieOrder));
+	m_occupancy.resize(roundedSize / 64, 0);
+	m_mask = roundedSize - 1;
+}
+
+void TimingWheelMessageQueue::push(const MessagePtr& messagePtr) {
+	const Timestamp arrival = messagePtr->arrival;
+	if (arrival >= m_cursor + m_slots.size()) {
+		m_overflow.emplace(m_sequence++, messagePtr);
+	} else if (arrival < m_cursor) {
+		// a message from the past goes out at the earliest possible time, i.e. with the current slot, ahead of the ones on time
+		place(slotIndex(m_cursor), messagePtr);
+	} else {
+		place(slotIndex(arrival), messagePtr);
+	}
+}
+
+const MessagePtr& TimingWheelMessageQueue::top() {
+	settle();
+
+	const TimingWheelSlot& slot = m_slots[slotIndex(m_cursor)];
+	return lateFirst(slot) ? slot.late.top().messagePtr : slot.messages[slot.head];
+}
+
+void TimingWheelMessageQueue::pop() {
+	settle();
+
+	const size_t index = slotIndex(m_cursor);
+	TimingWheelSlot& slot = m_slots[index];
+	if (lateFirst(slot)) {
+		slot.late.pop();
+	} else {
+		slot.messages[slot.head++].reset();
+	}
+	--m_wheelCount;
+
+	if (slot.head == slot.messages.size()) {
+		slot.messages.clear();
+		slot.head = 0;
+		if (slot.late.empty()) {
+			m_occupancy[index >> 6] &= ~(1ULL << (index & 63));
+		}
+	}
+}
+
+void TimingWheelMessageQueue::place(size_t index, const MessagePtr& messagePtr) {
+	// ordered by delivery, the messages mostly come in that order already and are appended all the same
+	TimingWheelSlot& slot = m_slots[index];
+	if (messagePtr->arrival < m_cursor
+		|| (m_tieOrder == MessageTieOrder::Delivery && slot.head != slot.messages.size() && deliveredBefore(*messagePtr, *slot.messages.back()))) {
+		slot.late.emplace(m_sequence++, messagePtr);
+	} else {
+		slot.messages.push_back(messagePtr);
+	}
+	m_occupancy[index >> 6] |= 1ULL << (index & 63);
+	++m_wheelCount;
+}
+
+void TimingWheelMessageQueue::settle() {
+	if (m_wheelCount == 0) {
+		if (!m_overflow.empty()) {
+			// nothing within the window, jump straight to the earliest overflowing message
+			m_cursor = m_overflow.top().arrival;
+			migrateOverflow();
+		}
+		return;
+	}
+
+	const size_t index = slotIndex(m_cursor);
+	const size_t occupiedIndex = findOccupiedFrom(index);
+	if (occupiedIndex != index) {
+		m_cursor += (occupiedIndex - index) & m_mask;
+		migrateOverflow();
+	}
+}
+
+void TimingWheelMessageQueue::migrateOverflow() {
+	// the slots the window has just moved over are all empty, the overflowing messages come out of the heap already in the order of the queue
+	const Timestamp windowEnd = m_cursor + m_slots.size();
+	while (!m_overflow.empty() && m_overflow.top().arrival < windowEnd) {
+		place(slotIndex(m_overflow.top().arrival), m_overflow.top().messagePtr);
+		m_overflow.pop();
+	}
+}
+
+size_t TimingWheelMessageQueue::findOccupiedFrom(size_t index) const {
+	const size_t wordCount = m_occupancy.size();
+	size_t wordIndex = index >> 6;
+
+	unsigned long long word = m_occupancy[wordIndex] & (~0ULL << (index & 63));
+	for (size_t scanned = 0; scanned <= wordCount; ++scanned) {
+		if (word != 0) {
+			return (wordIndex << 6) + countTrailingZeros(word);
+		}
+
+		wordIndex = (wordIndex + 1) % wordCount;
+		word = m_occupancy[wordIndex];
+	}
+
+	return index; // unreachable while the wheel is not empty
+}
+
+std::vector<MessagePtr> TimingWheelMessageQueue::messages() const {
+	std::vector<MessagePtr> ret;
+	ret.reserve(size());
+
+	for (const TimingWheelSlot& slot : m_slots) {
+		ret.insert(ret.end(), slot.messages.begin() + slot.head, slot.messages.end());
+		PriorityMessageQueueContainer late = slot.late;
+		while (!late.empty()) {
+			ret.push_back(late.top().messagePtr);
+			late.pop();
+		}
+	}
+
+	PriorityMessageQueueContainer overflow = m_overflow;
+	while (!overflow.empty()) {
+		ret.push_back(overflow.top().messagePtr);
+		overflow.pop();
+	}
+
+	return ret;
+}
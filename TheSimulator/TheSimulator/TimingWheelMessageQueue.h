@@ -0,0 +1,59 @@
+#pragma once
+
+#include "IMessageQueue.h"
+#include "PriorityMessageQueue.h"
+
+#include <vector>
+
+// The messages of a slot in the order they were pushed. A message arriving before the slot, or, ordered by delivery, pushed
+// behind one it is to be delivered before, waits in a heap of its own instead, which the delivery takes the earlier of the two
+// fronts from.
+struct TimingWheelSlot {
+	std::vector<MessagePtr> messages;
+	size_t head;
+	PriorityMessageQueueContainer late;
+
+	TimingWheelSlot(MessageTieOrder tieOrder) : messages(), head(0), late(CompareArrival(tieOrder)) { }
+	bool empty() const { return head == messages.size() && late.empty(); }
+};
+
+// A single-level timing wheel with one slot per time unit, covering the window [cursor, cursor + wheelSize).
+// Messages arriving past the window wait in an overflow heap and are moved onto the wheel as the cursor advances,
+// so that every message pays the logarithmic cost at most once, and only if it was scheduled far into the future.
+class TimingWheelMessageQueue : public IMessageQueue {
+public:
+	TimingWheelMessageQueue(size_t wheelSize, MessageTieOrder tieOrder);
+
+	void push(const MessagePtr& messagePtr) override;
+	const MessagePtr& top() override;
+	void pop() override;
+
+	bool empty() const override { return m_wheelCount == 0 && m_overflow.empty(); }
+	size_t size() const override { return m_wheelCount + m_overflow.size(); }
+
+	std::vector<MessagePtr> messages() const override;
+
+	size_t wheelSize() const { return m_slots.size(); }
+
+	static constexpr size_t DEFAULT_WHEEL_SIZE = 4096;
+private:
+	std::vector<TimingWheelSlot> m_slots;
+	std::vector<unsigned long long> m_occupancy;
+	size_t m_mask;
+	size_t m_wheelCount;
+	Timestamp m_cursor;
+	MessageTieOrder m_tieOrder;
+	unsigned long long m_sequence;
+
+	PriorityMessageQueueContainer m_overflow;
+
+	size_t slotIndex(Timestamp timestamp) const { return (size_t)(timestamp & m_mask); }
+	void place(size_t slotIndex, const MessagePtr& messagePtr);
+	// whether the front of the slot is the first message of its heap rather than of its list
+	bool lateFirst(const TimingWheelSlot& slot) const {
+		return !slot.late.empty() && (slot.head == slot.messages.size() || deliveredBefore(*slot.late.top().messagePtr, *slot.messages[slot.head]));
+	}
+	void settle();
+	void migrateOverflow();
+	size_t findOccupiedFrom(size_t slotIndex) const;
+};
@@ -1,11 +1,12 @@
 #include "Trade.h"
 
-Trade::Trade(TradeID id, Timestamp timestamp, OrderDirection direction, OrderID aggressingOrderID, OrderID restingOrderID, Volume volume, Money price)
-	: m_id(id), m_timestamp(timestamp), m_direction(direction), m_aggressingOrderID(aggressingOrderID), m_restingOrderID(restingOrderID), m_volume(volume), m_price(price) { }
+Trade::Trade(TradeID id, Timestamp timestamp, OrderDirection direction, OrderID aggressingOrderID, OrderID restingOrderID, Volume volume, Money price, AgentId aggressingAgent, AgentId restingAgent)
+	: m_id(id), m_timestamp(timestamp), m_aggressingOrderID(aggressingOrderID), m_restingOrderID(restingOrderID), m_price(price), m_volume(volume),
+	m_aggressingAgent(aggressingAgent), m_restingAgent(restingAgent), m_direction(direction) { }
 
 #include <iostream>
 
-void Trade::printHuman() const {
+void printHuman(const Trade& trade) {
 	/*std::cout << std::to_string(m_id) << "\t"
 		<< std::to_string(m_timestamp) << "\t"
 		<< std::to_string(m_aggressingOrderID) << "\t"
@@ -13,20 +14,20 @@ void Trade::printHuman() const {
 		<< std::to_string(m_restingOrderID) << "\t"
 		<< std::to_string(m_volume) << "\t"
 		<< m_price.toCentString();*/
-	std::cout << "Trade " + std::to_string(m_id)
-		<< " occurred at time " << std::to_string(m_timestamp)
-		<< ", matching order " << std::to_string(m_aggressingOrderID) << " vs. " << std::to_string(m_restingOrderID) 
-		<< " (written in the " << (m_direction == OrderDirection::Sell ? "SELL" : "BUY ") << " direction)"
-		<< " with volume " << std::to_string(m_volume)
-		<< " and price " << m_price.toCentString();
+	std::cout << "Trade " + std::to_string(trade.id())
+		<< " occurred at time " << std::to_string(trade.timestamp())
+		<< ", matching order " << std::to_string(trade.aggressingOrderID()) << " vs. " << std::to_string(trade.restingOrderID()) 
+		<< " (written in the " << (trade.direction() == OrderDirection::Sell ? "SELL" : "BUY ") << " direction)"
+		<< " with volume " << std::to_string(trade.volume())
+		<< " and price " << trade.price().toCentString();
 }
 
-void Trade::printCSV() const {
-	std::cout << std::to_string(m_id) << ","
-		<< std::to_string(m_timestamp) << ","
-		<< std::to_string(m_aggressingOrderID) << ","
-		<< (m_direction == OrderDirection::Sell ? "SELL" : "BUY") << ","
-		<< std::to_string(m_restingOrderID) << ","
-		<< std::to_string(m_volume) << ","
-		<< m_price.toFullString();
+void printCSV(const Trade& trade) {
+	std::cout << std::to_string(trade.id()) << ","
+		<< std::to_string(trade.timestamp()) << ","
+		<< std::to_string(trade.aggressingOrderID()) << ","
+		<< (trade.direction() == OrderDirection::Sell ? "SELL" : "BUY") << ","
+		<< std::to_string(trade.restingOrderID()) << ","
+		<< std::to_string(trade.volume()) << ","
+		<< trade.price().toFullString();
 }
\ No newline at end of file
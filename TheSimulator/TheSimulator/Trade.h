@@ -1,41 +1,44 @@
 #pragma once
 
-#include "IHumanPrintable.h"
-#include "ICSVPrintable.h"
-
+#include "AgentId.h"
 #include "Timestamp.h"
 #include "Order.h"
 
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 
-using TradeID = unsigned int;
+using TradeID = std::uint64_t; // a long run gets through more than 2^32 trades
 
-class Trade : public IHumanPrintable, public ICSVPrintable {
+class Trade {
 public:
-	Trade(TradeID id, Timestamp timestamp, OrderDirection direction, OrderID aggressingOrderID, OrderID restingOrderID, Volume volume, Money price);
-	/*Trade(const Trade& trade)
-		: m_id(trade.m_id), m_timestamp(trade.m_timestamp), m_direction(trade.m_direction), m_aggressingOrderID(trade.m_aggressingOrderID), m_restingOrderID(trade.m_restingOrderID), m_volume(trade.m_volume), m_price(trade.m_price) { }*/
-	Trade(const Trade& trade) = default;
-	Trade(Trade&& trade) = default;
+	// the agents own the orders, AGENTID_INVALID for an order nobody is to be told about
+	Trade(TradeID id, Timestamp timestamp, OrderDirection direction, OrderID aggressingOrderID, OrderID restingOrderID, Volume volume, Money price, AgentId aggressingAgent, AgentId restingAgent);
 
 	inline TradeID id() const { return m_id; }
 	inline Timestamp timestamp() const { return m_timestamp; }
 	inline void setTimestamp(Timestamp timestamp) { m_timestamp = timestamp; }
+	inline OrderDirection direction() const { return m_direction; }
 	inline OrderID aggressingOrderID() const { return m_aggressingOrderID; }
 	inline OrderID restingOrderID() const { return m_restingOrderID; }
 	inline Volume volume() const { return m_volume; }
 	inline Money price() const { return m_price; }
-
-	void printHuman() const override;
-	void printCSV() const override;
+	inline AgentId aggressingAgent() const { return m_aggressingAgent; }
+	inline AgentId restingAgent() const { return m_restingAgent; }
 private:
 	TradeID m_id;
-	OrderDirection m_direction;
 	Timestamp m_timestamp;
 	OrderID m_aggressingOrderID;
 	OrderID m_restingOrderID;
-	Volume m_volume;
 	Money m_price;
+	Volume m_volume;
+	AgentId m_aggressingAgent;
+	AgentId m_restingAgent;
+	OrderDirection m_direction;
 };
+static_assert(std::is_trivially_copyable_v<Trade>, "the trades are copied as plain records");
+
+using TradePtr = std::shared_ptr<Trade>;
 
-using TradePtr = std::shared_ptr<Trade>;
\ No newline at end of file
+void printHuman(const Trade& trade);
+void printCSV(const Trade& trade);
\ No newline at end of file
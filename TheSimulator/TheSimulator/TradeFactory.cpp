@@ -1,12 +1,19 @@
 #include "TradeFactory.h"
+#include "Snapshot.h"
 
 TradeFactory::TradeFactory()
 	: m_tradeCount(0) { }
 
-TradePtr TradeFactory::makeRecord(Timestamp timestamp, OrderDirection direction, OrderID aggressingOrder, OrderID restingOrder, Volume volume, Money price) {
+Trade TradeFactory::makeRecord(Timestamp timestamp, OrderDirection direction, OrderID aggressingOrder, OrderID restingOrder, Volume volume, Money price, AgentId aggressingAgent, AgentId restingAgent) {
 	++m_tradeCount;
 
-	TradePtr ret = std::make_shared<Trade>(m_tradeCount, timestamp, direction, aggressingOrder, restingOrder, volume, price);
+	return Trade(m_tradeCount, timestamp, direction, aggressingOrder, restingOrder, volume, price, aggressingAgent, restingAgent);
+}
 
-	return ret;
+void TradeFactory::saveState(SnapshotWriter& writer) const {
+	writer.write(m_tradeCount);
+}
+
+void TradeFactory::loadState(SnapshotReader& reader) {
+	m_tradeCount = reader.read<TradeID>();
 }
\ No newline at end of file
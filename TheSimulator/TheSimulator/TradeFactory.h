@@ -1,18 +1,21 @@
 #pragma once
 
-#include "IHumanPrintable.h"
-#include "ICSVPrintable.h"
-
 #include "Trade.h"
 
 #include <list>
 #include <memory>
 
+class SnapshotWriter;
+class SnapshotReader;
+
 class TradeFactory {
 public:
 	TradeFactory();
 
-	TradePtr makeRecord(Timestamp timestamp, OrderDirection direction, OrderID aggressingOrder, OrderID restingOrder, Volume volume, Money price); // order direction means what did the aggressing order do to the resting order?
+	Trade makeRecord(Timestamp timestamp, OrderDirection direction, OrderID aggressingOrder, OrderID restingOrder, Volume volume, Money price, AgentId aggressingAgent, AgentId restingAgent); // order direction means what did the aggressing order do to the resting order?
+
+	void saveState(SnapshotWriter& writer) const;
+	void loadState(SnapshotReader& reader);
 private:
 	TradeID m_tradeCount;
 };
@@ -6,24 +6,32 @@
 #include <iostream>
 
 TradeLogAgent::TradeLogAgent(const Simulation* simulation)
-	: Agent(simulation) { }
+	: Agent(simulation), m_exchangeId(AGENTID_INVALID) { }
 
 TradeLogAgent::TradeLogAgent(const Simulation* simulation, const std::string& name)
-	: Agent(simulation, name) { }
+	: Agent(simulation, name), m_exchangeId(AGENTID_INVALID) { }
+
+const MessageDispatchTable<TradeLogAgent> TradeLogAgent::s_dispatchTable = MessageDispatchTable<TradeLogAgent>()
+	.on(MESSAGETYPE_EVENT_SIMULATION_START, &TradeLogAgent::handleSimulationStart)
+	.on(MESSAGETYPE_EVENT_TRADE, &TradeLogAgent::handleTradeEvent);
 
 void TradeLogAgent::receiveMessage(const MessagePtr& messagePtr) {
+	s_dispatchTable.dispatch(this, messagePtr);
+}
+
+void TradeLogAgent::handleSimulationStart(const MessagePtr& messagePtr) {
 	const Timestamp currentTimestamp = simulation()->currentTimestamp();
+
+	simulation()->dispatchMessage(currentTimestamp, currentTimestamp, id(), m_exchangeId, MESSAGETYPE_SUBSCRIBE_EVENT_TRADE);
+}
+
+void TradeLogAgent::handleTradeEvent(const MessagePtr& messagePtr) {
+	const auto& payload = std::get<EventTradePayload>(messagePtr->payload);
+	const auto& trade = payload.trade;
 	
-	if (messagePtr->type == "EVENT_SIMULATION_START") {
-		simulation()->dispatchMessage(currentTimestamp, currentTimestamp, name(), m_exchange, "SUBSCRIBE_EVENT_TRADE", std::make_shared<EmptyPayload>());
-	} else if (messagePtr->type == "EVENT_TRADE") {
-		auto pptr = std::dynamic_pointer_cast<EventTradePayload>(messagePtr->payload);
-		const auto& trade = pptr->trade;
-		
-		std::cout << name() << ": ";
-		trade.printHuman();
-		std::cout << std::endl;
-	}
+	std::cout << name() << ": ";
+	printHuman(trade);
+	std::cout << std::endl;
 }
 
 #include "ParameterStorage.h"
@@ -35,4 +43,8 @@ void TradeLogAgent::configure(const pugi::xml_node& node, const std::string& con
 	if (!(att = node.attribute("exchange")).empty()) {
 		m_exchange = simulation()->parameters().processString(att.as_string());
 	}
+}
+
+void TradeLogAgent::resolveAgentIds() {
+	m_exchangeId = simulation()->agentId(m_exchange);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Agent.h"
+#include "MessageDispatchTable.h"
 
 class TradeLogAgent : public Agent {
 public:
@@ -11,6 +12,13 @@ public:
 
 	// Inherited via Agent
 	void receiveMessage(const MessagePtr& msg) override;
+	bool consumes(MessageType type) const override { return s_dispatchTable.handles(type); }
+	void resolveAgentIds() override;
 private:
+	static const MessageDispatchTable<TradeLogAgent> s_dispatchTable;
+	void handleSimulationStart(const MessagePtr& messagePtr);
+	void handleTradeEvent(const MessagePtr& messagePtr);
+
 	std::string m_exchange;
+	AgentId m_exchangeId;
 };
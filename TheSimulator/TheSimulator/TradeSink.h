@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Trade.h"
+
+#include <cstddef>
+#include <vector>
+
+// Where a BasicBook sends its trades, a compile-time parameter of the book. A sink records the trades one by one as they
+// happen, right in the match loop, and hands them over to the owner of the book once the operation is done, through take().
+
+// Collects the trades in a buffer allocated up front, which keeps its capacity from one operation to the next
+class BufferedTradeSink {
+public:
+	BufferedTradeSink() { m_trades.reserve(INITIAL_CAPACITY); }
+
+	void record(const Trade& trade) { m_trades.push_back(trade); }
+	// the vector given in exchange is emptied and becomes the next buffer
+	void take(std::vector<Trade>& trades) {
+		m_trades.swap(trades);
+		m_trades.clear();
+	}
+
+	static constexpr size_t INITIAL_CAPACITY = 256;
+private:
+	std::vector<Trade> m_trades;
+};
@@ -1,3 +1,10 @@
 #pragma once
 
-typedef unsigned long long int Volume;
\ No newline at end of file
+// MAXE_COMPACT_RECORDS narrows the volumes down to 32 bits, for the smaller orders and trades
+#ifdef MAXE_COMPACT_RECORDS
+#include <cstdint>
+
+typedef std::uint32_t Volume;
+#else
+typedef unsigned long long int Volume;
+#endif
\ No newline at end of file
@@ -1,6 +1,10 @@
+#include <chrono>
 #include <iostream>
 #include <thread>
+#include <memory>
 
+#include "BookFactory.h"
+#include "BookJournal.h"
 #include "Simulation.h"
 #include "SimulationException.h"
 #include "ParameterStorage.h"
@@ -18,8 +22,20 @@ void traceLine(const std::string& msg);
 void etrace(const std::string& msg);
 void etraceLine(const std::string& msg);
 
+// what happens to every run besides simulating it; the file names may refer to the parameters, e.g. to ${runIndex}
+struct RunOptions {
+	bool interactive;
+	std::string snapshotFile; // taken once the run reaches snapshotTimestamp
+	Timestamp snapshotTimestamp;
+	std::string restoreFile; // the run carries on from this snapshot rather than from the start
+	std::shared_ptr<const std::string> sharedPrefix; // the snapshot every run branches off, takes the place of the restore file
+	bool branchRandomGenerators;
+};
+
 void invokeInteractiveMode(Simulation* simulation);
-void runSimulations(std::pair<unsigned int, unsigned int> runIndexRange, bool interactive, pugi::xml_node configurationNode, const ParameterStorage& parameterBase);
+std::shared_ptr<const std::string> simulateSharedPrefix(Timestamp until, const RunOptions& options, pugi::xml_node configurationNode, const ParameterStorage& parameterBase);
+void runSimulations(std::pair<unsigned int, unsigned int> runIndexRange, const RunOptions& options, pugi::xml_node configurationNode, const ParameterStorage& parameterBase);
+void replayJournal(const std::string& journalFile, const std::string& algorithm);
 
 int main(int argc, char* argv[]) {
 	// start the interpreter and keep it alive
@@ -32,6 +48,14 @@ int main(int argc, char* argv[]) {
 	auto& silencio = cli.opt<bool>("s silent", false).desc("supresses all verbose trace output, error traces remain enabled");
 	auto& runCount = cli.opt<unsigned int>("r runs", 1).desc("Number of times the simulation is to be run");
 	auto& threadCount = cli.opt<unsigned int>("t threads", 1).desc("The maximum number of threads to use for evaluating different runs");
+	auto& seed = cli.opt<unsigned long long>("seed", 0).desc("The seed the random streams derive from, together with the run index and the agent, unless the simulation file sets one");
+	auto& snapshotFile = cli.opt<std::string>("snapshot", "").desc("Saves a snapshot of every run into the given file, ${runIndex} in the name tells the runs apart");
+	auto& snapshotTimestamp = cli.opt<Timestamp>("snapshot-at", 0).desc("The time at which the snapshot is taken");
+	auto& restoreFile = cli.opt<std::string>("restore", "").desc("Resumes every run from the given snapshot, taken of the same simulation file");
+	auto& forkTimestamp = cli.opt<Timestamp>("fork-at", 0).desc("Simulates the time up to the given one once, configured as the first run, and branches every run off there");
+	auto& forkReseed = cli.opt<bool>("fork-reseed", true).desc("Gives every branching run random streams of its own, otherwise the runs differ in their parameters only");
+	auto& replayFile = cli.opt<std::string>("replay", "").desc("Replays the given book journal against a book of its own instead of simulating, and checks the fills");
+	auto& replayAlgorithm = cli.opt<std::string>("replay-algorithm", "").desc("The matching algorithm of the replayed book, the one of the journal by default");
 	auto& simParameters = cli.optVec<std::string>("[params]").desc("Parameters to be passed to the simulation configuration & the simulation itself");
 	if (!cli.parse(std::cerr, argc, argv)) {
 		return cli.exitCode();
@@ -65,10 +89,31 @@ int main(int argc, char* argv[]) {
 
 		parameterBase.set(name, value);
 	}
+	if (seed) {
+		parameterBase.set("seed", std::to_string(*seed));
+	}
+
+	RunOptions options;
+	options.interactive = *interactive;
+	options.snapshotFile = *snapshotFile;
+	options.snapshotTimestamp = *snapshotTimestamp;
+	options.restoreFile = *restoreFile;
+	options.sharedPrefix = nullptr;
+	options.branchRandomGenerators = *forkReseed;
 
 	// say hello world, if not in silent mode
 	traceLine("ExchangeSimulator v2.0");
 
+	// the replay needs no simulation file, only the journal
+	if (!replayFile->empty()) {
+		try {
+			replayJournal(*replayFile, *replayAlgorithm);
+		} catch (const std::exception& ex) {
+			std::cout << ex.what() << std::endl;
+		}
+		return 0;
+	}
+
 	// parse the simulation configuration file
 	pugi::xml_document doc;
 	auto parse_result = doc.load_file(simulationFile->c_str());
@@ -101,16 +146,21 @@ int main(int argc, char* argv[]) {
 		// catch any SimulationException that may occur
 		try {
 			traceLine(" - starting the simulations");
+			if (*forkTimestamp > 0) {
+				traceLine(" - simulating the shared prefix up to " + std::to_string(*forkTimestamp));
+				options.sharedPrefix = simulateSharedPrefix(*forkTimestamp, options, node, parameterBase);
+			}
+
 			if (*interactive) {
 				traceLine(" - entering the interactive mode, type 'help' to retrieve the list of available commands");
 			}
 
 			if (loads.size() == 1) {
-				runSimulations(loads.front(), *interactive, node, parameterBase);
+				runSimulations(loads.front(), options, node, parameterBase);
 			} else {
 				std::vector<std::unique_ptr<std::thread>> threads;
 				for (const auto& load : loads) {
-					threads.push_back(std::make_unique<std::thread>(runSimulations, load, false, node, parameterBase));
+					threads.push_back(std::make_unique<std::thread>(runSimulations, load, options, node, parameterBase));
 				}
 
 				for (const auto& threadptr : threads) {
@@ -147,6 +197,7 @@ void invokeInteractiveMode(Simulation* simulation) {
 			traceLine("\tstop, exit\t\tstops the simulation and exits the program");
 			traceLine("\trun \t\t\tcontinues the simulation until it finishes");
 			traceLine("\tstep <step>\t\tsimulates over <step> time units");
+			traceLine("\tsnapshot <file>\t\tsaves a snapshot of the simulation into <file>");
 		} else if (command == "stop" || command == "exit") {
 			traceLine(" - simulation stopped, exiting");
 			break;
@@ -156,20 +207,42 @@ void invokeInteractiveMode(Simulation* simulation) {
 			Timestamp step = 0;
 			ss >> step;
 			simulation->simulate(step);
+		} else if (command == "snapshot") {
+			std::string file;
+			std::getline(ss, file);
+			simulation->saveSnapshot(file);
+			traceLine(" - snapshot saved into '" + file + "'");
 		}
 	}
 }
 
-void runSimulations(std::pair<unsigned int, unsigned int> runIndexRange, bool interactive, pugi::xml_node configurationNode, const ParameterStorage& parameterBase) {
+void runSimulations(std::pair<unsigned int, unsigned int> runIndexRange, const RunOptions& options, pugi::xml_node configurationNode, const ParameterStorage& parameterBase) {
 	for(unsigned int runIndex = runIndexRange.first;runIndex < runIndexRange.second;++runIndex) {
 		ParameterStorage* parameters = new ParameterStorage(parameterBase);
 		parameters->set("runIndex", std::to_string(runIndex));
 		Simulation* simulation = new Simulation(parameters);
 		simulation->configure(configurationNode, "");
 
-		if (interactive) {
+		if (options.sharedPrefix != nullptr) {
+			std::istringstream prefixStream(*options.sharedPrefix);
+			simulation->loadSnapshot(prefixStream);
+			if (options.branchRandomGenerators) {
+				simulation->branchRandomGenerators(runIndex);
+			}
+		} else if (!options.restoreFile.empty()) {
+			simulation->loadSnapshot(parameters->processString(options.restoreFile));
+		}
+
+		if (options.interactive) {
 			invokeInteractiveMode(simulation);
 		} else {
+			if (!options.snapshotFile.empty()) {
+				if (simulation->currentTimestamp() < options.snapshotTimestamp) {
+					simulation->simulate(options.snapshotTimestamp - simulation->currentTimestamp());
+				}
+				simulation->saveSnapshot(parameters->processString(options.snapshotFile));
+			}
+
 			simulation->simulate();
 		}
 
@@ -178,6 +251,44 @@ void runSimulations(std::pair<unsigned int, unsigned int> runIndexRange, bool in
 	}
 }
 
+void replayJournal(const std::string& journalFile, const std::string& algorithm) {
+	JournalReplay replay(journalFile);
+	const std::string bookAlgorithm = algorithm.empty() ? replay.algorithm() : algorithm;
+	BookPtr book = BookFactory::make(bookAlgorithm, replay.tickSize());
+	traceLine(" - replaying '" + journalFile + "' against a " + bookAlgorithm + " book");
+
+	const auto start = std::chrono::steady_clock::now();
+	replay.replay(*book);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	traceLine(" - " + std::to_string(replay.records()) + " records, " + std::to_string(replay.fills()) + " fills, "
+		+ std::to_string(replay.mismatchedFills()) + " of them mismatched");
+	traceLine(" - replayed in " + std::to_string(elapsed.count()) + " s, "
+		+ std::to_string(elapsed.count() > 0 ? (unsigned long long)(replay.records() / elapsed.count()) : 0ULL) + " records/s");
+	if (!silent) {
+		book->printHuman();
+	}
+}
+
+std::shared_ptr<const std::string> simulateSharedPrefix(Timestamp until, const RunOptions& options, pugi::xml_node configurationNode, const ParameterStorage& parameterBase) {
+	// the prefix stands in for the first run, the runs then load it from memory as they would a snapshot file
+	ParameterStorage parameters(parameterBase);
+	parameters.set("runIndex", "0");
+	Simulation simulation(&parameters);
+	simulation.configure(configurationNode, "");
+
+	if (!options.restoreFile.empty()) {
+		simulation.loadSnapshot(parameters.processString(options.restoreFile));
+	}
+	if (simulation.currentTimestamp() < until) {
+		simulation.simulate(until - simulation.currentTimestamp());
+	}
+
+	std::ostringstream prefixStream;
+	simulation.saveSnapshot(prefixStream);
+	return std::make_shared<const std::string>(prefixStream.str());
+}
+
 void trace(const std::string& msg) {
 	if (silent) {
 		return;
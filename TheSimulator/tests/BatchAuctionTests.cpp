@@ -0,0 +1,97 @@
+#include "Tests.h"
+#include "TestBooks.h"
+
+// The orders rest until the uncross, crossed or not, and then all trade at the single clearing price.
+
+TEST(BatchAuctionMostVolume) {
+	BookPtr book = makeBook("BatchAuction");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 10, cents(102), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 3, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(101), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 6, cents(102), AGENTID_INVALID);
+	CHECK_EQUAL(std::string(), tradesOf(*book));
+
+	// 3 trade at 100, 7 at 101 and 10 at 102
+	book->uncross(1);
+	CHECK_EQUAL("102:3 102:4 102:3", tradesOf(*book));
+	CHECK(book->buyQueue().empty());
+	CHECK_EQUAL("102:3", levelsOf(book->sellQueue()));
+}
+
+TEST(BatchAuctionLeastImbalance) {
+	BookPtr book = makeBook("BatchAuction");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 5, cents(101), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 1, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 3, cents(101), AGENTID_INVALID);
+
+	// 5 trade at either price, leaving 1 of demand at 100 and 3 of supply at 101
+	book->uncross(1);
+	CHECK_EQUAL("100:5", tradesOf(*book));
+	CHECK_EQUAL("100:1", levelsOf(book->buyQueue()));
+	CHECK_EQUAL("101:3", levelsOf(book->sellQueue()));
+}
+
+TEST(BatchAuctionHighestWhileDemandInExcess) {
+	BookPtr book = makeBook("BatchAuction");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 6, cents(103), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 2, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 3, cents(101), AGENTID_INVALID);
+
+	book->uncross(1);
+	CHECK_EQUAL("103:2 103:3", tradesOf(*book));
+	CHECK_EQUAL("103:1", levelsOf(book->buyQueue()));
+}
+
+TEST(BatchAuctionLowestWhileSupplyInExcess) {
+	BookPtr book = makeBook("BatchAuction");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 6, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 3, cents(103), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 2, cents(101), AGENTID_INVALID);
+
+	book->uncross(1);
+	CHECK_EQUAL("100:3 100:2", tradesOf(*book));
+	CHECK_EQUAL("100:1", levelsOf(book->sellQueue()));
+}
+
+TEST(BatchAuctionMiddleOtherwise) {
+	BookPtr book = makeBook("BatchAuction");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 5, cents(103), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 1, cents(101), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 1, cents(102), AGENTID_INVALID);
+
+	// 5 trade from 100 to 103, the demand in excess by 1 below 102 and the supply from there on
+	book->uncross(1);
+	CHECK_EQUAL("101:5", tradesOf(*book));
+	CHECK_EQUAL("101:1", levelsOf(book->buyQueue()));
+	CHECK_EQUAL("102:1", levelsOf(book->sellQueue()));
+}
+
+TEST(BatchAuctionMarketOrdersFirst) {
+	BookPtr book = makeBook("BatchAuction");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 5, cents(101), AGENTID_INVALID);
+	MarketOrderPtr market = book->placeMarketOrder(OrderDirection::Buy, 0, 3, AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(100), AGENTID_INVALID);
+
+	book->uncross(1);
+	CHECK_EQUAL("101:3 101:1", tradesOf(*book));
+	CHECK_EQUAL((Volume)0, market->volume());
+	CHECK_EQUAL("101:4", levelsOf(book->buyQueue()));
+	CHECK(book->sellQueue().empty());
+}
+
+TEST(BatchAuctionUnfilledMarketOrdersLapse) {
+	BookPtr book = makeBook("BatchAuction");
+	book->placeMarketOrder(OrderDirection::Buy, 0, 10, AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(100), AGENTID_INVALID);
+
+	book->uncross(1);
+	CHECK_EQUAL("100:4", tradesOf(*book));
+
+	// what was left of the market order is gone by the next uncross
+	book->placeLimitOrder(OrderDirection::Sell, 1, 3, cents(100), AGENTID_INVALID);
+	book->uncross(2);
+	CHECK_EQUAL(std::string(), tradesOf(*book));
+	CHECK_EQUAL("100:3", levelsOf(book->sellQueue()));
+}
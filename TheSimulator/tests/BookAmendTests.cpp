@@ -0,0 +1,95 @@
+#include "Tests.h"
+#include "TestBooks.h"
+
+// the owner of the resting order shows which of them a fill went to
+static std::string restingOwnersOf(Book& book) {
+	std::vector<Trade> trades;
+	book.takeTrades(trades);
+
+	std::string owners;
+	for (const Trade& trade : trades) {
+		owners += (owners.empty() ? "" : " ") + std::to_string(trade.restingAgent()) + ":" + std::to_string(trade.volume());
+	}
+	return owners;
+}
+
+TEST(BookAmendDownKeepsPriority) {
+	BookPtr book = makeBook("PriceTime");
+	LimitOrderPtr first = book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), 2);
+
+	CHECK_EQUAL((Volume)3, book->amendOrder(first->id(), 1, 3));
+	CHECK_EQUAL("100:8", levelsOf(book->sellQueue()));
+
+	book->placeMarketOrder(OrderDirection::Buy, 2, 4, AGENTID_INVALID);
+	CHECK_EQUAL("1:3 2:1", restingOwnersOf(*book));
+}
+
+TEST(BookAmendUpLosesPriority) {
+	BookPtr book = makeBook("PriceTime");
+	LimitOrderPtr first = book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), 2);
+
+	CHECK_EQUAL((Volume)6, book->amendOrder(first->id(), 1, 6));
+	CHECK_EQUAL("100:11", levelsOf(book->sellQueue()));
+	CHECK_EQUAL((Volume)11, book->sellQueue().volume());
+
+	book->placeMarketOrder(OrderDirection::Buy, 2, 7, AGENTID_INVALID);
+	CHECK_EQUAL("2:5 1:2", restingOwnersOf(*book));
+}
+
+TEST(BookAmendToZeroCancels) {
+	BookPtr book = makeBook("PriceTime");
+	LimitOrderPtr order = book->placeLimitOrder(OrderDirection::Buy, 0, 5, cents(99), 1);
+
+	CHECK_EQUAL((Volume)0, book->amendOrder(order->id(), 1, 0));
+	CHECK(!book->contains(order->id()));
+	CHECK(book->buyQueue().empty());
+
+	// and an order no longer in the book stays out of it
+	CHECK_EQUAL((Volume)0, book->amendOrder(order->id(), 2, 5));
+	CHECK(book->buyQueue().empty());
+}
+
+TEST(BookAmendStopOrder) {
+	BookPtr book = makeBook("PriceTime");
+	const OrderID stop = book->placeStopOrder(OrderDirection::Buy, 0, 5, cents(101), std::nullopt, 1);
+
+	CHECK_EQUAL((Volume)8, book->amendOrder(stop, 1, 8));
+	CHECK(book->contains(stop));
+	CHECK_EQUAL((Volume)8, book->cancelOrder(stop));
+	CHECK(!book->contains(stop));
+}
+
+TEST(BookCancelReturnsVolumeCancelled) {
+	BookPtr book = makeBook("PriceTime");
+	LimitOrderPtr order = book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), 1);
+
+	book->placeMarketOrder(OrderDirection::Buy, 1, 2, AGENTID_INVALID);
+	CHECK_EQUAL((Volume)3, book->cancelOrder(order->id()));
+	CHECK(book->sellQueue().empty());
+
+	// nothing is left to cancel, as for the order that has filled before its cancel-replace arrives
+	CHECK_EQUAL((Volume)0, book->cancelOrder(order->id()));
+
+	LimitOrderPtr filled = book->placeLimitOrder(OrderDirection::Sell, 2, 5, cents(100), 1);
+	book->placeMarketOrder(OrderDirection::Buy, 3, 5, AGENTID_INVALID);
+	CHECK(!book->contains(filled->id()));
+	CHECK_EQUAL((Volume)0, book->cancelOrder(filled->id()));
+}
+
+TEST(BookReplaceMovesThroughOwnQuote) {
+	// the way the exchange replaces orders: all the cancellations before any placement
+	BookPtr book = makeBook("PriceTime");
+	LimitOrderPtr sell = book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(101), 1);
+	LimitOrderPtr buy = book->placeLimitOrder(OrderDirection::Buy, 0, 5, cents(99), 1);
+
+	CHECK_EQUAL((Volume)5, book->cancelOrder(sell->id()));
+	CHECK_EQUAL((Volume)5, book->cancelOrder(buy->id()));
+	book->placeLimitOrder(OrderDirection::Sell, 1, 5, cents(98), 1);
+	book->placeLimitOrder(OrderDirection::Buy, 1, 5, cents(97), 1);
+
+	CHECK_EQUAL("", tradesOf(*book));
+	CHECK_EQUAL("98:5", levelsOf(book->sellQueue()));
+	CHECK_EQUAL("97:5", levelsOf(book->buyQueue()));
+}
@@ -0,0 +1,85 @@
+#include "Tests.h"
+#include "TestBooks.h"
+
+// the volumes and the order counts of the levels and the sides, as they follow every change to the book
+TEST(BookVolumeFollowsPlacements) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 5, cents(99), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 3, cents(99), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 4, cents(98), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 6, cents(101), AGENTID_INVALID);
+
+	CHECK_EQUAL("99:8 98:4", levelsOf(book->buyQueue()));
+	CHECK_EQUAL((size_t)2, book->buyQueue().best().size());
+	CHECK_EQUAL((Volume)12, book->buyQueue().volume());
+	CHECK_EQUAL((Volume)6, book->sellQueue().volume());
+}
+
+TEST(BookVolumeFollowsPartialAndFullFills) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(101), AGENTID_INVALID);
+
+	book->placeMarketOrder(OrderDirection::Buy, 1, 7, AGENTID_INVALID);
+	CHECK_EQUAL("100:5 100:2", tradesOf(*book));
+	CHECK_EQUAL("100:3 101:5", levelsOf(book->sellQueue()));
+	CHECK_EQUAL((size_t)1, book->sellQueue().best().size());
+	CHECK_EQUAL((Volume)8, book->sellQueue().volume());
+
+	// an aggressive limit order rests with what is left of it once it has crossed
+	book->placeLimitOrder(OrderDirection::Buy, 2, 10, cents(101), AGENTID_INVALID);
+	CHECK_EQUAL("100:3 101:5", tradesOf(*book));
+	CHECK(book->sellQueue().empty());
+	CHECK_EQUAL((Volume)0, book->sellQueue().volume());
+	CHECK_EQUAL("101:2", levelsOf(book->buyQueue()));
+	CHECK_EQUAL((Volume)2, book->buyQueue().volume());
+}
+
+TEST(BookVolumeFollowsCancellations) {
+	BookPtr book = makeBook("PriceTime");
+	LimitOrderPtr first = book->placeLimitOrder(OrderDirection::Buy, 0, 5, cents(99), AGENTID_INVALID);
+	LimitOrderPtr second = book->placeLimitOrder(OrderDirection::Buy, 0, 3, cents(99), AGENTID_INVALID);
+	LimitOrderPtr other = book->placeLimitOrder(OrderDirection::Buy, 0, 4, cents(98), AGENTID_INVALID);
+
+	// the partial cancellation returns what is left of the order
+	CHECK_EQUAL((Volume)3, book->cancelOrder(first->id(), 2));
+	CHECK_EQUAL("99:6 98:4", levelsOf(book->buyQueue()));
+	CHECK_EQUAL((size_t)2, book->buyQueue().best().size());
+	CHECK_EQUAL((Volume)10, book->buyQueue().volume());
+
+	book->cancelOrder(second->id());
+	CHECK_EQUAL("99:3 98:4", levelsOf(book->buyQueue()));
+	CHECK_EQUAL((size_t)1, book->buyQueue().best().size());
+
+	// cancelling more than is left takes the order out, and its level with it
+	CHECK_EQUAL((Volume)0, book->cancelOrder(first->id(), 10));
+	CHECK_EQUAL("98:4", levelsOf(book->buyQueue()));
+	CHECK_EQUAL((Volume)4, book->buyQueue().volume());
+	CHECK(!book->contains(first->id()));
+
+	book->cancelOrder(other->id());
+	CHECK(book->buyQueue().empty());
+	CHECK_EQUAL((Volume)0, book->buyQueue().volume());
+}
+
+TEST(BookVolumeSameUnderEveryAlgorithm) {
+	for (const char* algorithm : { "PriceTime", "PureProRata", "PriorityProRata", "TimeProRata" }) {
+		BookPtr book = makeBook(algorithm);
+		book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(100), AGENTID_INVALID);
+		book->placeLimitOrder(OrderDirection::Sell, 0, 6, cents(100), AGENTID_INVALID);
+		book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(102), AGENTID_INVALID);
+
+		book->placeMarketOrder(OrderDirection::Buy, 1, 5, AGENTID_INVALID);
+		CHECK_EQUAL("100:5 102:5", levelsOf(book->sellQueue()));
+		CHECK_EQUAL((Volume)10, book->sellQueue().volume());
+
+		Volume levelVolume = 0;
+		book->placeMarketOrder(OrderDirection::Buy, 2, 5, AGENTID_INVALID);
+		for (const PriceLevel& level : book->sellQueue()) {
+			levelVolume += level.volume();
+		}
+		CHECK_EQUAL(levelVolume, book->sellQueue().volume());
+		CHECK_EQUAL("102:5", levelsOf(book->sellQueue()));
+	}
+}
@@ -0,0 +1,207 @@
+#include "Tests.h"
+#include "TestBooks.h"
+#include "BookJournal.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+// A book journaled the way the exchange journals its book: every order, then the fills it caused, stamped with its time
+class JournaledBook {
+public:
+	JournaledBook(const std::string& algorithm, const std::string& path)
+		: m_book(makeBook(algorithm)), m_writer(path, algorithm, m_book->tickSize()) { }
+
+	Book& book() { return *m_book; }
+	JournalWriter& writer() { return m_writer; }
+
+	OrderID limitOrder(Timestamp timestamp, OrderDirection direction, Volume volume, Money price) {
+		const OrderID id = m_book->placeLimitOrder(direction, timestamp, volume, price, AGENTID_INVALID)->id();
+		m_writer.limitOrder(timestamp, id, direction, volume, price);
+		journalFills(timestamp);
+		return id;
+	}
+	OrderID marketOrder(Timestamp timestamp, OrderDirection direction, Volume volume) {
+		const OrderID id = m_book->placeMarketOrder(direction, timestamp, volume, AGENTID_INVALID)->id();
+		m_writer.marketOrder(timestamp, id, direction, volume);
+		journalFills(timestamp);
+		return id;
+	}
+	OrderID stopOrder(Timestamp timestamp, OrderDirection direction, Volume volume, Money stopPrice) {
+		const OrderID id = m_book->placeStopOrder(direction, timestamp, volume, stopPrice, std::nullopt, AGENTID_INVALID);
+		m_writer.stopOrder(timestamp, id, direction, volume, stopPrice, std::nullopt);
+		return id;
+	}
+	void cancel(Timestamp timestamp, OrderID id, Volume volume) {
+		m_book->cancelOrder(id, volume);
+		m_writer.cancel(timestamp, id, volume);
+	}
+	void amend(Timestamp timestamp, OrderID id, Volume volume) {
+		m_book->amendOrder(id, timestamp, volume);
+		m_writer.amend(timestamp, id, volume);
+	}
+	void uncross(Timestamp timestamp) {
+		m_book->uncross(timestamp);
+		m_writer.uncross(timestamp);
+		journalFills(timestamp);
+	}
+private:
+	BookPtr m_book;
+	JournalWriter m_writer;
+	std::vector<Trade> m_trades;
+
+	void journalFills(Timestamp timestamp) {
+		m_book->takeTrades(m_trades);
+		for (Trade& trade : m_trades) {
+			trade.setTimestamp(timestamp);
+			m_writer.fill(trade);
+		}
+	}
+};
+
+// a journal file of the test, removed along with it
+class JournalFile {
+public:
+	JournalFile(const std::string& name) : m_path((std::filesystem::temp_directory_path() / (name + ".jrnl")).string()) { }
+	~JournalFile() { std::remove(m_path.c_str()); }
+
+	const std::string& path() const { return m_path; }
+private:
+	std::string m_path;
+};
+
+// a random flow of orders, with the cancellations and the amendments of some of the resting ones
+static void journalRandomFlow(JournaledBook& journaled, int orders) {
+	std::mt19937_64 random(11);
+	std::vector<OrderID> ids;
+	for (Timestamp timestamp = 1; timestamp <= (Timestamp)orders; ++timestamp) {
+		const OrderDirection direction = random() % 2 == 0 ? OrderDirection::Buy : OrderDirection::Sell;
+		const Volume volume = 1 + random() % 9;
+		switch (random() % 8) {
+		case 0:
+			journaled.marketOrder(timestamp, direction, volume);
+			break;
+		case 1:
+			if (!ids.empty()) {
+				journaled.cancel(timestamp, ids[random() % ids.size()], volume);
+			}
+			break;
+		case 2:
+			if (!ids.empty()) {
+				journaled.amend(timestamp, ids[random() % ids.size()], volume);
+			}
+			break;
+		case 3:
+			journaled.stopOrder(timestamp, direction, volume, cents(direction == OrderDirection::Buy ? 103 : 97));
+			break;
+		default:
+			// around a mid price of 1.00, crossing it now and then
+			const long long offset = (long long)(random() % 8) - 2;
+			ids.push_back(journaled.limitOrder(timestamp, direction, volume, cents(direction == OrderDirection::Buy ? 100 - offset : 100 + offset)));
+			break;
+		}
+	}
+}
+
+TEST(JournalReplayMatchesEveryAlgorithm) {
+	for (const char* algorithm : { "PriceTime", "PureProRata", "PriorityProRata", "TimeProRata" }) {
+		JournalFile file(std::string("JournalReplayMatches") + algorithm);
+		std::string levels[2];
+		{
+			JournaledBook journaled(algorithm, file.path());
+			// more records than a block holds, so that the journal reads back in several
+			journalRandomFlow(journaled, 3 * (int)JournalWriter::BLOCK_SIZE);
+			levels[0] = levelsOf(journaled.book().buyQueue());
+			levels[1] = levelsOf(journaled.book().sellQueue());
+		}
+
+		JournalReplay replay(file.path());
+		CHECK_EQUAL(std::string(algorithm), replay.algorithm());
+		BookPtr book = BookFactory::make(replay.algorithm(), replay.tickSize());
+		replay.replay(*book);
+
+		CHECK(replay.records() > JournalWriter::BLOCK_SIZE);
+		CHECK(replay.fills() > 0);
+		CHECK_EQUAL((std::uint64_t)0, replay.mismatchedFills());
+		CHECK_EQUAL(levels[0], levelsOf(book->buyQueue()));
+		CHECK_EQUAL(levels[1], levelsOf(book->sellQueue()));
+	}
+}
+
+TEST(JournalReplayUnderOtherAlgorithmMismatches) {
+	JournalFile file("JournalReplayOtherAlgorithm");
+	{
+		JournaledBook journaled("PriceTime", file.path());
+		journaled.limitOrder(1, OrderDirection::Sell, 4, cents(100));
+		journaled.limitOrder(2, OrderDirection::Sell, 4, cents(100));
+		journaled.marketOrder(3, OrderDirection::Buy, 4);
+	}
+
+	// price-time fills the first order whole, pro-rata shares the aggressor out between the two: the fill journaled does not
+	// match the first one the book makes, and the second one is not journaled at all
+	JournalReplay replay(file.path());
+	BookPtr book = makeBook("PureProRata");
+	replay.replay(*book);
+	CHECK_EQUAL((std::uint64_t)1, replay.fills());
+	CHECK_EQUAL((std::uint64_t)2, replay.mismatchedFills());
+	CHECK_EQUAL("100:4", levelsOf(book->sellQueue()));
+}
+
+TEST(JournalReplayCancelAndAmend) {
+	JournalFile file("JournalReplayCancelAndAmend");
+	{
+		JournaledBook journaled("PriceTime", file.path());
+		const OrderID first = journaled.limitOrder(1, OrderDirection::Buy, 6, cents(99));
+		const OrderID second = journaled.limitOrder(2, OrderDirection::Buy, 6, cents(99));
+		journaled.cancel(3, first, 2);
+		journaled.amend(4, second, 9);
+		journaled.marketOrder(5, OrderDirection::Sell, 5);
+	}
+
+	JournalReplay replay(file.path());
+	BookPtr book = makeBook("PriceTime");
+	replay.replay(*book);
+	// the amended order went to the back, behind what was left of the other one
+	CHECK_EQUAL((std::uint64_t)7, replay.records());
+	CHECK_EQUAL((std::uint64_t)2, replay.fills());
+	CHECK_EQUAL((std::uint64_t)0, replay.mismatchedFills());
+	CHECK_EQUAL("99:8", levelsOf(book->buyQueue()));
+}
+
+TEST(JournalReplayTriggeredStops) {
+	JournalFile file("JournalReplayTriggeredStops");
+	{
+		JournaledBook journaled("PriceTime", file.path());
+		journaled.limitOrder(1, OrderDirection::Sell, 2, cents(100));
+		journaled.limitOrder(1, OrderDirection::Sell, 5, cents(101));
+		journaled.stopOrder(2, OrderDirection::Buy, 3, cents(100));
+		journaled.marketOrder(3, OrderDirection::Buy, 2);
+	}
+
+	// the stop order fills within the order that triggered it
+	JournalReplay replay(file.path());
+	BookPtr book = makeBook("PriceTime");
+	replay.replay(*book);
+	CHECK_EQUAL((std::uint64_t)2, replay.fills());
+	CHECK_EQUAL((std::uint64_t)0, replay.mismatchedFills());
+	CHECK_EQUAL("101:2", levelsOf(book->sellQueue()));
+}
+
+TEST(JournalReplayBatchAuction) {
+	JournalFile file("JournalReplayBatchAuction");
+	{
+		JournaledBook journaled("BatchAuction", file.path());
+		journaled.limitOrder(1, OrderDirection::Buy, 5, cents(101));
+		journaled.limitOrder(2, OrderDirection::Sell, 3, cents(99));
+		journaled.limitOrder(3, OrderDirection::Sell, 4, cents(100));
+		journaled.uncross(4);
+	}
+
+	JournalReplay replay(file.path());
+	BookPtr book = BookFactory::make(replay.algorithm(), replay.tickSize());
+	replay.replay(*book);
+	CHECK(replay.fills() > 0);
+	CHECK_EQUAL((std::uint64_t)0, replay.mismatchedFills());
+	CHECK(book->buyQueue().empty());
+	CHECK_EQUAL("100:2", levelsOf(book->sellQueue()));
+}
@@ -0,0 +1,143 @@
+#include "Tests.h"
+#include "PriorityMessageQueue.h"
+#include "TimingWheelMessageQueue.h"
+
+#include <algorithm>
+#include <random>
+
+// a message of its own, numbered among those of its source
+static MessagePtr makeMessage(Timestamp occurrence, Timestamp arrival, AgentId source, unsigned long long sequence) {
+	MessagePtr messagePtr(new Message(occurrence, arrival, source, AGENTID_INVALID, MESSAGETYPE_INVALID, MessagePayloadVariant()));
+	messagePtr->sequence = sequence;
+	return messagePtr;
+}
+
+// the messages in the order the queue pops them, as "arrival:source:sequence"
+static std::string drain(IMessageQueue& queue) {
+	std::string messages;
+	while (!queue.empty()) {
+		const MessagePtr& messagePtr = queue.top();
+		messages += (messages.empty() ? "" : " ") + std::to_string(messagePtr->arrival) + ":" + std::to_string(messagePtr->source) + ":"
+			+ std::to_string(messagePtr->sequence);
+		queue.pop();
+	}
+	return messages;
+}
+
+// Runs a simulation-like workload through the wheel and the heap side by side: every step either pops the next message, or
+// peeks at it, and then pushes a few more from the time of the last message popped. The delays go from none, for the ties,
+// to far past the smaller wheels, for the overflow; and after a peek, the cursor of the wheel may have moved past the time
+// the new messages arrive at.
+static void checkWheelAgainstHeap(MessageTieOrder tieOrder, size_t wheelSize, std::uint64_t seed) {
+	TimingWheelMessageQueue wheel(wheelSize, tieOrder);
+	PriorityMessageQueue heap(tieOrder);
+	std::mt19937_64 random(seed);
+	std::vector<unsigned long long> sequences(5, 0);
+	Timestamp now = 0;
+
+	for (int step = 0; step < 20000; ++step) {
+		if (!heap.empty()) {
+			CHECK(wheel.top() == heap.top());
+			if (random() % 4 != 0) {
+				now = std::max(now, heap.top()->arrival);
+				wheel.pop();
+				heap.pop();
+			}
+		}
+
+		for (int count = (int)(random() % 4); count > 0; --count) {
+			Timestamp delay = 0;
+			switch (random() % 5) {
+				case 0: delay = 0; break;
+				case 1: delay = random() % 10; break;
+				case 2: delay = random() % 300; break;
+				case 3: delay = random() % 20000; break;
+			}
+			// now and then one from before the time of the last message, which goes out first
+			const Timestamp arrival = random() % 20 == 0 ? now - std::min<Timestamp>(now, random() % 5) : now + delay;
+			const AgentId source = (AgentId)(random() % sequences.size());
+			const MessagePtr messagePtr = makeMessage(now, arrival, source, sequences[source]++);
+			wheel.push(messagePtr);
+			heap.push(messagePtr);
+		}
+		CHECK_EQUAL(heap.size(), wheel.size());
+	}
+
+	while (!heap.empty()) {
+		CHECK(wheel.top() == heap.top());
+		wheel.pop();
+		heap.pop();
+	}
+	CHECK(wheel.empty());
+}
+
+TEST(MessageQueueWheelMatchesHeapInPushOrder) {
+	for (size_t wheelSize : { 1, 2, 63, 64, 100, 1000, 4096 }) {
+		checkWheelAgainstHeap(MessageTieOrder::Push, wheelSize, wheelSize);
+	}
+}
+
+TEST(MessageQueueWheelMatchesHeapInDeliveryOrder) {
+	for (size_t wheelSize : { 1, 2, 63, 64, 100, 1000, 4096 }) {
+		checkWheelAgainstHeap(MessageTieOrder::Delivery, wheelSize, wheelSize);
+	}
+}
+
+TEST(MessageQueuePushOrderTies) {
+	TimingWheelMessageQueue wheel(64, MessageTieOrder::Push);
+	PriorityMessageQueue heap(MessageTieOrder::Push);
+	for (IMessageQueue* queue : { (IMessageQueue*)&wheel, (IMessageQueue*)&heap }) {
+		queue->push(makeMessage(0, 10, 3, 0));
+		queue->push(makeMessage(0, 10, 1, 0));
+		queue->push(makeMessage(0, 5, 2, 0));
+		queue->push(makeMessage(0, 10, 2, 1));
+		queue->push(makeMessage(0, 10, 1, 1));
+		CHECK_EQUAL(std::string("5:2:0 10:3:0 10:1:0 10:2:1 10:1:1"), drain(*queue));
+	}
+}
+
+TEST(MessageQueueDeliveryOrderTies) {
+	TimingWheelMessageQueue wheel(64, MessageTieOrder::Delivery);
+	PriorityMessageQueue heap(MessageTieOrder::Delivery);
+	for (IMessageQueue* queue : { (IMessageQueue*)&wheel, (IMessageQueue*)&heap }) {
+		// by occurrence, then by source, then by the sequence of the source
+		queue->push(makeMessage(2, 10, 1, 4));
+		queue->push(makeMessage(1, 10, 3, 0));
+		queue->push(makeMessage(2, 10, 1, 3));
+		queue->push(makeMessage(2, 10, 0, 7));
+		queue->push(makeMessage(1, 10, 2, 5));
+		CHECK_EQUAL(std::string("10:2:5 10:3:0 10:0:7 10:1:3 10:1:4"), drain(*queue));
+	}
+}
+
+TEST(MessageQueueWheelOverflowMigration) {
+	// past the window of the wheel, the messages wait in the overflow until the cursor gets near them
+	TimingWheelMessageQueue wheel(64, MessageTieOrder::Push);
+	wheel.push(makeMessage(0, 1000, 0, 0));
+	wheel.push(makeMessage(0, 10, 0, 1));
+	wheel.push(makeMessage(0, 5000, 0, 2));
+	wheel.push(makeMessage(0, 70, 0, 3));
+	wheel.push(makeMessage(0, 1000, 0, 4));
+	CHECK_EQUAL((size_t)5, wheel.size());
+
+	CHECK_EQUAL((Timestamp)10, wheel.top()->arrival);
+	wheel.pop();
+	// pushed once the window has moved on, a message at the time of one in the overflow goes after it
+	wheel.push(makeMessage(10, 1000, 0, 5));
+	CHECK_EQUAL(std::string("70:0:3 1000:0:0 1000:0:4 1000:0:5 5000:0:2"), drain(wheel));
+}
+
+TEST(MessageQueueWheelPastArrival) {
+	for (MessageTieOrder tieOrder : { MessageTieOrder::Push, MessageTieOrder::Delivery }) {
+		TimingWheelMessageQueue wheel(64, tieOrder);
+		wheel.push(makeMessage(0, 100, 0, 0));
+		wheel.push(makeMessage(0, 100, 0, 1));
+
+		// the peek moves the cursor to 100, the messages arriving before then go out first, in the order of their arrival
+		CHECK_EQUAL((Timestamp)100, wheel.top()->arrival);
+		wheel.push(makeMessage(0, 50, 1, 0));
+		wheel.push(makeMessage(0, 40, 2, 0));
+		wheel.push(makeMessage(0, 50, 1, 1));
+		CHECK_EQUAL(std::string("40:2:0 50:1:0 50:1:1 100:0:0 100:0:1"), drain(wheel));
+	}
+}
@@ -0,0 +1,32 @@
+# Runs the scenario of several exchanges in parallel and sequentially, with either scheduler, and checks that the journals
+# and the L1 logs of the exchanges are all the same as those of the first run
+#
+# cmake -DSIMULATOR=<executable> -DSCENARIO=<file> -DOUTPUT_DIRECTORY=<directory> -P ParallelParity.cmake
+
+file (REMOVE_RECURSE "${OUTPUT_DIRECTORY}")
+file (MAKE_DIRECTORY "${OUTPUT_DIRECTORY}")
+
+set (runs "TimingWheel_true" "TimingWheel_false" "PriorityQueue_true" "PriorityQueue_false")
+foreach (run ${runs})
+	string (REPLACE "_" ";" settings ${run})
+	list (GET settings 0 scheduler)
+	list (GET settings 1 parallel)
+	execute_process (
+		COMMAND "${SIMULATOR}" -s "${SCENARIO}" "scheduler=${scheduler}" "parallel=${parallel}" "outputDirectory=${OUTPUT_DIRECTORY}"
+		RESULT_VARIABLE result)
+	if (NOT result EQUAL 0)
+		message (FATAL_ERROR "the ${scheduler} run with parallel=${parallel} failed: ${result}")
+	endif ()
+endforeach ()
+
+list (GET runs 0 reference)
+foreach (run ${runs})
+	foreach (output A.jrnl B.jrnl C.jrnl A.csv B.csv C.csv)
+		execute_process (
+			COMMAND ${CMAKE_COMMAND} -E compare_files "${OUTPUT_DIRECTORY}/${reference}_${output}" "${OUTPUT_DIRECTORY}/${run}_${output}"
+			RESULT_VARIABLE result)
+		if (NOT result EQUAL 0)
+			message (FATAL_ERROR "${run}_${output} differs from ${reference}_${output}")
+		endif ()
+	endforeach ()
+endforeach ()
@@ -0,0 +1,125 @@
+#include "Tests.h"
+#include "TestBooks.h"
+
+// The window of the ladder is at most PriceLadder::MAX_WINDOW_SIZE ticks wide, the prices further from the touch go to the overflow map.
+static const long long FAR = (long long)PriceLadder::MAX_WINDOW_SIZE * 3;
+
+TEST(PriceLadderWindowAndOverflowBestFirst) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(101), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 7, cents(100 + FAR), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 3, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 2, cents(101), AGENTID_INVALID);
+
+	CHECK_EQUAL("100:3 101:7 " + std::to_string(100 + FAR) + ":7", levelsOf(book->sellQueue()));
+	CHECK_EQUAL((size_t)3, book->sellQueue().size());
+	CHECK_EQUAL((Volume)17, book->sellQueue().volume());
+	CHECK(book->buyQueue().empty());
+}
+
+TEST(PriceLadderBuySideBestFirst) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 1, cents(FAR + 10), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 2, cents(10), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 3, cents(FAR + 11), AGENTID_INVALID);
+
+	CHECK_EQUAL(std::to_string(FAR + 11) + ":3 " + std::to_string(FAR + 10) + ":1 10:2", levelsOf(book->buyQueue()));
+	CHECK_EQUAL((Volume)6, book->buyQueue().volume());
+}
+
+TEST(PriceLadderRecentersOnOverflowAfterSweep) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(101), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(100 + FAR), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 6, cents(101 + FAR), AGENTID_INVALID);
+
+	// the sweep leaves only the far levels, the window has to follow them
+	book->placeMarketOrder(OrderDirection::Buy, 1, 10, AGENTID_INVALID);
+	CHECK_EQUAL("100:5 101:5", tradesOf(*book));
+	CHECK_EQUAL(std::to_string(100 + FAR) + ":4 " + std::to_string(101 + FAR) + ":6", levelsOf(book->sellQueue()));
+	CHECK_EQUAL((Volume)10, book->sellQueue().volume());
+
+	// and the next sweep trades at them
+	book->placeMarketOrder(OrderDirection::Buy, 2, 5, AGENTID_INVALID);
+	CHECK_EQUAL(std::to_string(100 + FAR) + ":4 " + std::to_string(101 + FAR) + ":1", tradesOf(*book));
+	CHECK_EQUAL(std::to_string(101 + FAR) + ":5", levelsOf(book->sellQueue()));
+}
+
+TEST(PriceLadderRecentersOnBetterPriceOutsideWindow) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(2 * FAR), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 3, cents(2 * FAR + 1), AGENTID_INVALID);
+
+	// far below the window, the new best level is in front of all the others
+	book->placeLimitOrder(OrderDirection::Sell, 0, 2, cents(50), AGENTID_INVALID);
+	CHECK_EQUAL("50:2 " + std::to_string(2 * FAR) + ":4 " + std::to_string(2 * FAR + 1) + ":3", levelsOf(book->sellQueue()));
+
+	book->placeLimitOrder(OrderDirection::Sell, 0, 1, cents(51), AGENTID_INVALID);
+	book->placeMarketOrder(OrderDirection::Buy, 1, 4, AGENTID_INVALID);
+	CHECK_EQUAL("50:2 51:1 " + std::to_string(2 * FAR) + ":1", tradesOf(*book));
+	CHECK_EQUAL(std::to_string(2 * FAR) + ":3 " + std::to_string(2 * FAR + 1) + ":3", levelsOf(book->sellQueue()));
+	CHECK_EQUAL((Volume)6, book->sellQueue().volume());
+}
+
+TEST(PriceLadderKeepsLevelsAcrossRepeatedRecentering) {
+	BookPtr book = makeBook("PriceTime");
+
+	// every level is a window apart from the next, each sweep moves the window once more
+	for (long long level = 0; level < 8; ++level) {
+		book->placeLimitOrder(OrderDirection::Buy, 0, 1 + level, cents(10 + level * FAR), AGENTID_INVALID);
+	}
+	CHECK_EQUAL((size_t)8, book->buyQueue().size());
+
+	for (long long level = 7; level >= 0; --level) {
+		CHECK_EQUAL(10 + level * FAR, book->buyQueue().best().price().ticks());
+		book->placeMarketOrder(OrderDirection::Sell, 1, 1 + level, AGENTID_INVALID);
+		CHECK_EQUAL(std::to_string(10 + level * FAR) + ":" + std::to_string(1 + level), tradesOf(*book));
+	}
+	CHECK(book->buyQueue().empty());
+	CHECK_EQUAL((Volume)0, book->buyQueue().volume());
+}
+
+TEST(PriceLadderCancelOutsideWindow) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), AGENTID_INVALID);
+	LimitOrderPtr far = book->placeLimitOrder(OrderDirection::Sell, 0, 7, cents(100 + FAR), AGENTID_INVALID);
+
+	book->cancelOrder(far->id());
+	CHECK_EQUAL("100:5", levelsOf(book->sellQueue()));
+	CHECK(!book->contains(far->id()));
+	CHECK_EQUAL((Volume)5, book->sellQueue().volume());
+}
+
+TEST(PriceLadderEmptySide) {
+	BookPtr book = makeBook("PriceTime");
+	CHECK(book->sellQueue().empty());
+	CHECK_EQUAL(std::string(), levelsOf(book->sellQueue()));
+
+	// the side is usable again once its last level is gone
+	LimitOrderPtr order = book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), AGENTID_INVALID);
+	book->cancelOrder(order->id());
+	CHECK(book->sellQueue().empty());
+	CHECK_EQUAL(std::string(), levelsOf(book->sellQueue()));
+	book->placeLimitOrder(OrderDirection::Sell, 0, 3, cents(100 + FAR), AGENTID_INVALID);
+	CHECK_EQUAL(std::to_string(100 + FAR) + ":3", levelsOf(book->sellQueue()));
+	CHECK(book->buyQueue().empty());
+}
+
+TEST(PriceLadderSmallWindow) {
+	// the levels spread over several windows of the smallest size, and the sweep crosses them all
+	BookPtr book = makeBook("PriceTime", PriceLadder::MIN_WINDOW_SIZE);
+	std::string expected;
+	for (long long level = 9; level >= 0; --level) {
+		book->placeLimitOrder(OrderDirection::Sell, 0, 1, cents(100 + level * 50), AGENTID_INVALID);
+	}
+	for (long long level = 0; level < 10; ++level) {
+		expected += (expected.empty() ? "" : " ") + std::to_string(100 + level * 50) + ":1";
+	}
+	CHECK_EQUAL(expected, levelsOf(book->sellQueue()));
+
+	book->placeMarketOrder(OrderDirection::Buy, 1, 10, AGENTID_INVALID);
+	CHECK_EQUAL(expected, tradesOf(*book));
+	CHECK(book->sellQueue().empty());
+	CHECK_EQUAL((Volume)0, book->sellQueue().volume());
+}
@@ -0,0 +1,188 @@
+#include "Tests.h"
+#include "TestBooks.h"
+#include "ProRataKernel.h"
+
+#include <random>
+
+// the owner of the resting order and the volume of every fill, in the order of the fills
+static std::string fillsOf(Book& book) {
+	std::vector<Trade> trades;
+	book.takeTrades(trades);
+
+	std::string fills;
+	for (const Trade& trade : trades) {
+		fills += (fills.empty() ? "" : " ") + std::to_string(trade.restingAgent()) + ":" + std::to_string(trade.volume());
+	}
+	return fills;
+}
+
+TEST(ProRataSharesThenRemainderToOldest) {
+	BookPtr book = makeBook("PureProRata");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 3, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 3, cents(100), 2);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(100), 3);
+
+	// the shares of 5 are 1.5, 1.5 and 2, floored to 1, 1 and 2; the lot left over goes to the oldest order
+	book->placeMarketOrder(OrderDirection::Buy, 1, 5, AGENTID_INVALID);
+	CHECK_EQUAL("1:1 2:1 3:2 1:1", fillsOf(*book));
+	CHECK_EQUAL("100:5", levelsOf(book->sellQueue()));
+	CHECK_EQUAL((size_t)3, book->sellQueue().best().size());
+}
+
+TEST(ProRataRemainderSkipsFilledOrders) {
+	BookPtr book = makeBook("PureProRata");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 1, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 1, cents(100), 2);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 8, cents(100), 3);
+
+	// the shares of 9 are 0.9, 0.9 and 7.2, floored to 0, 0 and 7; the remainder of 2 goes out oldest first
+	book->placeMarketOrder(OrderDirection::Buy, 1, 9, AGENTID_INVALID);
+	CHECK_EQUAL("3:7 1:1 2:1", fillsOf(*book));
+	CHECK_EQUAL("100:1", levelsOf(book->sellQueue()));
+	CHECK_EQUAL((size_t)1, book->sellQueue().best().size());
+}
+
+TEST(ProRataCoveredLevelFillsWholeThenNext) {
+	BookPtr book = makeBook("PureProRata");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 2, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 3, cents(100), 2);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 4, cents(99), 3);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 4, cents(99), 4);
+
+	book->placeMarketOrder(OrderDirection::Sell, 1, 7, AGENTID_INVALID);
+	CHECK_EQUAL("1:2 2:3 3:1 4:1", fillsOf(*book));
+	CHECK_EQUAL("99:6", levelsOf(book->buyQueue()));
+}
+
+TEST(ProRataTimeWeightedRemainderToOldest) {
+	BookPtr book = makeBook("TimeProRata");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 2, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 2, cents(100), 2);
+
+	// the shares of 2 are 2 * (16 - 4) / 16 = 1.5 and 2 * (4 - 0) / 16 = 0.5, floored to 1 and 0
+	book->placeMarketOrder(OrderDirection::Buy, 1, 2, AGENTID_INVALID);
+	CHECK_EQUAL("1:1 1:1", fillsOf(*book));
+	CHECK_EQUAL("100:2", levelsOf(book->sellQueue()));
+}
+
+TEST(ProRataBetteringOrderFillsFirst) {
+	BookPtr book = makeBook("PriorityProRata");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(101), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(101), 2);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), 3);
+
+	// the better price fills whole, its level goes, and the rest of the aggressor is shared out on the next one
+	book->placeMarketOrder(OrderDirection::Buy, 1, 7, AGENTID_INVALID);
+	CHECK_EQUAL("3:5 1:1 2:1", fillsOf(*book));
+	CHECK_EQUAL("101:8", levelsOf(book->sellQueue()));
+}
+
+TEST(ProRataBetteringOrderTakesWholeAggressor) {
+	BookPtr book = makeBook("PriorityProRata");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 5, cents(99), 1);
+	book->placeLimitOrder(OrderDirection::Buy, 0, 3, cents(100), 2);
+
+	// nothing is left of either of them, nor of the level of the bettering order
+	book->placeLimitOrder(OrderDirection::Sell, 1, 3, cents(99), 3);
+	CHECK_EQUAL("2:3", fillsOf(*book));
+	CHECK_EQUAL("99:5", levelsOf(book->buyQueue()));
+	CHECK_EQUAL((size_t)1, book->buyQueue().size());
+	CHECK(book->sellQueue().empty());
+}
+
+TEST(ProRataWorseLevelDoesNotBetter) {
+	BookPtr book = makeBook("PriorityProRata");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 6, cents(100), 2);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(102), 3);
+
+	// the order opening the level behind the best one gets no priority, nor a fill at the best price
+	book->placeMarketOrder(OrderDirection::Buy, 1, 5, AGENTID_INVALID);
+	CHECK_EQUAL("1:4 2:1", fillsOf(*book));
+	CHECK_EQUAL("100:5 102:5", levelsOf(book->sellQueue()));
+
+	book->placeMarketOrder(OrderDirection::Buy, 2, 6, AGENTID_INVALID);
+	CHECK_EQUAL("2:5 3:1", fillsOf(*book));
+	CHECK_EQUAL("102:4", levelsOf(book->sellQueue()));
+}
+
+TEST(ProRataBetteringPriorityLostOnAmendUp) {
+	BookPtr book = makeBook("PriorityProRata");
+	LimitOrderPtr bettering = book->placeLimitOrder(OrderDirection::Sell, 0, 2, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(100), 2);
+	book->amendOrder(bettering->id(), 1, 4);
+
+	// the shares of 4 are 2 and 2, with no priority left
+	book->placeMarketOrder(OrderDirection::Buy, 2, 4, AGENTID_INVALID);
+	CHECK_EQUAL("2:2 1:2", fillsOf(*book));
+	CHECK_EQUAL("100:4", levelsOf(book->sellQueue()));
+}
+
+TEST(ProRataKernelSharesBoundedByVolumes) {
+	std::mt19937_64 random(7);
+	std::vector<Volume> volumes;
+	std::vector<Volume> shares;
+	for (int round = 0; round < 1000; ++round) {
+		const size_t count = 1 + random() % 40;
+		volumes.resize(count);
+		shares.resize(count);
+		Volume levelVolume = 0;
+		for (Volume& volume : volumes) {
+			volume = 1 + random() % 100000;
+			levelVolume += volume;
+		}
+		const Volume incomingVolume = 1 + random() % (2 * levelVolume);
+
+		for (auto computeShares : { computePureProRataShares, computeTimeProRataShares }) {
+			computeShares(incomingVolume, levelVolume, volumes.data(), shares.data(), count);
+			Volume total = 0;
+			for (size_t i = 0; i < count; ++i) {
+				CHECK(shares[i] <= volumes[i]);
+				total += shares[i];
+			}
+			// the pure shares fall short by less than a lot per order from the flooring, the time weighted ones by more where
+			// they are capped at the volumes, for the remainder pass
+			CHECK(total <= std::min(incomingVolume, levelVolume));
+			if (computeShares == computePureProRataShares) {
+				CHECK(total + count >= std::min(incomingVolume, levelVolume));
+				for (size_t i = 0; i < count && incomingVolume < levelVolume; ++i) {
+					CHECK_EQUAL((Volume)((unsigned long long)incomingVolume * volumes[i] / levelVolume), shares[i]);
+				}
+			}
+		}
+	}
+}
+
+TEST(ProRataKernelWholeLevelWhenCovered) {
+	const Volume volumes[] = { 3, 1, 6 };
+	Volume shares[3];
+	computePureProRataShares(25, 10, volumes, shares, 3);
+	CHECK_EQUAL((Volume)3, shares[0]);
+	CHECK_EQUAL((Volume)1, shares[1]);
+	CHECK_EQUAL((Volume)6, shares[2]);
+}
+
+TEST(ProRataKernelExactShares) {
+	// 58 * 100 / 200 is 29 exactly, which the product in double precision floors to 28
+	const Volume volumes[] = { 100, 100 };
+	Volume shares[2];
+	computePureProRataShares(58, 200, volumes, shares, 2);
+	CHECK_EQUAL((Volume)29, shares[0]);
+	CHECK_EQUAL((Volume)29, shares[1]);
+
+	// 4 * 7 * (2 * 14 - 7) / 14^2 and 4 * 7 * 7 / 14^2 are 3 and 1 exactly, which double precision floors to 2 and 0
+	const Volume timeVolumes[] = { 7, 7 };
+	computeTimeProRataShares(4, 14, timeVolumes, shares, 2);
+	CHECK_EQUAL((Volume)3, shares[0]);
+	CHECK_EQUAL((Volume)1, shares[1]);
+}
+
+TEST(ProRataEqualOrdersFillEqually) {
+	BookPtr book = makeBook("PureProRata");
+	book->placeLimitOrder(OrderDirection::Sell, 0, 100, cents(100), 1);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 100, cents(100), 2);
+
+	book->placeMarketOrder(OrderDirection::Buy, 1, 58, AGENTID_INVALID);
+	CHECK_EQUAL("1:29 2:29", fillsOf(*book));
+	CHECK_EQUAL("100:142", levelsOf(book->sellQueue()));
+}
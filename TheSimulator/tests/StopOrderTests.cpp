@@ -0,0 +1,69 @@
+#include "Tests.h"
+#include "TestBooks.h"
+
+// the aggressing orders of the trades since the last call, in the order of the trades
+static std::string aggressorsOf(Book& book) {
+	std::vector<Trade> trades;
+	book.takeTrades(trades);
+
+	std::string aggressors;
+	for (const Trade& trade : trades) {
+		aggressors += (aggressors.empty() ? "" : " ") + std::to_string(trade.aggressingOrderID());
+	}
+	return aggressors;
+}
+
+TEST(StopOrderTriggersOnTheRangeOfTheTrades) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 3, cents(99), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(100), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 5, cents(102), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 4, cents(103), AGENTID_INVALID);
+	const OrderID sellStop = book->placeStopOrder(OrderDirection::Sell, 0, 2, cents(100), std::nullopt, AGENTID_INVALID);
+	const OrderID buyStop = book->placeStopOrder(OrderDirection::Buy, 0, 1, cents(102), std::nullopt, AGENTID_INVALID);
+
+	// the sweep ends at 102, but it traded at 100 on the way, which reaches the sell stop as well
+	book->placeMarketOrder(OrderDirection::Buy, 1, 10, AGENTID_INVALID);
+	CHECK_EQUAL("100:5 102:5 103:1 99:2", tradesOf(*book));
+	CHECK(!book->contains(sellStop));
+	CHECK(!book->contains(buyStop));
+	CHECK_EQUAL("99:1", levelsOf(book->buyQueue()));
+	CHECK_EQUAL("103:3", levelsOf(book->sellQueue()));
+}
+
+TEST(StopOrderTriggerOrder) {
+	BookPtr book = makeBook("PriceTime");
+	book->placeLimitOrder(OrderDirection::Buy, 0, 10, cents(90), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 1, cents(95), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 1, cents(105), AGENTID_INVALID);
+	book->placeLimitOrder(OrderDirection::Sell, 0, 10, cents(110), AGENTID_INVALID);
+	const OrderID buyLate = book->placeStopOrder(OrderDirection::Buy, 0, 1, cents(105), std::nullopt, AGENTID_INVALID);
+	const OrderID buyEarly = book->placeStopOrder(OrderDirection::Buy, 0, 1, cents(104), std::nullopt, AGENTID_INVALID);
+	const OrderID buyLateAgain = book->placeStopOrder(OrderDirection::Buy, 0, 1, cents(105), std::nullopt, AGENTID_INVALID);
+	const OrderID sellLate = book->placeStopOrder(OrderDirection::Sell, 0, 1, cents(95), std::nullopt, AGENTID_INVALID);
+	const OrderID sellEarly = book->placeStopOrder(OrderDirection::Sell, 0, 1, cents(96), std::nullopt, AGENTID_INVALID);
+
+	// the buy stops from the lowest stop price up, then the sell stops from the highest one down, each price in the order placed
+	const MarketOrderPtr sweep = book->placeMarketOrder(OrderDirection::Buy, 1, 2, AGENTID_INVALID);
+	CHECK_EQUAL(std::to_string(sweep->id()) + " " + std::to_string(sweep->id()) + " " + std::to_string(buyEarly) + " " + std::to_string(buyLate) + " "
+		+ std::to_string(buyLateAgain) + " " + std::to_string(sellEarly) + " " + std::to_string(sellLate), aggressorsOf(*book));
+}
+
+TEST(StopOrderTriggersInTurn) {
+	BookPtr book = makeBook("PriceTime");
+	for (long long price = 100; price <= 103; ++price) {
+		book->placeLimitOrder(OrderDirection::Sell, 0, 1, cents(price), AGENTID_INVALID);
+	}
+	book->placeStopOrder(OrderDirection::Buy, 0, 1, cents(101), std::nullopt, AGENTID_INVALID);
+	const OrderID waiting = book->placeStopOrder(OrderDirection::Buy, 0, 1, cents(102), std::nullopt, AGENTID_INVALID);
+
+	book->placeMarketOrder(OrderDirection::Buy, 1, 1, AGENTID_INVALID);
+	CHECK_EQUAL("100:1", tradesOf(*book));
+	CHECK(book->contains(waiting));
+
+	// the trade of the first stop order triggers the second one
+	book->placeMarketOrder(OrderDirection::Buy, 2, 1, AGENTID_INVALID);
+	CHECK_EQUAL("101:1 102:1 103:1", tradesOf(*book));
+	CHECK(!book->contains(waiting));
+	CHECK(book->sellQueue().empty());
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Book.h"
+#include "BookFactory.h"
+
+#include <string>
+#include <vector>
+
+// the books of the tests quote in cents, so that the ticks are the cents
+inline BookPtr makeBook(const std::string& algorithm, size_t ladderWindow = PriceLadder::DEFAULT_WINDOW_SIZE) {
+	return BookFactory::make(algorithm, Money(0, 1), ladderWindow);
+}
+
+inline Money cents(long long amount) {
+	return Money(amount / 100, (unsigned int)(amount % 100));
+}
+
+// the levels of the side, best first, as "price:volume" in ticks
+inline std::string levelsOf(const PriceLadder& side) {
+	std::string levels;
+	for (const PriceLevel& level : side) {
+		levels += (levels.empty() ? "" : " ") + std::to_string(level.price().ticks()) + ":" + std::to_string(level.volume());
+	}
+	return levels;
+}
+
+// the trades since the last call, as "price:volume" in ticks
+inline std::string tradesOf(Book& book) {
+	std::vector<Trade> trades;
+	book.takeTrades(trades);
+
+	std::string prices;
+	for (const Trade& trade : trades) {
+		prices += (prices.empty() ? "" : " ") + std::to_string(Price::floorOf(trade.price(), book.tickSize()).ticks()) + ":" + std::to_string(trade.volume());
+	}
+	return prices;
+}
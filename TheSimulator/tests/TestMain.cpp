@@ -0,0 +1,33 @@
+#include "Tests.h"
+
+#include <iostream>
+
+std::map<std::string, TestFunction>& testRegistry() {
+	static std::map<std::string, TestFunction> registry;
+	return registry;
+}
+
+// runs the tests whose names start with the argument, all of them without one
+int main(int argc, char* argv[]) {
+	const std::string prefix = argc > 1 ? argv[1] : "";
+
+	size_t run = 0;
+	size_t failed = 0;
+	for (const auto& [name, function] : testRegistry()) {
+		if (name.compare(0, prefix.length(), prefix) != 0) {
+			continue;
+		}
+
+		++run;
+		try {
+			function();
+			std::cout << "passed: " << name << std::endl;
+		} catch (const std::exception& e) {
+			++failed;
+			std::cout << "FAILED: " << name << std::endl << "\t" << e.what() << std::endl;
+		}
+	}
+
+	std::cout << run - failed << " of " << run << " tests passed" << std::endl;
+	return run > 0 && failed == 0 ? 0 : 1;
+}
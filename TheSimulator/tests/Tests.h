@@ -0,0 +1,68 @@
+#pragma once
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+// A minimal harness for the tests of the books, there being no test framework to depend on. A test is a function registered under
+// its name; a failed check throws, which ends the test and fails it.
+class TestFailure : public std::runtime_error {
+public:
+	TestFailure(const std::string& message) : std::runtime_error(message) { }
+};
+
+using TestFunction = void (*)();
+
+// by the name, so that the tests run in the order of their names
+std::map<std::string, TestFunction>& testRegistry();
+
+struct TestRegistration {
+	TestRegistration(const char* name, TestFunction function) { testRegistry().emplace(name, function); }
+};
+
+#define TEST(name) \
+	static void name(); \
+	static const TestRegistration name##Registration(#name, &name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			throw TestFailure(std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " + #condition); \
+		} \
+	} while (false)
+
+#define CHECK_EQUAL(expected, actual) \
+	do { \
+		const auto& expectedValue = (expected); \
+		const auto& actualValue = (actual); \
+		if (!(expectedValue == actualValue)) { \
+			throw TestFailure(std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " + #actual + " is " + testString(actualValue) + ", expected " + testString(expectedValue)); \
+		} \
+	} while (false)
+
+#define CHECK_THROWS(statement) \
+	do { \
+		bool thrown = false; \
+		try { \
+			statement; \
+		} catch (const std::exception&) { \
+			thrown = true; \
+		} \
+		if (!thrown) { \
+			throw TestFailure(std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " + #statement + " did not throw"); \
+		} \
+	} while (false)
+
+template <class T>
+std::string testString(const T& value) {
+	if constexpr (std::is_arithmetic_v<T>) {
+		return std::to_string(value);
+	} else if constexpr (std::is_enum_v<T>) {
+		return std::to_string((long long)value);
+	} else if constexpr (std::is_convertible_v<T, std::string>) {
+		return std::string(value);
+	} else {
+		return value.toPostfixedString(3);
+	}
+}